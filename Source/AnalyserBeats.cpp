@@ -42,7 +42,7 @@ void AnalyserBeats::analyse(juce::AudioBuffer<float>* audio, std::atomic<double>
     reset();
     
 #ifdef LOW_PASS_ALL
-    filter.processSamples(audio->getWritePointer(0), audio->getNumSamples());
+    filter.process(audio->getWritePointer(0), audio->getNumSamples());
 #endif
     
     // Find the number of onset detection frames for the provided audio
@@ -54,7 +54,7 @@ void AnalyserBeats::analyse(juce::AudioBuffer<float>* audio, std::atomic<double>
     progress->store(0.7);
     
 #ifdef LOW_PASS_DOWNBEAT
-    filter.processSamples(audio->getWritePointer(0), audio->getNumSamples());
+    filter.process(audio->getWritePointer(0), audio->getNumSamples());
 #endif
     
     getDownbeat(audio, numFrames, bpm, beatPhase, downbeat);
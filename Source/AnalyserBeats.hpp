@@ -9,6 +9,7 @@
 #define AnalyserBeats_hpp
 
 #include <JuceHeader.h>
+#include "BiquadBank.hpp"
 #include "ThirdParty/qm-dsp/dsp/tempotracking/TempoTrackV2.h"
 #include "ThirdParty/qm-dsp/dsp/tempotracking/DownBeat.h"
 #include "ThirdParty/qm-dsp/dsp/onsets/DetectionFunction.h"
@@ -87,7 +88,7 @@ private:
     
     std::unique_ptr<DownBeat> downBeat; ///< QM-DSP downbeat detector
     
-    juce::IIRFilter filter; ///< Low-pass filter (unused in normal config - see BeatTests.hpp)
+    BiquadBank filter; ///< Low-pass filter (unused in normal config - see BeatTests.hpp)
     
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalyserBeats) ///< JUCE macro to add a memory leak detector
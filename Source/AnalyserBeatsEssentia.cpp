@@ -13,7 +13,7 @@
 
 #include "percivalevaluatepulsetrains.h"
 
-#include "PerformanceMeasure.hpp"
+#include "Profiler.hpp"
 #include "BeatTests.hpp"
 
 // TODO: define these elsewhere
@@ -68,7 +68,7 @@ void AnalyserBeatsEssentia::analyse(juce::AudioBuffer<float>* audio, std::atomic
     
     // If low-passing at the input stage, process the filtering and point 'audio' at the filtered buffer, rather than the input
 #ifdef LOW_PASS_ALL
-    filter.processSamples(filteredBuffer.getWritePointer(0), audio->getNumSamples());
+    filter.process(filteredBuffer.getWritePointer(0), audio->getNumSamples());
     // Change audio pointer
     audio = &filteredBuffer;
 #endif
@@ -80,12 +80,15 @@ void AnalyserBeatsEssentia::analyse(juce::AudioBuffer<float>* audio, std::atomic
     
     // If low-passing just before the downbeat stage, process the filtering now and point 'audio' at the filtered buffer
 #ifdef LOW_PASS_DOWNBEAT
-    filter.processSamples(filteredBuffer.getWritePointer(0), audio->getNumSamples());
+    filter.process(filteredBuffer.getWritePointer(0), audio->getNumSamples());
     audio = &filteredBuffer;
 #endif
 
     // Perform downbeat detection
-    getDownbeat(audio, bpm, beatPhase, downbeat);
+    {
+        PROFILE_ZONE("downbeat")
+        getDownbeat(audio, bpm, beatPhase, downbeat);
+    }
 }
 
 
@@ -142,7 +145,10 @@ void AnalyserBeatsEssentia::getTempo(juce::AudioBuffer<float>* audio, std::atomi
     rhythmExtractor->output("bpmIntervals").set(bpmIntervals);
 
     // Perform beat tracking (during which, the output data is placed in the above variables)
-    rhythmExtractor->compute();
+    {
+        PROFILE_ZONE("tempo")
+        rhythmExtractor->compute();
+    }
 
     // Round the BPM estimate to an integer
     bpm = round(bpmFloat);
@@ -159,7 +165,10 @@ void AnalyserBeatsEssentia::getTempo(juce::AudioBuffer<float>* audio, std::atomi
     percivalTempo->output("bpm").set(bpmFloat);
 
     // Perform beat tracking (during which, the output data is placed in the above variable)
-    percivalTempo->compute();
+    {
+        PROFILE_ZONE("tempo")
+        percivalTempo->compute();
+    }
 
     // Round the BPM estimate to an integer
     bpm = round(bpmFloat);
@@ -185,11 +194,14 @@ void AnalyserBeatsEssentia::getTempo(juce::AudioBuffer<float>* audio, std::atomi
     // Phase correction using Percival pulse trains...
 #ifdef PHASE_CORRECTION_PULSETRAIN
 #ifdef LOW_PASS_PHASE
-    filter.processSamples(filteredBuffer.getWritePointer(0), audio->getNumSamples());
+    filter.process(filteredBuffer.getWritePointer(0), audio->getNumSamples());
     audio = &filteredBuffer;
 #endif
     
-    pulseTrainsPhase(audio, bpm, beatPhase);
+    {
+        PROFILE_ZONE("phase")
+        pulseTrainsPhase(audio, bpm, beatPhase);
+    }
 #endif
     
     progress->store(0.5);
@@ -9,6 +9,7 @@
 #define AnalyserBeatsEssentia_hpp
 
 #include <JuceHeader.h>
+#include "BiquadBank.hpp"
 #include "ThirdParty/qm-dsp/dsp/tempotracking/DownBeat.h"
 #include <essentia.h>
 #include <algorithmfactory.h>
@@ -100,7 +101,7 @@ private:
     
     std::unique_ptr<DownBeat> downBeat; ///< QM-DSP downbeat detector
     
-    juce::IIRFilter filter; ///< Low-pass filter (unused in normal config - see BeatTests.hpp)
+    BiquadBank filter; ///< Low-pass filter (unused in normal config - see BeatTests.hpp)
     juce::AudioBuffer<float> filteredBuffer; ///< Intermediate audio buffer for filtered audio (unused in normal config - see BeatTests.hpp)
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalyserBeatsEssentia) ///< JUCE macro to add a memory leak detector
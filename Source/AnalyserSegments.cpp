@@ -25,7 +25,7 @@ AnalyserSegments::AnalyserSegments()
 }
 
 
-juce::Array<int> AnalyserSegments::analyse(TrackInfo* track, juce::AudioBuffer<float>* audio)
+void AnalyserSegments::analyse(TrackInfo* track, juce::AudioBuffer<float>* audio)
 {
     // Reset ready for the new track
     reset();
@@ -44,7 +44,7 @@ juce::Array<int> AnalyserSegments::analyse(TrackInfo* track, juce::AudioBuffer<f
     }
     
     // Low-pass the audio
-    filter.processSamples(filteredBuffer.getWritePointer(0), numSamples);
+    filter.process(filteredBuffer.getWritePointer(0), numSamples);
     
     // Analyser requires double, so copy audio into a double buffer
     // (Filter can't operate on doubles)
@@ -67,15 +67,29 @@ juce::Array<int> AnalyserSegments::analyse(TrackInfo* track, juce::AudioBuffer<f
     // Fetch the result
     Segmentation segmentation = segmenter->getSegmentation();
     
-    // We're only interested in the segment starts
-    // Create a new array to store these
-    juce::Array<int> segments;
-    for (auto segment : segmentation.segments)
-        // Lock each segment to a downbeat
-        segments.add(track->getNearestDownbeat(segment.start));
+    // The track isn't marked as analysed until every feature is, so the downbeats are found here, rather than with TrackInfo
+    int barLength = AutoDJ::getBeatPeriod(track->bpm) * BEATS_PER_BAR;
+    int firstDownbeat = track->downbeat * AutoDJ::getBeatPeriod(track->bpm) + track->beatPhase;
     
-    // Return the array
-    return segments;
+    // We're only interested in the segment starts, which are stored as the index of the nearest downbeat
+    track->numSegments = 0;
+    for (auto segment : segmentation.segments)
+    {
+        int bar = juce::jmax(0, juce::roundToInt(double(segment.start - firstDownbeat) / barLength));
+        
+        // Short segments can lock to the same downbeat as the one before
+        if (track->numSegments > 0 && bar <= track->segmentBars[track->numSegments-1])
+            continue;
+        
+        if (track->numSegments == TRACK_SEGMENTS_MAX)
+        {
+            jassert(false); // More segments than can be stored, so the rest are dropped
+            break;
+        }
+        
+        track->segmentBars[track->numSegments] = bar;
+        track->numSegments += 1;
+    }
 }
 
 
@@ -10,6 +10,7 @@
 
 #include <JuceHeader.h>
 #include "TrackInfo.hpp"
+#include "BiquadBank.hpp"
 #include "ThirdParty/qm-dsp/dsp/segmentation/ClusterMeltSegmenter.h"
 
 
@@ -29,13 +30,12 @@ public:
     /** Destructor. */
     ~AnalyserSegments() {}
     
-    /** Analyses the provided audio data.
+    /** Analyses the provided audio data, storing the segment boundaries in the track (see TrackInfo::getSegments()).
+     This is part of offline analysis, so the mix doesn't wait for it when a track is chosen.
     
-     @param[in] track Pointer to track information, so that segments can be matched to the nearest downbeat
-     @param[in] audio Pointer to audio data to be analysed
-     
-     @return Array of musical segment boundaries, measured in audio samples */
-    juce::Array<int> analyse(TrackInfo* track, juce::AudioBuffer<float>* audio);
+     @param[in,out] track Pointer to track information, whose beats must already have been analysed, so that segments can be matched to the nearest downbeat
+     @param[in] audio Pointer to audio data to be analysed */
+    void analyse(TrackInfo* track, juce::AudioBuffer<float>* audio);
     
     /** Fetches the location of the segment closest to a given audio sample point.
      Can optionally provide a range in which to restrict the result.
@@ -65,7 +65,7 @@ private:
     std::unique_ptr<Segmenter> segmenter; ///< QM-DSP segmentation algorithm
     ClusterMeltSegmenterParams params; ///< Parameters for QM-DSP segmentation algorithm
     
-    juce::IIRFilter filter; ///< IIR filter for low-passing input audio
+    BiquadBank filter; ///< IIR filter for low-passing input audio
     juce::AudioBuffer<float> filteredBuffer; ///< Intermediate audio buffer for low-pass filtered audio
     
     
@@ -0,0 +1,92 @@
+//
+//  AnalyserWaveform.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "AnalyserWaveform.hpp"
+
+#include "CommonDefs.hpp"
+
+
+AnalyserWaveform::AnalyserWaveform()
+{
+    // Generate coefficients for the low-, band- and high-pass IIR filters
+    filters.setCoefficients(0, juce::IIRCoefficients::makeLowPass(SUPPORTED_SAMPLERATE, 200, 1.0));
+    filters.setCoefficients(1, juce::IIRCoefficients::makeBandPass(SUPPORTED_SAMPLERATE, 500, 1.0));
+    filters.setCoefficients(2, juce::IIRCoefficients::makeHighPass(SUPPORTED_SAMPLERATE, 10000, 1.0));
+    
+    // Allocate the block buffers once, since their size doesn't depend on the track
+    blockBuffers.setSize(3, WAVEFORM_BLOCK_FRAMES * WAVEFORM_FRAME_SIZE);
+}
+
+
+bool AnalyserWaveform::analyse(juce::AudioBuffer<float>* audio, juce::MemoryBlock& waveform, const std::atomic<bool>* abort)
+{
+    // Reset ready for the new track
+    reset();
+    
+    // Frames of audio are analysed to produce the waveform
+    // Calculate how many frames there will be - determined by track length and frame size
+    int numFrames = audio->getNumSamples() / WAVEFORM_FRAME_SIZE;
+    
+    waveform.setSize(numFrames * WAVEFORM_BYTES_PER_FRAME);
+    juce::uint8* frame = static_cast<juce::uint8*>(waveform.getData());
+    
+    // Generate the waveform one block of frames at a time
+    for (int blockStart = 0; blockStart < numFrames; blockStart += WAVEFORM_BLOCK_FRAMES)
+    {
+        // If generation has been abandoned, stop here
+        if (abort != nullptr && abort->load())
+            return false;
+        
+        int blockFrames = juce::jmin(WAVEFORM_BLOCK_FRAMES, numFrames - blockStart);
+        int blockSamples = blockFrames * WAVEFORM_FRAME_SIZE;
+        const float* input = audio->getReadPointer(0, blockStart * WAVEFORM_FRAME_SIZE);
+        
+        // Apply the low-, band- and high-pass filters to the block together, in one pass
+        // Their state carries over from the previous block, so the result is the same as filtering the whole track
+        filters.processSplit(input, blockBuffers.getArrayOfWritePointers(), 3, blockSamples);
+        
+        // Generate every waveform frame in the block
+        for (int i = 0; i < blockFrames; i++)
+        {
+            int startSample = i * WAVEFORM_FRAME_SIZE;
+            
+            // The magnitude of the waveform frame is the peak of the unfiltered audio
+            float level = getPeak(input + startSample);
+            
+            // The magnitudes of the colours red, green and blue are determined by
+            // the low-, band- and high-pass filtered audio respectively
+            float low = getPeak(blockBuffers.getReadPointer(0, startSample));
+            float mid = getPeak(blockBuffers.getReadPointer(1, startSample));
+            float high = getPeak(blockBuffers.getReadPointer(2, startSample));
+            
+            // Scale the colours to an appropriate range, and brighten them slightly
+            float multiplier = 2.f;
+            
+            frame[0] = toByte(level);
+            frame[1] = toByte(low * multiplier + 0.1f);
+            frame[2] = toByte(mid * multiplier + 0.1f);
+            frame[3] = toByte(high * multiplier + 0.1f);
+            
+            frame += WAVEFORM_BYTES_PER_FRAME;
+        }
+    }
+    
+    return true;
+}
+
+
+float AnalyserWaveform::getPeak(const float* samples)
+{
+    juce::Range<float> range = juce::FloatVectorOperations::findMinAndMax(samples, WAVEFORM_FRAME_SIZE);
+    return juce::jmax(-range.getStart(), range.getEnd());
+}
+
+
+void AnalyserWaveform::reset()
+{
+    filters.reset();
+}
@@ -0,0 +1,77 @@
+//
+//  AnalyserWaveform.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef AnalyserWaveform_hpp
+#define AnalyserWaveform_hpp
+
+#include <JuceHeader.h>
+#include "BiquadBank.hpp"
+
+
+#define WAVEFORM_FRAME_SIZE (380) ///< Number of audio samples to consider for each waveform frame
+#define WAVEFORM_BYTES_PER_FRAME (4) ///< Each waveform frame is stored as an 8-bit level, followed by 8-bit red, green and blue components
+#define WAVEFORM_BLOCK_FRAMES (32) ///< Number of waveform frames generated from each block of audio, which bounds the memory used for filtering
+
+
+/**
+ Generates the overview shown in track waveforms (see WaveformComponent), so that it can be computed once during analysis
+ and stored in the database, rather than every time a track is displayed.
+ 
+ The waveform is split into frames of WAVEFORM_FRAME_SIZE samples. The level of each frame is the peak of the audio,
+ and its colour is made from the peaks of low-, band- and high-passed audio (red, green and blue respectively),
+ which communicates the timbre of the track.
+ 
+ The audio is processed in a single pass over blocks of WAVEFORM_BLOCK_FRAMES frames, so the memory used
+ doesn't depend on the length of the track, and generation can be abandoned between blocks.
+*/
+class AnalyserWaveform
+{
+public:
+    
+    /** Constructor. */
+    AnalyserWaveform();
+    
+    /** Destructor. */
+    ~AnalyserWaveform() {}
+    
+    /** Analyses the provided audio data.
+     
+     @param[in] audio Pointer to mono audio data to be analysed
+     @param[out] waveform Output location for the waveform, in frames of WAVEFORM_BYTES_PER_FRAME bytes
+     @param[in] abort Optional flag, checked before each block, which abandons generation once set
+     
+     @return True if the waveform is complete, false if it was abandoned */
+    bool analyse(juce::AudioBuffer<float>* audio, juce::MemoryBlock& waveform, const std::atomic<bool>* abort = nullptr);
+    
+private:
+    
+    /** Resets the analyser ready for a new track. */
+    void reset();
+    
+    /** Converts a level or colour component to 8 bits.
+     
+     @param[in] value Value to convert (0.0 to 1.0)
+     
+     @return 8-bit value */
+    static juce::uint8 toByte(float value) { return (juce::uint8)juce::roundToInt(juce::jlimit(0.f, 1.f, value) * 255.f); }
+    
+    /** Finds the peak magnitude of one waveform frame of audio, without a separate pass to take absolute values.
+     
+     @param[in] samples Pointer to WAVEFORM_FRAME_SIZE samples
+     
+     @return Peak magnitude */
+    static float getPeak(const float* samples);
+    
+    juce::AudioBuffer<float> blockBuffers; ///< Buffers to hold one block of low-, band- and high-passed audio while it is processed
+    
+    BiquadBank filters; ///< Low-, band- and high-pass filters (lanes 0-2), which determine the amount of red, green and blue in each waveform frame
+    
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalyserWaveform) ///< JUCE macro to add a memory leak detector
+};
+
+#endif /* AnalyserWaveform_hpp */
@@ -0,0 +1,163 @@
+//
+//  AnalysisFeatures.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "AnalysisFeatures.hpp"
+
+#include "TrackInfo.hpp"
+#include "CommonDefs.hpp"
+#include "BeatTests.hpp"
+#include "AnalyserWaveform.hpp"
+
+namespace AnalysisFeatures {
+
+
+juce::String getName(AnalysisFeature feature)
+{
+    switch (feature)
+    {
+        case AnalysisFeature::beats:
+            return "beats";
+        case AnalysisFeature::downbeat:
+            return "downbeat";
+        case AnalysisFeature::key:
+            return "key";
+        case AnalysisFeature::groove:
+            return "groove";
+        case AnalysisFeature::segments:
+            return "segments";
+        case AnalysisFeature::waveform:
+            return "waveform";
+    }
+    
+    jassert(false); // Unknown feature
+    return {};
+}
+
+
+int getVersion(AnalysisFeature feature)
+{
+    switch (feature)
+    {
+        case AnalysisFeature::beats:
+            return ANALYSER_VERSION_BEATS;
+        case AnalysisFeature::downbeat:
+            return ANALYSER_VERSION_DOWNBEAT;
+        case AnalysisFeature::key:
+            return ANALYSER_VERSION_KEY;
+        case AnalysisFeature::groove:
+            return ANALYSER_VERSION_GROOVE;
+        case AnalysisFeature::segments:
+            return ANALYSER_VERSION_SEGMENTS;
+        case AnalysisFeature::waveform:
+            return ANALYSER_VERSION_WAVEFORM;
+    }
+    
+    jassert(false); // Unknown feature
+    return 0;
+}
+
+
+int getConfigHash(AnalysisFeature feature)
+{
+    juce::String config = getName(feature) + ":" + juce::String(SUPPORTED_SAMPLERATE);
+    
+    // Add the settings which change the results (e.g. the choice of algorithm)
+    if (feature == AnalysisFeature::beats || feature == AnalysisFeature::downbeat)
+    {
+#ifdef BEATS_QM
+        config << ":qm";
+#else
+        config << ":essentia";
+#endif
+    }
+    else if (feature == AnalysisFeature::waveform)
+    {
+        config << ":" << WAVEFORM_FRAME_SIZE;
+    }
+    
+    return config.hashCode();
+}
+
+
+int getCurrentFeatures(const TrackInfo& track)
+{
+    int current = 0;
+    
+    for (int i = 0; i < NUM_ANALYSIS_FEATURES; i++)
+    {
+        AnalysisFeature feature = (AnalysisFeature)i;
+        
+        if (track.featureVersions[i] == getVersion(feature) && track.featureConfigs[i] == getConfigHash(feature))
+            current |= ANALYSIS_FEATURE_BIT(feature);
+    }
+    
+    return current;
+}
+
+
+int getStaleFeatures(const TrackInfo& track)
+{
+    return ANALYSIS_FEATURES_REQUIRED & ~getCurrentFeatures(track);
+}
+
+
+int getOutdatedFeatures(const TrackInfo& track)
+{
+    return ANALYSIS_FEATURES_ALL & ~getCurrentFeatures(track);
+}
+
+
+void markCurrent(TrackInfo& track, int features)
+{
+    for (int i = 0; i < NUM_ANALYSIS_FEATURES; i++)
+    {
+        AnalysisFeature feature = (AnalysisFeature)i;
+        
+        if (features & ANALYSIS_FEATURE_BIT(feature))
+        {
+            track.featureVersions[i] = getVersion(feature);
+            track.featureConfigs[i] = getConfigHash(feature);
+        }
+    }
+}
+
+
+void copyFeatures(TrackInfo& track, const TrackInfo& source, int features)
+{
+    if (features & ANALYSIS_FEATURE_BIT(AnalysisFeature::beats))
+    {
+        track.bpm = source.bpm;
+        track.beatPhase = source.beatPhase;
+    }
+    
+    if (features & ANALYSIS_FEATURE_BIT(AnalysisFeature::downbeat))
+        track.downbeat = source.downbeat;
+    
+    if (features & ANALYSIS_FEATURE_BIT(AnalysisFeature::key))
+        track.key = source.key;
+    
+    if (features & ANALYSIS_FEATURE_BIT(AnalysisFeature::groove))
+        track.groove = source.groove;
+    
+    if (features & ANALYSIS_FEATURE_BIT(AnalysisFeature::segments))
+    {
+        track.numSegments = source.numSegments;
+        memcpy(track.segmentBars, source.segmentBars, sizeof(track.segmentBars));
+    }
+    
+    for (int i = 0; i < NUM_ANALYSIS_FEATURES; i++)
+    {
+        if (features & ANALYSIS_FEATURE_BIT(i))
+        {
+            track.featureVersions[i] = source.featureVersions[i];
+            track.featureConfigs[i] = source.featureConfigs[i];
+        }
+    }
+}
+
+
+}
@@ -0,0 +1,108 @@
+//
+//  AnalysisFeatures.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef AnalysisFeatures_hpp
+#define AnalysisFeatures_hpp
+
+#include <JuceHeader.h>
+
+class TrackInfo;
+
+
+// Version of the analyser behind each feature - increment one whenever its algorithm changes, so that only that
+// feature is recomputed for every track in the library (see AnalysisFeatures::getStaleFeatures())
+#define ANALYSER_VERSION_BEATS (1) ///< Version of the tempo and beat phase analysis
+#define ANALYSER_VERSION_DOWNBEAT (1) ///< Version of the downbeat analysis
+#define ANALYSER_VERSION_KEY (1) ///< Version of the key analysis
+#define ANALYSER_VERSION_GROOVE (1) ///< Version of the groove (danceability) analysis
+#define ANALYSER_VERSION_SEGMENTS (1) ///< Version of the structural segmentation
+#define ANALYSER_VERSION_WAVEFORM (1) ///< Version of the waveform overview
+
+#define NUM_ANALYSIS_FEATURES (6) ///< Number of separately-versioned analysis features
+#define ANALYSIS_FEATURE_BIT(feature) (1 << (int)(feature)) ///< Bit which represents a feature in a set of features
+#define ANALYSIS_FEATURES_ALL ((1 << NUM_ANALYSIS_FEATURES) - 1) ///< Every feature
+#define ANALYSIS_FEATURES_OPTIONAL (ANALYSIS_FEATURE_BIT(AnalysisFeature::waveform)) ///< Features which are still computed, but which a track can be mixed without
+#define ANALYSIS_FEATURES_REQUIRED (ANALYSIS_FEATURES_ALL & ~ANALYSIS_FEATURES_OPTIONAL) ///< Features which must be current for a track to count as analysed
+
+
+/** Features produced by the analysis pipeline, each of which is versioned separately. */
+enum class AnalysisFeature : int
+{
+    beats, ///< Tempo and beat phase
+    downbeat, ///< Downbeat (computed by the same analyser as the beats, so both are recomputed together)
+    key, ///< Key signature
+    groove, ///< Danceability
+    segments, ///< Structural segmentation (boundaries locked to downbeats, so recomputed whenever the beats are)
+    waveform ///< Waveform overview (stored separately from the rest of the track data, see SqlDatabase::storeWaveform())
+};
+
+
+/**
+ Tracks which version and configuration of each analyser produced a track's features, so that changing one analyser
+ only requires that feature to be recomputed, rather than re-analysing the whole library.
+ */
+namespace AnalysisFeatures {
+
+/** Fetches the name of a feature, which prefixes its columns in the database.
+ 
+ @param[in] feature Feature to name
+ 
+ @return Name of the feature */
+juce::String getName(AnalysisFeature feature);
+
+/** Fetches the current version of a feature's analyser.
+ 
+ @param[in] feature Feature to check
+ 
+ @return Analyser version */
+int getVersion(AnalysisFeature feature);
+
+/** Calculates a hash of a feature's analysis settings (e.g. the algorithm and sample rate used), so that a change in
+ configuration also makes the feature stale, even when the analyser version doesn't change.
+ 
+ @param[in] feature Feature to check
+ 
+ @return Configuration hash */
+int getConfigHash(AnalysisFeature feature);
+
+/** Finds the features of a track which were computed by the current version and configuration of their analyser.
+ 
+ @param[in] track Track to check
+ 
+ @return Set of current features (see ANALYSIS_FEATURE_BIT) */
+int getCurrentFeatures(const TrackInfo& track);
+
+/** Finds the required features of a track which are missing, or were computed by an older version or configuration of their analyser.
+ 
+ @param[in] track Track to check
+ 
+ @return Set of stale features (see ANALYSIS_FEATURE_BIT) */
+int getStaleFeatures(const TrackInfo& track);
+
+/** Finds every feature of a track (required or optional) which is missing, or was computed by an older version or configuration of its analyser.
+ 
+ @param[in] track Track to check
+ 
+ @return Set of outdated features (see ANALYSIS_FEATURE_BIT) */
+int getOutdatedFeatures(const TrackInfo& track);
+
+/** Records that features of a track have just been computed by the current analysers.
+ 
+ @param[in,out] track Track to update
+ @param[in] features Set of features computed (see ANALYSIS_FEATURE_BIT) */
+void markCurrent(TrackInfo& track, int features);
+
+/** Copies features (their values and versions) from one track's analysis to another.
+ 
+ @param[in,out] track Track to update
+ @param[in] source Track to copy from
+ @param[in] features Set of features to copy (see ANALYSIS_FEATURE_BIT) */
+void copyFeatures(TrackInfo& track, const TrackInfo& source, int features);
+
+}
+
+#endif /* AnalysisFeatures_hpp */
@@ -23,21 +23,24 @@ AnalysisManager::~AnalysisManager()
     // Set progress tracker to completion, so that no more jobs are given to analysis threads
     nextJob = jobs.size();
     
-    for (auto* thread : threads)
-    {
-        thread->stopThread(10000);
-    }
+    stopThreads();
 }
 
 
-void AnalysisManager::startAnalysis(DataManager* dm)
+int AnalysisManager::getDefaultNumThreads()
 {
-    dataManager = dm;
-    
     int numThreads = juce::SystemStats::getNumCpus();
     DBG("Num logical CPU cores: " << numThreads);
     numThreads -= 2;
-    numThreads = juce::jmin(numThreads, MAX_NUM_THREADS);
+    return juce::jlimit(1, MAX_NUM_THREADS, numThreads);
+}
+
+
+void AnalysisManager::startAnalysis(DataManager* dm)
+{
+    dataManager = dm;
+    
+    int numThreads = (numThreadsOverride > 0) ? numThreadsOverride : getDefaultNumThreads();
     DBG("Using " << numThreads << " analysis threads");
     
     if (jobs.size() == 0)
@@ -52,16 +55,31 @@ void AnalysisManager::startAnalysis(DataManager* dm)
         numThreads = jobs.size();
     }
     
-    essentia::standard::AlgorithmFactory& factory = essentia::standard::AlgorithmFactory::instance();
-    
     for (int i = 0; i < numThreads; i++)
     {
-        threads.add(new AnalysisThread(i+1, this, dataManager, factory));
+        threads.add(createThread(i+1));
         threads.getUnchecked(i)->startThread();
     }
 }
 
 
+AnalysisThread* AnalysisManager::createThread(int id)
+{
+    return new AnalysisThread(id, this, dataManager, essentia::standard::AlgorithmFactory::instance());
+}
+
+
+void AnalysisManager::stopThreads()
+{
+    for (auto* thread : threads)
+    {
+        thread->stopThread(10000);
+    }
+    
+    threads.clear();
+}
+
+
 void AnalysisManager::playPause()
 {
     const juce::ScopedLock sl(lock);
@@ -96,6 +114,28 @@ bool AnalysisManager::isFinished(double& progress)
 }
 
 
+int AnalysisManager::getNumJobs()
+{
+    const juce::ScopedLock sl(lock);
+    return jobs.size() - numDeferredJobs;
+}
+
+
+juce::int64 AnalysisManager::getNumSamplesAnalysed()
+{
+    const juce::ScopedLock sl(lock);
+    
+    juce::int64 numSamples = 0;
+    
+    for (auto* thread : threads)
+    {
+        numSamples += thread->getNumSamplesAnalysed();
+    }
+    
+    return numSamples;
+}
+
+
 TrackInfo* AnalysisManager::getNextJob()
 {
     // Initiate a scoped mutex lock to protect
@@ -124,10 +164,42 @@ void AnalysisManager::storeAnalysis(TrackInfo* track)
 {
     const juce::ScopedLock sl(lock);
     
-    processResult(track);
+    // A track queued only for its optional features is already in the library, and already counted in the results
+    bool addToLibrary = !optionalJobs.contains(track);
+    
+    if (addToLibrary)
+        processResult(track);
+    
+    dataManager->storeAnalysis(track, addToLibrary);
+    
+    jobProgress += 1;
+}
+
+
+void AnalysisManager::storeWaveform(TrackInfo* track, const juce::MemoryBlock& waveform)
+{
+    dataManager->storeWaveform(track->hash, waveform);
+}
+
+
+void AnalysisManager::deferJob(TrackInfo* track)
+{
+    const juce::ScopedLock sl(lock);
+    
+    // Add the track to the end of the queue again, and count its original place as complete
+    jobs.add(track);
+    numDeferredJobs += 1;
+    jobProgress += 1;
+}
+
+
+void AnalysisManager::jobFailed(TrackInfo* track)
+{
+    const juce::ScopedLock sl(lock);
     
-    dataManager->storeAnalysis(track);
+    DBG("Analysis failed: " << track->getFilename());
     
+    numFailedJobs += 1;
     jobProgress += 1;
 }
 
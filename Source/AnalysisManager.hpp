@@ -43,6 +43,12 @@ public:
      @param[in] track Pointer to the track to be analysed */
     void addJob(TrackInfo* track) { jobs.add(track); }
     
+    /** Adds a track which is already analysed to the analysis queue, to compute its outdated optional features
+     (see ANALYSIS_FEATURES_OPTIONAL) - its results are stored, but it isn't added to the library a second time.
+     
+     @param[in] track Pointer to the track to be analysed */
+    void addOptionalJob(TrackInfo* track) { optionalJobs.add(track); jobs.add(track); }
+    
     /** Starts the analysis process, launching a number of AnalysisThreads. */
     virtual void startAnalysis(DataManager* dataManager);
     
@@ -67,6 +73,12 @@ public:
      @param[in] track Pointer to the track data */
     virtual void storeAnalysis(TrackInfo* track);
     
+    /** Stores the newly generated waveform overview of a track.
+     
+     @param[in] track Pointer to the track data
+     @param[in] waveform Waveform data (see AnalyserWaveform) */
+    virtual void storeWaveform(TrackInfo* track, const juce::MemoryBlock& waveform);
+    
     /** Updates the AnalysisResults struct against newly analysed track data.
     
     @param[in] track Pointer to the track data */
@@ -78,22 +90,87 @@ public:
     AnalysisResults getResults();
     
     /** Clears the analysis queue. */
-    void clearJobs() { jobs.clear(); }
+    void clearJobs() { jobs.clear(); optionalJobs.clear(); }
+    
+    /** Moves a job to the back of the queue, e.g. because another process is already analysing the track.
+     
+     @param[in] track Pointer to the track to analyse later */
+    void deferJob(TrackInfo* track);
+    
+    /** Marks a job as complete without storing any results, because the track couldn't be analysed.
+     The track stays unanalysed, so it is attempted again the next time the library is loaded.
+     
+     @param[in] track Pointer to the track that failed */
+    void jobFailed(TrackInfo* track);
+    
+    /** Overrides the number of AnalysisThreads launched by startAnalysis().
+     
+     @param[in] num Number of threads to use, or -1 to choose automatically based on the number of CPU cores */
+    void setNumThreads(int num) { numThreadsOverride = num; }
+    
+    /** Calculates the number of AnalysisThreads used when no override is set, based on the number of CPU cores.
+     
+     @return Default number of analysis threads */
+    static int getDefaultNumThreads();
+    
+    /** Chooses which features of a track to (re)compute - by default, only those which are missing or stale
+     (see AnalysisFeatures::getOutdatedFeatures()), so that updating one analyser doesn't repeat the others.
+     
+     @param[in] track Pointer to the track to be analysed
+     
+     @return Set of features to compute (see ANALYSIS_FEATURE_BIT) */
+    virtual int getFeaturesToAnalyse(TrackInfo* track) { return AnalysisFeatures::getOutdatedFeatures(*track); }
+    
+    /** Fetches the number of tracks queued for analysis since the queue was last cleared.
+     
+     @return Number of analysis jobs */
+    int getNumJobs();
+    
+    /** Fetches the number of tracks that couldn't be analysed (see jobFailed()).
+     
+     @return Number of failed jobs */
+    int getNumFailedJobs() { return numFailedJobs.load(); }
+    
+    /** Fetches the number of AnalysisThreads launched by startAnalysis().
+     
+     @return Number of analysis threads (0 if analysis hasn't started, or there was nothing to analyse) */
+    int getNumThreads() { return threads.size(); }
+    
+    /** Fetches the total length of audio analysed so far, by all AnalysisThreads.
+     
+     @return Number of audio samples analysed */
+    juce::int64 getNumSamplesAnalysed();
     
 protected:
     
+    /** Stops all AnalysisThreads and deletes them, so that analysis can be restarted from scratch. */
+    void stopThreads();
+    
+    /** Creates one of the threads launched by startAnalysis().
+     
+     @param[in] id Number of the thread
+     
+     @return New analysis thread (not yet started) */
+    virtual AnalysisThread* createThread(int id);
+    
+    juce::OwnedArray<AnalysisThread> threads; ///<  Analysis threads which perform the actual audio processing
+    
     DataManager* dataManager = nullptr; ///< Pointer to the app's track data manager
     
     juce::Array<TrackInfo*> jobs; ///< Queue of tracks to be analysed
+    juce::SortedSet<TrackInfo*> optionalJobs; ///< Tracks in the queue which are already in the library, and only need their optional features
     
     juce::CriticalSection lock; ///< RAII lock to ensure thread-safety while acessing data within this class
     
     int jobProgress = 0; // Keeps track of how many jobs have been completed
     int nextJob = 0; // Because of multi-threading we also need to keep track of what job is next (not simply jobProgress+1)
     
-private:
+    int numThreadsOverride = -1; ///< Number of analysis threads to launch, or -1 to choose automatically
     
-    juce::OwnedArray<AnalysisThread> threads; ///<  Analysis threads which perform the actual audio processing
+    int numDeferredJobs = 0; ///< Number of jobs moved to the back of the queue, which therefore appear in it twice
+    std::atomic<int> numFailedJobs = 0; ///< Number of tracks that couldn't be analysed
+    
+private:
     
     AnalysisResults results; ///< Overall analysis results, which give the range of tempo and groove that was found.
     
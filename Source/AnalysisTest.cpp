@@ -9,22 +9,50 @@
 
 #include "DataManager.hpp"
 
-#include "PerformanceMeasure.hpp"
+#if JUCE_MAC || JUCE_LINUX
+#include <sys/resource.h>
+#endif
+
+
+/** Names of the profiler zones for each stage of the analysis pipeline, which are reported individually when benchmarking. */
+static const char* benchmarkStages[] = { "decode", "tempo", "phase", "downbeat", "key", "groove", "segments", "waveform" };
 
 
 void AnalysisTest::startAnalysis(DataManager* dataManager)
 {
-    jassert(jobs.isEmpty()); // Invalid ground truth data: all tracks should be marked as analysed
+    // The ground truth doesn't include segments or waveforms, so tracks may have been queued just to compute them
+    clearJobs();
     
     numTracks = dataManager->getNumTracks();
     
     for (int i = 0; i < numTracks; i++)
     {
-        groundTruth.add(dataManager->getTracks()[i]);
-        jobs.add(&dataManager->getTracks()[i]);
+        TrackInfo& track = dataManager->getTracks()[i];
+        
+        jassert((AnalysisFeatures::getOutdatedFeatures(track) & ~(ANALYSIS_FEATURE_BIT(AnalysisFeature::segments) | ANALYSIS_FEATURE_BIT(AnalysisFeature::waveform))) == 0); // Invalid ground truth data: all tracks should be marked as analysed
+        
+        groundTruth.add(track);
+        groundTruth.getReference(i).analysed = true;
+        jobs.add(&track);
     }
     
-    PerformanceMeasure::reset();
+    Profiler::reset();
+    
+    if (benchmarkMode)
+    {
+        // The benchmark relies on the profiler, so make sure it is running (even in release builds)
+        Profiler::setEnabled(true);
+        
+        // Benchmark with 1, 2, 4... threads, finishing with the number normally used for analysis
+        int maxThreads = getDefaultNumThreads();
+        for (int numThreads = 1; numThreads < maxThreads; numThreads *= 2)
+            benchmarkThreadCounts.add(numThreads);
+        benchmarkThreadCounts.add(maxThreads);
+        
+        benchmarkPass = 0;
+        setNumThreads(benchmarkThreadCounts.getFirst());
+        passStartTime = juce::Time::getMillisecondCounterHiRes();
+    }
     
     initialised.store(true);
 
@@ -36,10 +64,42 @@ bool AnalysisTest::isFinished(double& progress)
 {
     bool finished = AnalysisManager::isFinished(progress);
     
+    if (!benchmarkMode)
+    {
+        if (finished)
+            printResults();
+        
+        return finished;
+    }
+    
+    const juce::ScopedLock sl(benchmarkLock);
+    
+    // If all passes have already been completed, there is nothing more to do
+    if (benchmarkPass >= benchmarkThreadCounts.size())
+        return true;
+    
     if (finished)
-        printResults();
+    {
+        recordBenchmarkPass();
+        benchmarkPass += 1;
+        
+        // If all passes are now complete, output the results
+        if (benchmarkPass >= benchmarkThreadCounts.size())
+        {
+            printResults();
+            writeBenchmarkResults();
+            return true;
+        }
+        
+        // Otherwise, start the next pass
+        startBenchmarkPass();
+        progress = 0.0;
+    }
     
-    return finished;
+    // Scale the progress of the current pass to give the overall progress
+    progress = (benchmarkPass + progress) / benchmarkThreadCounts.size();
+    
+    return false;
 }
 
 
@@ -50,6 +110,10 @@ void AnalysisTest::storeAnalysis(TrackInfo* track)
     processResult(track);
     
     jobProgress += 1;
+    
+    // Record the time at which the final job completes, so the pass duration doesn't depend on how often isFinished() is polled
+    if (jobProgress == jobs.size())
+        passEndTime = juce::Time::getMillisecondCounterHiRes();
 }
 
 
@@ -168,7 +232,173 @@ void AnalysisTest::printResults()
     DBG("Average Phase Error: " << averagePhaseError);
     DBG("\nDownbeat Accuracy: " << downbeatAccuracy);
     
-    // Also print average time taken, measured by the static PerformanceMeasure class
-    DBG("\nAverage Time: " << PerformanceMeasure::getAverage());
-    PerformanceMeasure::reset();
+    // Also print the time taken for beat tracking, and the distribution for all other zones, measured by the Profiler
+    ProfilerZoneStats beats = Profiler::getZoneStats("beats");
+    DBG("\nAverage Time: " << beats.meanMs / 1000.0 << " p95: " << beats.p95Ms / 1000.0 << " Max: " << beats.maxMs / 1000.0);
+    DBG("\n" << Profiler::getReport());
+    Profiler::reset();
+}
+
+
+void AnalysisTest::recordBenchmarkPass()
+{
+    BenchmarkPass pass;
+    
+    pass.numThreads = threads.size();
+    pass.wallTimeSec = (passEndTime - passStartTime) / 1000.0;
+    
+    // Collect the throughput and memory figures from each thread
+    for (auto* thread : threads)
+    {
+        pass.numTracks += thread->getNumTracksAnalysed();
+        pass.audioTimeSec += double(thread->getNumSamplesAnalysed()) / SUPPORTED_SAMPLERATE;
+        pass.peakAudioBytes.add((juce::int64)thread->getPeakAudioBytes());
+    }
+    
+    // Collect the time measurements for each analysis stage
+    for (auto* stage : benchmarkStages)
+        pass.stages.add(Profiler::getZoneStats(stage));
+    
+    pass.peakProcessBytes = getPeakProcessMemory();
+    
+    benchmarkPasses.add(pass);
+}
+
+
+void AnalysisTest::startBenchmarkPass()
+{
+    // The previous threads have run out of jobs, so wait for them to exit
+    stopThreads();
+    
+    // Reset the job queue, so that the same tracks are analysed again in the same order
+    {
+        const juce::ScopedLock sl(lock);
+        jobProgress = 0;
+        nextJob = 0;
+        testResults.clear();
+    }
+    
+    Profiler::reset();
+    
+    setNumThreads(benchmarkThreadCounts[benchmarkPass]);
+    passStartTime = juce::Time::getMillisecondCounterHiRes();
+    
+    AnalysisManager::startAnalysis(dataManager);
+}
+
+
+void AnalysisTest::writeBenchmarkResults()
+{
+    juce::Array<juce::var> passes;
+    juce::String csv;
+    
+    // The CSV has one row per pass, starting with the overall figures, then the average time for each stage
+    csv << "threads,tracks,wallTimeSec,tracksPerSec,realtimeFactor,speedup,peakProcessBytes,peakThreadAudioBytes";
+    for (auto* stage : benchmarkStages)
+        csv << "," << stage << "MeanMs," << stage << "P95Ms";
+    csv << "\n";
+    
+    DBG("\nANALYSIS BENCHMARK RESULTS...");
+    
+    // Throughput of the single-threaded pass, against which the scaling of the others is measured
+    double baseTracksPerSec = benchmarkPasses.getFirst().numTracks / benchmarkPasses.getFirst().wallTimeSec;
+    
+    for (auto& pass : benchmarkPasses)
+    {
+        double tracksPerSec = pass.numTracks / pass.wallTimeSec;
+        double realtimeFactor = pass.audioTimeSec / pass.wallTimeSec;
+        double speedup = tracksPerSec / baseTracksPerSec;
+        
+        juce::int64 peakThreadAudioBytes = 0;
+        juce::Array<juce::var> peakAudioBytes;
+        for (auto bytes : pass.peakAudioBytes)
+        {
+            peakAudioBytes.add(bytes);
+            peakThreadAudioBytes = juce::jmax(peakThreadAudioBytes, bytes);
+        }
+        
+        juce::DynamicObject::Ptr stages = new juce::DynamicObject();
+        
+        csv << pass.numThreads << "," << pass.numTracks << "," << pass.wallTimeSec << "," << tracksPerSec << "," << realtimeFactor
+            << "," << speedup << "," << pass.peakProcessBytes << "," << peakThreadAudioBytes;
+        
+        DBG("\nThreads: " << pass.numThreads << " Tracks/s: " << tracksPerSec << " Realtime Factor: " << realtimeFactor << " Speedup: " << speedup);
+        
+        for (auto& stage : pass.stages)
+        {
+            juce::DynamicObject::Ptr stageResult = new juce::DynamicObject();
+            stageResult->setProperty("count", stage.count);
+            stageResult->setProperty("totalMs", stage.totalMs);
+            stageResult->setProperty("meanMs", stage.meanMs);
+            stageResult->setProperty("p50Ms", stage.p50Ms);
+            stageResult->setProperty("p95Ms", stage.p95Ms);
+            stageResult->setProperty("p99Ms", stage.p99Ms);
+            stageResult->setProperty("maxMs", stage.maxMs);
+            stages->setProperty(stage.path, stageResult.get());
+            
+            csv << "," << stage.meanMs << "," << stage.p95Ms;
+            
+            DBG(stage.path << " Mean: " << stage.meanMs << "ms p95: " << stage.p95Ms << "ms Max: " << stage.maxMs << "ms");
+        }
+        
+        csv << "\n";
+        
+        juce::DynamicObject::Ptr result = new juce::DynamicObject();
+        result->setProperty("threads", pass.numThreads);
+        result->setProperty("tracks", pass.numTracks);
+        result->setProperty("wallTimeSec", pass.wallTimeSec);
+        result->setProperty("audioTimeSec", pass.audioTimeSec);
+        result->setProperty("tracksPerSec", tracksPerSec);
+        result->setProperty("realtimeFactor", realtimeFactor);
+        result->setProperty("speedup", speedup);
+        result->setProperty("peakProcessBytes", pass.peakProcessBytes);
+        result->setProperty("peakAudioBytesPerThread", peakAudioBytes);
+        result->setProperty("stages", stages.get());
+        passes.add(result.get());
+    }
+    
+    // Record the machine configuration, so that results from different machines can be told apart
+    juce::DynamicObject::Ptr machine = new juce::DynamicObject();
+    machine->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    machine->setProperty("cpu", juce::SystemStats::getCpuModel());
+    machine->setProperty("logicalCpus", juce::SystemStats::getNumCpus());
+    machine->setProperty("physicalCpus", juce::SystemStats::getNumPhysicalCpus());
+    
+    juce::DynamicObject::Ptr benchmark = new juce::DynamicObject();
+    benchmark->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    benchmark->setProperty("machine", machine.get());
+    benchmark->setProperty("libraryTracks", numTracks);
+    benchmark->setProperty("passes", passes);
+    
+    juce::File directory = dataManager->getDirectory();
+    juce::File jsonFile = directory.getChildFile(juce::String(BENCHMARK_FILENAME) + ".json");
+    juce::File csvFile = directory.getChildFile(juce::String(BENCHMARK_FILENAME) + ".csv");
+    
+    if (!jsonFile.replaceWithText(juce::JSON::toString(juce::var(benchmark.get()))) || !csvFile.replaceWithText(csv))
+    {
+        jassert(false); // Failed to write benchmark results
+        return;
+    }
+    
+    DBG("\nBenchmark results written to: " << jsonFile.getFullPathName());
+}
+
+
+juce::int64 AnalysisTest::getPeakProcessMemory()
+{
+#if JUCE_MAC || JUCE_LINUX
+    struct rusage usage;
+    
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+#if JUCE_MAC
+    return (juce::int64)usage.ru_maxrss; // Measured in bytes on macOS
+#else
+    return (juce::int64)usage.ru_maxrss * 1024; // Measured in kilobytes on Linux
+#endif
+
+#else
+    return 0;
+#endif
 }
@@ -9,10 +9,13 @@
 #define AnalysisTest_hpp
 
 #include "AnalysisManager.hpp"
+#include "Profiler.hpp"
 
 
 #define PHASE_JND (0.025)
 
+#define BENCHMARK_FILENAME ("AutoDjBenchmark") ///< Name of the benchmark output files (.json and .csv), which are written to the music folder
+
 
 /** Stores the test result for the analysis of a single track */
 typedef struct AnalysisTestResult {
@@ -28,17 +31,35 @@ typedef struct AnalysisTestResult {
 } AnalysisTestResult;
 
 
+/** Stores the benchmark result for a single pass over the test library, using a fixed number of analysis threads */
+typedef struct BenchmarkPass {
+    int numThreads = 0; ///< Number of analysis threads used
+    int numTracks = 0; ///< Number of tracks analysed
+    double wallTimeSec = 0.0; ///< Time taken to analyse all tracks
+    double audioTimeSec = 0.0; ///< Total length of audio analysed
+    juce::Array<ProfilerZoneStats> stages; ///< Time measurements for each analysis stage (see benchmarkStages), merged across all threads
+    juce::Array<juce::int64> peakAudioBytes; ///< Largest amount of decoded audio held at once, for each thread
+    juce::int64 peakProcessBytes = 0; ///< Peak resident memory of the whole process so far (0 if unavailable on this platform)
+} BenchmarkPass;
+
+
 /**
  Extension of AnalysisManager used for testing different anaysis algorithms.
  Instead of writing the analysis results to the track database, this compares them with a database of ground truth data.
  It then performs post-processing on the entire set of results, to produce an overall summary.
+ 
+ In benchmark mode, the library is analysed several times with an increasing number of threads (1, 2, 4... up to the default).
+ Each stage of the pipeline is timed separately, and the throughput, realtime factor, memory use and thread scaling
+ are written to the music folder as JSON and CSV, so that runs on different machines or commits can be compared.
  */
 class AnalysisTest : public AnalysisManager
 {
 public:
     
-    /** Constructor. */
-    AnalysisTest() {}
+    /** Constructor.
+     
+     @param[in] benchmark Enables benchmark mode, which repeats the analysis with different numbers of threads */
+    AnalysisTest(bool benchmark = false) : benchmarkMode(benchmark) {}
     
     /** Destructor. */
     ~AnalysisTest() {}
@@ -53,11 +74,25 @@ public:
     @return True if analysis is fully complete (progress variable is not a safe indicator of this) */
     bool isFinished(double& progress) override;
     
+    /** Every feature is recomputed when testing, so that each analyser is measured against the ground truth,
+     and the whole pipeline is timed when benchmarking.
+     
+     @param[in] track Pointer to the track to be analysed
+     
+     @return Set of features to compute (see ANALYSIS_FEATURE_BIT) */
+    int getFeaturesToAnalyse(TrackInfo* track) override { return ANALYSIS_FEATURES_ALL; }
+    
     /** Instead of storing the analysis result in the track database, this just calls processResult().
     
      @param[in] track Pointer to the track data */
     void storeAnalysis(TrackInfo* track) override;
     
+    /** Waveforms aren't evaluated, so they aren't stored either.
+     
+     @param[in] track Pointer to the track data
+     @param[in] waveform Waveform data (see AnalyserWaveform) */
+    void storeWaveform(TrackInfo* track, const juce::MemoryBlock& waveform) override {}
+    
     /** Checks a single track analysis result against the ground truth data.
     
      @param[in] track Pointer to the track data */
@@ -68,6 +103,20 @@ private:
     /** Outputs the overall test results to the debug console. */
     void printResults();
     
+    /** Stores the benchmark measurements for the pass that has just finished. */
+    void recordBenchmarkPass();
+    
+    /** Resets the analysis state and starts the next benchmark pass, using the next thread count. */
+    void startBenchmarkPass();
+    
+    /** Outputs the benchmark results to the debug console, and writes them to the music folder as JSON and CSV. */
+    void writeBenchmarkResults();
+    
+    /** Fetches the peak resident memory of the process so far.
+     
+     @return Peak memory in bytes, or 0 if unavailable on this platform */
+    static juce::int64 getPeakProcessMemory();
+    
     std::atomic<bool> initialised = false; ///< Indicates whether this has been initialised, ready for anaylsis to start
     
     juce::Array<TrackInfo> groundTruth; ///< Array of ground truth track data, which is copied from the AutoDJ database file before analysis starts
@@ -76,6 +125,18 @@ private:
     
     int numTracks; ///< Number of tracks analysed, used for averaging the overall results
     
+    const bool benchmarkMode; ///< Indicates whether this test is a benchmark
+    
+    juce::Array<int> benchmarkThreadCounts; ///< Number of analysis threads to use for each benchmark pass
+    int benchmarkPass = 0; ///< Index of the current benchmark pass
+    
+    juce::Array<BenchmarkPass> benchmarkPasses; ///< Results of the completed benchmark passes
+    
+    double passStartTime = 0.0; ///< Time at which the current benchmark pass started, in milliseconds
+    double passEndTime = 0.0; ///< Time at which the last job of the current benchmark pass was completed, in milliseconds
+    
+    juce::CriticalSection benchmarkLock; ///< Lock for benchmark state (separate from the AnalysisManager lock, which analysis threads take)
+    
 };
 
 #endif /* AnalysisTest_hpp */
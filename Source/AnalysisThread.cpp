@@ -12,7 +12,7 @@
 #include "AnalysisManager.hpp"
 
 #include "BeatTests.hpp"
-#include "PerformanceMeasure.hpp"
+#include "Profiler.hpp"
 
 
 AnalysisThread::AnalysisThread(int ID, AnalysisManager* am, DataManager* dm, essentia::standard::AlgorithmFactory& factory) :
@@ -22,6 +22,15 @@ AnalysisThread::AnalysisThread(int ID, AnalysisManager* am, DataManager* dm, ess
     analyserBeatsEssentia.reset(new AnalyserBeatsEssentia(factory));
     analyserKey.reset(new AnalyserKey());
     analyserGroove.reset(new AnalyserGroove(factory));
+    analyserSegments.reset(new AnalyserSegments());
+    analyserWaveform.reset(new AnalyserWaveform());
+    progress.store(0.0);
+}
+
+
+AnalysisThread::AnalysisThread(int ID, AnalysisManager* am, DataManager* dm) :
+    juce::Thread("AnalysisThread" + juce::String(ID)), id(ID), analysisManager(am), dataManager(dm)
+{
     progress.store(0.0);
 }
 
@@ -43,49 +52,112 @@ void AnalysisThread::run()
 
 void AnalysisThread::analyse(TrackInfo& track)
 {
+    PROFILE_ZONE("analyse")
+    
     juce::AudioBuffer<float>* buffer;
     
-    DBG("Analysis Thread " << id << ": " << track.getFilename());
+    int features = analysisManager->getFeaturesToAnalyse(&track);
+    
+    DBG("Analysis Thread " << id << ": " << track.getFilename() << " (features 0x" << juce::String::toHexString(features) << ")");
+    
+    {
+        PROFILE_ZONE("decode")
+        buffer = dataManager->loadAudio(track.getFilename(), true);
+    }
+    
+    // Keep track of the amount of audio analysed, and the largest buffer held, for benchmarking
+    size_t audioBytes = sizeof(float) * buffer->getNumChannels() * buffer->getNumSamples();
+    if (audioBytes > peakAudioBytes.load())
+        peakAudioBytes.store(audioBytes);
+    
+    juce::MemoryBlock waveform;
     
-    buffer = dataManager->loadAudio(track.getFilename(), true);
+    if (!analyseAudio(buffer, track, features, waveform)) return;
+    
+    track.analysed = (AnalysisFeatures::getStaleFeatures(track) == 0);
+    
+    numTracksAnalysed.store(numTracksAnalysed.load() + 1);
+    numSamplesAnalysed.store(numSamplesAnalysed.load() + buffer->getNumSamples());
+    
+    dataManager->releaseAudio(buffer);
     
     if (checkPauseOrExit()) return;
     
+    // The waveform is stored first, so it is already there once the track's analysis says it is current
+    if (features & ANALYSIS_FEATURE_BIT(AnalysisFeature::waveform))
+        analysisManager->storeWaveform(&track, waveform);
+    
+    analysisManager->storeAnalysis(&track);
+    
+    progress.store(1.0);
+}
+
+
+bool AnalysisThread::analyseAudio(juce::AudioBuffer<float>* buffer, TrackInfo& track, int features, juce::MemoryBlock& waveform)
+{
+    if (checkPauseOrExit()) return false;
+    
+    // The waveform is generated first, since the other analysers may process the audio in place
+    if (features & ANALYSIS_FEATURE_BIT(AnalysisFeature::waveform))
+    {
+        PROFILE_ZONE("waveform")
+        analyserWaveform->analyse(buffer, waveform);
+        AnalysisFeatures::markCurrent(track, ANALYSIS_FEATURE_BIT(AnalysisFeature::waveform));
+    }
+    
     progress.store(0.1);
     
-    PERFORMANCE_START
+    int beatFeatures = ANALYSIS_FEATURE_BIT(AnalysisFeature::beats) | ANALYSIS_FEATURE_BIT(AnalysisFeature::downbeat);
+    
+    // Segments are stored relative to the downbeats, so they must be found again whenever the beats are
+    if (features & beatFeatures)
+        features |= ANALYSIS_FEATURE_BIT(AnalysisFeature::segments);
+    
+    // The beats and downbeat come from the same analyser, so if either is stale, both are recomputed
+    if (features & beatFeatures)
+    {
+        PROFILE_ZONE("beats")
 
 #ifdef BEATS_QM
-    analyserBeats->analyse(buffer, &progress, track.bpm, track.beatPhase, track.downbeat);
+        analyserBeats->analyse(buffer, &progress, track.bpm, track.beatPhase, track.downbeat);
 #else
-    analyserBeatsEssentia->analyse(buffer, &progress, track.bpm, track.beatPhase, track.downbeat);
+        analyserBeatsEssentia->analyse(buffer, &progress, track.bpm, track.beatPhase, track.downbeat);
 #endif
+        
+        AnalysisFeatures::markCurrent(track, beatFeatures);
+    }
     
-    PERFORMANCE_END
-    
-    if (checkPauseOrExit()) return;
+    if (checkPauseOrExit()) return false;
     
     progress.store(0.7);
     
-    analyserKey->analyse(buffer, track.key);
+    if (features & ANALYSIS_FEATURE_BIT(AnalysisFeature::key))
+    {
+        PROFILE_ZONE("key")
+        analyserKey->analyse(buffer, track.key);
+        AnalysisFeatures::markCurrent(track, ANALYSIS_FEATURE_BIT(AnalysisFeature::key));
+    }
     
     progress.store(0.8);
     
-    analyserGroove->analyse(buffer, track.groove);
+    if (features & ANALYSIS_FEATURE_BIT(AnalysisFeature::groove))
+    {
+        PROFILE_ZONE("groove")
+        analyserGroove->analyse(buffer, track.groove);
+        AnalysisFeatures::markCurrent(track, ANALYSIS_FEATURE_BIT(AnalysisFeature::groove));
+    }
     
     progress.store(0.9);
     
-    if (checkPauseOrExit()) return;
-    
-    track.analysed = true;
-    
-    dataManager->releaseAudio(buffer);
-    
-    if (checkPauseOrExit()) return;
-    
-    analysisManager->storeAnalysis(&track);
+    // Segmentation is done here rather than when a track is chosen for the mix, so that the mix doesn't have to wait for it
+    if (features & ANALYSIS_FEATURE_BIT(AnalysisFeature::segments))
+    {
+        PROFILE_ZONE("segments")
+        analyserSegments->analyse(&track, buffer);
+        AnalysisFeatures::markCurrent(track, ANALYSIS_FEATURE_BIT(AnalysisFeature::segments));
+    }
     
-    progress.store(1.0);
+    return !checkPauseOrExit();
 }
 
 
@@ -14,6 +14,8 @@
 #include "AnalyserBeatsEssentia.hpp"
 #include "AnalyserKey.hpp"
 #include "AnalyserGroove.hpp"
+#include "AnalyserSegments.hpp"
+#include "AnalyserWaveform.hpp"
 
 class DataManager;
 class AnalysisManager;
@@ -35,6 +37,18 @@ public:
     /** Thread running loop, which will continue until there are no more tracks to analyse. */
     void run();
     
+    /** Runs the MIR analysers on decoded audio, storing the results in the given track, and marking them as current.
+     Only the analysers for the requested features are run, so that stale features can be recomputed on their own.
+     This can also be called without starting the thread (with null manager pointers), e.g. in an analysis worker process.
+     
+     @param[in] buffer Decoded mono audio of the track (processed in place)
+     @param[in,out] track Track being analysed - note the results are stored in this reference variable
+     @param[in] features Set of features to compute (see ANALYSIS_FEATURE_BIT)
+     @param[out] waveform Output location for the waveform overview, if it is one of the features (it is too large to keep in TrackInfo)
+     
+     @return False if analysis was aborted because the thread was asked to exit */
+    bool analyseAudio(juce::AudioBuffer<float>* buffer, TrackInfo& track, int features, juce::MemoryBlock& waveform);
+    
     /** Fetches analysis progress for the current track.
      
      @return Analysis progress (0.0 to 1.0) */
@@ -44,12 +58,30 @@ public:
      Note that this is not instant: the thread-safe 'pause' flag is checked periodically on the analysis thread.*/
     void playPause() { pause.store(!pause.load()); }
     
-private:
+    /** Fetches the number of tracks analysed by this thread.
+     
+     @return Number of tracks */
+    int getNumTracksAnalysed() { return numTracksAnalysed.load(); }
+    
+    /** Fetches the total length of audio analysed by this thread.
+     
+     @return Number of audio samples */
+    juce::int64 getNumSamplesAnalysed() { return numSamplesAnalysed.load(); }
+    
+    /** Fetches the largest amount of decoded audio held by this thread at once.
+     
+     @return Peak audio memory, in bytes */
+    size_t getPeakAudioBytes() { return peakAudioBytes.load(); }
+    
+protected:
+    
+    /** Constructor for subclasses which don't analyse audio on this thread, so don't need the analysers (e.g. AnalysisWorkerThread). */
+    AnalysisThread(int ID, AnalysisManager* am, DataManager* dm);
     
     /** Pushes the provided track through the analysis pipeline, first calling DataManager to load the associated audio data.
      
      @param[in,out] track Track to be analysed - note the results are stored in this reference variable */
-    void analyse(TrackInfo& track);
+    virtual void analyse(TrackInfo& track);
     
     /** Called periodically during analysis to check if the thread should sleep or exit (or neither).
      
@@ -62,14 +94,22 @@ private:
     
     std::atomic<bool> pause = false; ///< Tracks whether analysis is active or paused
     
+    std::atomic<int> numTracksAnalysed = 0; ///< Number of tracks analysed by this thread
+    std::atomic<juce::int64> numSamplesAnalysed = 0; ///< Total length of audio analysed by this thread
+    std::atomic<size_t> peakAudioBytes = 0; ///< Largest amount of decoded audio held by this thread at once
+    
     AnalysisManager* analysisManager = nullptr; ///< Pointer to the manager of this thread
     DataManager* dataManager = nullptr; ///< Pointer to the app's track data manager
     
+private:
+    
     // Analysis handlers
     std::unique_ptr<AnalyserBeats> analyserBeats; ///< Temporal MIR analyser (using QM-DSP algorithms)
     std::unique_ptr<AnalyserBeatsEssentia> analyserBeatsEssentia; ///< Temporal MIR analyser (using QM-DSP and Essentia algorithms)
     std::unique_ptr<AnalyserKey> analyserKey; ///< Tonal MIR analyser
     std::unique_ptr<AnalyserGroove> analyserGroove; ///< Danceability analyser
+    std::unique_ptr<AnalyserSegments> analyserSegments; ///< Structural segmentation analyser
+    std::unique_ptr<AnalyserWaveform> analyserWaveform; ///< Waveform overview generator
     
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalysisThread) ///< JUCE macro to add a memory leak detector
@@ -0,0 +1,253 @@
+//
+//  AnalysisWorkerPool.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "AnalysisWorkerPool.hpp"
+
+#include "DataManager.hpp"
+#include "Profiler.hpp"
+
+
+static std::atomic<bool> workerPoolEnabled {false}; ///< Indicates whether DataManagers should analyse in worker processes
+static std::atomic<int> workerPoolSize {-1}; ///< Number of worker processes to run at once, or -1 to choose automatically
+
+
+AnalysisWorkerPool::AnalysisWorkerPool()
+{
+    // Each worker has its own address space, so the pool can use every core (leaving two for the app, as AnalysisManager does)
+    if (workerPoolSize.load() > 0)
+        numThreadsOverride = workerPoolSize.load();
+    else
+        numThreadsOverride = juce::jmax(1, juce::SystemStats::getNumCpus() - 2);
+}
+
+
+void AnalysisWorkerPool::setEnabled(bool shouldBeEnabled, int numWorkers)
+{
+    workerPoolSize.store(numWorkers);
+    workerPoolEnabled.store(shouldBeEnabled);
+}
+
+
+bool AnalysisWorkerPool::isEnabled()
+{
+    return workerPoolEnabled.load();
+}
+
+
+int AnalysisWorkerPool::runWorker(juce::File file, int features)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerFormat(new juce::WavAudioFormat(), false);
+    formatManager.registerFormat(new juce::MP3AudioFormat(), false);
+    
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+    
+    if (reader == nullptr)
+        return 1;
+    
+    // Decode the audio as DataManager::loadAudio() does for analysis
+    juce::AudioBuffer<float> buffer((int)reader->numChannels, (int)reader->lengthInSamples);
+    reader->read(buffer.getArrayOfWritePointers(), reader->numChannels, 0, (int)reader->lengthInSamples);
+    DataManager::adjustChannels(&buffer, true);
+    
+    essentia::init();
+    
+    // Use the same analysers as in-process analysis, without starting the thread
+    TrackInfo track;
+    juce::MemoryBlock waveform;
+    AnalysisThread analyser(0, nullptr, nullptr, essentia::standard::AlgorithmFactory::instance());
+    
+    if (!analyser.analyseAudio(&buffer, track, features, waveform))
+        return 1;
+    
+    // The waveform is too large to print, so it is stored in the library's database directly
+    if (features & ANALYSIS_FEATURE_BIT(AnalysisFeature::waveform))
+    {
+        SqlDatabase database;
+        
+        if (!database.initialise(file.getParentDirectory()))
+            return 1;
+        
+        database.storeWaveform(DataManager::getHash(file), waveform);
+    }
+    
+    juce::DynamicObject::Ptr result = new juce::DynamicObject();
+    result->setProperty("features", AnalysisFeatures::getCurrentFeatures(track));
+    result->setProperty("bpm", track.bpm);
+    result->setProperty("beatPhase", track.beatPhase);
+    result->setProperty("downbeat", track.downbeat);
+    result->setProperty("key", track.key);
+    result->setProperty("groove", track.groove);
+    
+    juce::Array<juce::var> segmentBars;
+    for (int i = 0; i < track.numSegments; i++)
+        segmentBars.add(track.segmentBars[i]);
+    result->setProperty("segmentBars", segmentBars);
+    result->setProperty("numSamples", buffer.getNumSamples());
+    
+    // The result is printed last, so a worker that crashes never produces one
+    std::cout << ANALYSIS_WORKER_RESULT_PREFIX << juce::JSON::toString(juce::var(result.get()), true) << std::endl;
+    
+    return 0;
+}
+
+
+juce::StringArray AnalysisWorkerPool::getWorkerCommand(juce::File audioFile, int features)
+{
+    juce::File executable = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
+    
+    // Both options take the "--option=value" form, which is all juce::ArgumentList::getValueForOption() understands
+    juce::StringArray command;
+    command.add(executable.getFullPathName());
+    command.add(ANALYSIS_WORKER_FEATURES_OPTION + juce::String("=") + juce::String(features));
+    command.add(ANALYSIS_WORKER_OPTION + juce::String("=") + audioFile.getFullPathName());
+    
+    return command;
+}
+
+
+bool AnalysisWorkerPool::parseWorkerResult(const juce::String& output, TrackInfo& analysed, int& features, juce::int64& numSamples)
+{
+    // A crashed worker can still exit with code 0 on some platforms, so a result line is required too
+    juce::String resultLine;
+    
+    for (auto& line : juce::StringArray::fromLines(output))
+    {
+        if (line.startsWith(ANALYSIS_WORKER_RESULT_PREFIX))
+            resultLine = line.fromFirstOccurrenceOf(ANALYSIS_WORKER_RESULT_PREFIX, false, false);
+    }
+    
+    juce::var result = juce::JSON::parse(resultLine);
+    
+    if (!result.isObject())
+        return false;
+    
+    analysed.bpm = result["bpm"];
+    analysed.beatPhase = result["beatPhase"];
+    analysed.downbeat = result["downbeat"];
+    analysed.key = result["key"];
+    analysed.groove = result["groove"];
+    
+    if (auto* segmentBars = result["segmentBars"].getArray())
+    {
+        for (auto& bar : *segmentBars)
+        {
+            if (analysed.numSegments < TRACK_SEGMENTS_MAX)
+                analysed.segmentBars[analysed.numSegments++] = bar;
+        }
+    }
+    
+    features = result["features"];
+    numSamples = (juce::int64)result["numSamples"];
+    
+    return true;
+}
+
+
+AnalysisThread* AnalysisWorkerPool::createThread(int id)
+{
+    return new AnalysisWorkerThread(id, this, dataManager);
+}
+
+
+void AnalysisWorkerThread::analyse(TrackInfo& track)
+{
+    PROFILE_ZONE("analyseInWorker")
+    
+    // Claim the track, so that other processes analysing the same library leave it alone
+    // (the lock is released when this function returns, or if this process dies)
+    juce::InterProcessLock claim(ANALYSIS_WORKER_CLAIM_PREFIX + juce::String::toHexString(track.hash));
+    
+    if (!claim.enter(0))
+    {
+        // Another process is analysing it, so come back to it once the rest of the queue has been started
+        analysisManager->deferJob(&track);
+        sleep(ANALYSIS_WORKER_DEFER_MS);
+        return;
+    }
+    
+    // If another process has already analysed it, use its results
+    if (dataManager->readStoredAnalysis(&track))
+    {
+        analysisManager->storeAnalysis(&track);
+        return;
+    }
+    
+    // Only the features which are still outdated are sent to the worker
+    int features = analysisManager->getFeaturesToAnalyse(&track);
+    
+    for (int attempt = 1; attempt <= ANALYSIS_WORKER_MAX_ATTEMPTS; attempt++)
+    {
+        if (checkPauseOrExit()) return;
+        
+        if (runWorkerProcess(track, features))
+        {
+            analysisManager->storeAnalysis(&track);
+            progress.store(1.0);
+            return;
+        }
+        
+        DBG("Analysis worker failed on " << track.getFilename() << " (attempt " << attempt << " of " << ANALYSIS_WORKER_MAX_ATTEMPTS << ")");
+    }
+    
+    // Skip the track, so that it doesn't hold up the rest of the library
+    analysisManager->jobFailed(&track);
+}
+
+
+bool AnalysisWorkerThread::runWorkerProcess(TrackInfo& track, int features)
+{
+    juce::File audioFile = dataManager->getDirectory().getChildFile(track.getFilename());
+    
+    juce::ChildProcess worker;
+    
+    if (!worker.start(AnalysisWorkerPool::getWorkerCommand(audioFile, features), juce::ChildProcess::wantStdOut))
+    {
+        jassert(false); // Failed to launch a worker process
+        return false;
+    }
+    
+    progress.store(0.0);
+    
+    juce::uint32 startMs = juce::Time::getMillisecondCounter();
+    juce::uint32 timeoutMs = ANALYSIS_WORKER_TIMEOUT_BASE_MS + juce::uint32(track.length) * ANALYSIS_WORKER_TIMEOUT_MS_PER_SEC;
+    double expectedMs = juce::jmax(1.0, double(track.length) * ANALYSIS_WORKER_EXPECTED_MS_PER_SEC);
+    
+    while (!worker.waitForProcessToFinish(ANALYSIS_WORKER_POLL_MS))
+    {
+        juce::uint32 elapsedMs = juce::Time::getMillisecondCounter() - startMs;
+        
+        // Kill the worker if it has hung, or if analysis is being stopped
+        if (threadShouldExit() || elapsedMs > timeoutMs)
+        {
+            worker.kill();
+            return false;
+        }
+        
+        // The worker can't report its progress, so estimate it
+        progress.store(juce::jmin(0.9, elapsedMs / expectedMs));
+    }
+    
+    juce::String output = worker.readAllProcessOutput();
+    
+    TrackInfo analysed;
+    int computed = 0;
+    juce::int64 numSamples = 0;
+    
+    if (worker.getExitCode() != 0 || !AnalysisWorkerPool::parseWorkerResult(output, analysed, computed, numSamples))
+        return false;
+    
+    // The worker runs the same executable, so its analysers are the current versions
+    AnalysisFeatures::markCurrent(analysed, computed);
+    AnalysisFeatures::copyFeatures(track, analysed, computed);
+    track.analysed = (AnalysisFeatures::getStaleFeatures(track) == 0);
+    
+    numTracksAnalysed.store(numTracksAnalysed.load() + 1);
+    numSamplesAnalysed.store(numSamplesAnalysed.load() + numSamples);
+    
+    return true;
+}
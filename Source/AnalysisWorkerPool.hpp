@@ -0,0 +1,141 @@
+//
+//  AnalysisWorkerPool.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef AnalysisWorkerPool_hpp
+#define AnalysisWorkerPool_hpp
+
+#include <JuceHeader.h>
+#include "AnalysisManager.hpp"
+
+
+#define ANALYSIS_WORKER_OPTION ("--analysis-worker-file") ///< Command-line option which runs the executable as a worker, analysing the audio file given as its value (--analysis-worker-file=<path>)
+#define ANALYSIS_WORKER_FEATURES_OPTION ("--analysis-worker-features") ///< Command-line option (before ANALYSIS_WORKER_OPTION) giving the set of features a worker computes
+#define ANALYSIS_WORKER_RESULT_PREFIX ("AutoDJResult:") ///< Prefix of the line on which a worker prints its results (as JSON)
+#define ANALYSIS_WORKER_TIMEOUT_BASE_MS (30000) ///< Time allowed for a worker to start and decode its track
+#define ANALYSIS_WORKER_TIMEOUT_MS_PER_SEC (500) ///< Additional time allowed for each second of audio, before a worker is assumed to have hung
+#define ANALYSIS_WORKER_EXPECTED_MS_PER_SEC (50) ///< Typical analysis time for each second of audio, used to estimate a worker's progress
+#define ANALYSIS_WORKER_MAX_ATTEMPTS (2) ///< Number of workers launched for a track before it is skipped
+#define ANALYSIS_WORKER_POLL_MS (100) ///< Interval at which a running worker is checked
+#define ANALYSIS_WORKER_DEFER_MS (500) ///< Time to wait after deferring a track which another process is analysing
+#define ANALYSIS_WORKER_CLAIM_PREFIX ("AutoDJAnalysis-") ///< Prefix of the inter-process lock which claims a track for analysis
+
+
+/**
+ Analyses the library in separate worker processes, rather than in-process AnalysisThreads, so that a file which
+ crashes or hangs the analysers (e.g. a malformed MP3) only loses that track, rather than the whole app and its mix.
+ 
+ Each job launches the current executable with ANALYSIS_WORKER_OPTION (see runWorker()), which prints its results on stdout.
+ A worker that crashes, hangs past its timeout, or prints no result is restarted, up to ANALYSIS_WORKER_MAX_ATTEMPTS times.
+ Results are stored in the library's database by this process, exactly as in-process analysis results are
+ (except for waveform overviews, which are too large to print, so the worker stores them itself).
+ 
+ Each track is claimed with an inter-process lock while it is analysed, so several AutoDJ processes (e.g. the app and
+ AutoDJ-Console, or several consoles) can analyse the same library cooperatively: a track claimed by another process is
+ deferred, and once that process has finished it, its results are read back from the database instead of being repeated.
+ 
+ The pool isn't limited to MAX_NUM_THREADS, since each worker has its own address space.
+ Enable it with setEnabled() before the DataManager is created (e.g. "--analysis-workers" on the command line).
+ */
+class AnalysisWorkerPool : public AnalysisManager
+{
+public:
+    
+    /** Constructor. */
+    AnalysisWorkerPool();
+    
+    /** Destructor. */
+    ~AnalysisWorkerPool() {}
+    
+    /** Enables/disables worker processes for analysis, for any DataManager created afterwards.
+     
+     @param[in] shouldBeEnabled New state
+     @param[in] numWorkers Number of worker processes to run at once, or -1 to choose automatically based on the number of CPU cores */
+    static void setEnabled(bool shouldBeEnabled, int numWorkers = -1);
+    
+    /** Checks whether worker processes are enabled.
+     
+     @return True if enabled */
+    static bool isEnabled();
+    
+    /** Analyses a single audio file and prints the results, in a worker process - this is called by the executable's
+     main function when launched with ANALYSIS_WORKER_OPTION, and must not be called by the process that owns the pool.
+     
+     @param[in] file Audio file to analyse
+     @param[in] features Set of features to compute (see ANALYSIS_FEATURE_BIT), given by ANALYSIS_WORKER_FEATURES_OPTION
+     
+     @return Process exit code (0 if successful) */
+    static int runWorker(juce::File file, int features = ANALYSIS_FEATURES_REQUIRED);
+    
+    /** Builds the command line which launches a worker process on an audio file (the current executable, with
+     ANALYSIS_WORKER_FEATURES_OPTION and ANALYSIS_WORKER_OPTION).
+     
+     @param[in] audioFile Audio file for the worker to analyse
+     @param[in] features Set of features for the worker to compute (see ANALYSIS_FEATURE_BIT)
+     
+     @return Executable and arguments, for juce::ChildProcess::start() */
+    static juce::StringArray getWorkerCommand(juce::File audioFile, int features);
+    
+    /** Reads the results printed by a worker process (see runWorker()).
+     
+     @param[in] output Everything the worker printed on stdout
+     @param[out] analysed Track data computed by the worker
+     @param[out] features Set of features the worker computed (see ANALYSIS_FEATURE_BIT)
+     @param[out] numSamples Length of the audio the worker analysed, in samples
+     
+     @return True if the output contained a result */
+    static bool parseWorkerResult(const juce::String& output, TrackInfo& analysed, int& features, juce::int64& numSamples);
+    
+protected:
+    
+    /** Creates a thread which supervises worker processes, rather than analysing audio itself.
+     
+     @param[in] id Number of the thread
+     
+     @return New AnalysisWorkerThread (not yet started) */
+    AnalysisThread* createThread(int id) override;
+    
+private:
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalysisWorkerPool) ///< JUCE macro to add a memory leak detector
+};
+
+
+/**
+ Takes jobs from an AnalysisWorkerPool, like an AnalysisThread, but analyses each track in a separate worker process.
+ */
+class AnalysisWorkerThread : public AnalysisThread
+{
+public:
+    
+    /** Constructor. */
+    AnalysisWorkerThread(int ID, AnalysisManager* am, DataManager* dm) : AnalysisThread(ID, am, dm) {}
+    
+    /** Destructor. */
+    ~AnalysisWorkerThread() {}
+    
+protected:
+    
+    /** Claims the track, then launches worker processes until one analyses it, or the attempts run out.
+     
+     @param[in,out] track Track to be analysed - note the results are stored in this reference variable */
+    void analyse(TrackInfo& track) override;
+    
+private:
+    
+    /** Runs a single worker process on the track, killing it if it exceeds its timeout.
+     
+     @param[in,out] track Track to be analysed - note the results are stored in this reference variable
+     @param[in] features Set of features for the worker to compute (see ANALYSIS_FEATURE_BIT)
+     
+     @return True if the worker produced a result */
+    bool runWorkerProcess(TrackInfo& track, int features);
+    
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AnalysisWorkerThread) ///< JUCE macro to add a memory leak detector
+};
+
+#endif /* AnalysisWorkerPool_hpp */
@@ -0,0 +1,103 @@
+//
+//  AnalysisWorkerTest.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "AnalysisWorkerTest.hpp"
+
+#include "AnalysisWorkerPool.hpp"
+#include "CommonDefs.hpp"
+#include "DataManager.hpp"
+
+
+namespace AnalysisWorkerTest {
+
+/** Writes a stereo click track, with a louder click on each downbeat, as a 16-bit WAV file.
+ 
+ @param[in] file File to write
+ 
+ @return True if the file was written */
+static bool writeClickTrack(juce::File file)
+{
+    int numSamples = WORKER_TEST_SECONDS * SUPPORTED_SAMPLERATE;
+    int beatLength = 60 * SUPPORTED_SAMPLERATE / WORKER_TEST_BPM;
+    int clickLength = SUPPORTED_SAMPLERATE / 50;
+    
+    juce::AudioBuffer<float> audio(2, numSamples);
+    audio.clear();
+    
+    for (int beat = 0; beat * beatLength < numSamples; beat++)
+    {
+        float gain = (beat % 4 == 0) ? 0.8f : 0.4f;
+        int start = beat * beatLength;
+        
+        for (int i = 0; i < clickLength && start + i < numSamples; i++)
+        {
+            float envelope = 1.0f - float(i) / clickLength;
+            float sample = gain * envelope * std::sin(juce::MathConstants<float>::twoPi * 1000.0f * i / SUPPORTED_SAMPLERATE);
+            audio.setSample(0, start + i, sample);
+            audio.setSample(1, start + i, sample);
+        }
+    }
+    
+    juce::WavAudioFormat format;
+    std::unique_ptr<juce::AudioFormatWriter> writer(format.createWriterFor(new juce::FileOutputStream(file), SUPPORTED_SAMPLERATE, 2, 16, {}, 0));
+    
+    return writer != nullptr && writer->writeFromAudioSampleBuffer(audio, 0, numSamples);
+}
+
+
+bool run()
+{
+    juce::File library = juce::File::getSpecialLocation(juce::File::tempDirectory).getNonexistentChildFile(WORKER_TEST_FOLDER, "", false);
+    juce::File audioFile = library.getChildFile("Click Track.wav");
+    
+    if (!AutoDJ::checkTest(library.createDirectory().wasOk() && writeClickTrack(audioFile), "write a click track to " + audioFile.getFullPathName()))
+        return false;
+    
+    bool passed = true;
+    
+    // Launch the worker exactly as AnalysisWorkerThread does
+    juce::ChildProcess worker;
+    
+    if (AutoDJ::checkTest(worker.start(AnalysisWorkerPool::getWorkerCommand(audioFile, ANALYSIS_FEATURES_ALL), juce::ChildProcess::wantStdOut), "launch a worker process"))
+    {
+        int timeoutMs = ANALYSIS_WORKER_TIMEOUT_BASE_MS + WORKER_TEST_SECONDS * ANALYSIS_WORKER_TIMEOUT_MS_PER_SEC;
+        
+        if (!worker.waitForProcessToFinish(timeoutMs))
+            worker.kill();
+        
+        juce::String output = worker.readAllProcessOutput();
+        
+        TrackInfo analysed;
+        int features = 0;
+        juce::int64 numSamples = 0;
+        
+        passed &= AutoDJ::checkTest(worker.getExitCode() == 0, "worker exits with code 0");
+        passed &= AutoDJ::checkTest(AnalysisWorkerPool::parseWorkerResult(output, analysed, features, numSamples), "worker prints a result");
+        passed &= AutoDJ::checkTest(features == ANALYSIS_FEATURES_ALL, "worker computes every requested feature");
+        passed &= AutoDJ::checkTest(numSamples == WORKER_TEST_SECONDS * SUPPORTED_SAMPLERATE, "worker analyses the whole file");
+        passed &= AutoDJ::checkTest(analysed.bpm > 0, "worker finds a tempo (" + juce::String(analysed.bpm) + " BPM, expected " + juce::String(WORKER_TEST_BPM) + ")");
+        
+        // The worker stores the waveform itself, since it's too large to print
+        SqlDatabase database;
+        juce::MemoryBlock waveform;
+        
+        passed &= AutoDJ::checkTest(database.initialise(library) && database.readWaveform(DataManager::getHash(audioFile), waveform) && waveform.getSize() > 0,
+                                    "worker stores the waveform in the library's database");
+    }
+    else
+    {
+        passed = false;
+    }
+    
+    library.deleteRecursively();
+    
+    std::cout << (passed ? "Worker test passed" : "Worker test failed") << std::endl;
+    
+    return passed;
+}
+
+}
@@ -0,0 +1,35 @@
+//
+//  AnalysisWorkerTest.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef AnalysisWorkerTest_hpp
+#define AnalysisWorkerTest_hpp
+
+#include <JuceHeader.h>
+
+
+#define WORKER_TEST_SECONDS (60) ///< Length of the synthetic track analysed by the test
+#define WORKER_TEST_BPM (120) ///< Tempo of the synthetic track's clicks
+#define WORKER_TEST_FOLDER ("AutoDJ Worker Test") ///< Name of the temporary library (which contains a space, as the worker's path must survive quoting)
+
+
+/**
+ End-to-end test of a single AnalysisWorkerPool job: writes a synthetic click track to a temporary library, launches a
+ worker process on it with the same command line as AnalysisWorkerThread, and checks the worker's exit code, the result
+ it prints, and the waveform overview it stores in the library's database.
+ 
+ Run it with: AutoDJ-Console --test-worker
+ */
+namespace AnalysisWorkerTest {
+
+/** Runs the test, printing each check as it goes.
+ 
+ @return True if every check passed */
+bool run();
+
+}
+
+#endif /* AnalysisWorkerTest_hpp */
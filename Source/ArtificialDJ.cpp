@@ -7,15 +7,21 @@
 
 #include "ArtificialDJ.hpp"
 
-#define MIX_QUEUE_LENGTH (3)
+#include "Profiler.hpp"
 
+#define MIX_QUEUE_LENGTH (3) ///< Maximum number of mixes handed to the decks at once (including the one being performed)
+#define MIX_NUM_SPECULATIVE (2) ///< Number of likely next tracks to decode while idle (the chooser picks from the top two)
+#define MIX_WAIT_MIN_MS (50) ///< Shortest time the DJ thread sleeps between checks, e.g. while waiting for the decks to take a mix
+#define MIX_WAIT_MAX_MS (2000) ///< Longest time the DJ thread sleeps between checks, since the schedule is only an estimate
+#define MIX_WAIT_SKIP_MS (20) ///< Time the DJ thread sleeps while waiting for a requested skip to be performed
 
-ArtificialDJ::ArtificialDJ(DataManager* dm) :
-    juce::Thread("ArtificialDJ"), dataManager(dm)
+
+ArtificialDJ::ArtificialDJ(DataManager* dm, bool shared) :
+    juce::Thread("ArtificialDJ"), dataManager(dm), sharedHistory(shared)
 {
     initialised.store(false);
     
-    chooser.reset(new TrackChooser(dataManager, &randomGenerator));
+    chooser.reset(new TrackChooser(dataManager, &randomGenerator, sharedHistory));
 }
 
 
@@ -27,35 +33,116 @@ void ArtificialDJ::run()
     // While the thread is allowed to continue...
     while (!threadShouldExit())
     {
-        // If the mix queue is not full, generate a new mix
-        if (mixQueue.size() < MIX_QUEUE_LENGTH)
+        // Free the audio of any tracks that have finished playing
+        releaseFinishedAudio();
+        
+        double secondsUntilDue = getSecondsUntilNextMix();
+        
+        // If the next mix is due, prepare it
+        if (secondsUntilDue <= 0.0 && !endingConfirm.load() && handedMixes.size() < MIX_QUEUE_LENGTH)
+        {
+            int numHanded = handedMixes.size();
+            
+            // (If the mix is ending, this checks whether any new tracks have been added)
             generateMix();
+            
+            // If the mix is ending, hand over the final mix once the decks have taken all the others
+            pushFinalMix();
+            
+            // If a mix was handed over, check straight away whether the one after it is also due
+            if (handedMixes.size() > numHanded)
+                continue;
+        }
+        else
+        {
+            // Otherwise, use the spare time to decode the tracks most likely to be chosen next
+            speculate();
+        }
+        
+        int waitMs;
         
-        // Pause this thread for 1 second
-        sleep(1000);
+        if (endingConfirm.load())
+            waitMs = MIX_WAIT_MAX_MS; // Nothing left to prepare
+        else if (audioProcessor->isSkipPending())
+            waitMs = MIX_WAIT_SKIP_MS; // The schedule will change once the skip is performed
+        else
+            waitMs = juce::jlimit(MIX_WAIT_MIN_MS, MIX_WAIT_MAX_MS, juce::roundToInt(secondsUntilDue * 1000.0));
+        
+        // Sleep until the next mix is due, or until woken by notify()
+        wait(waitMs);
     }
 }
 
 
 MixInfo ArtificialDJ::getNextMix(MixInfo current)
 {
-    const juce::ScopedLock sl(lock);
+    PROFILE_ZONE("getNextMix")
     
-    if (ending.load())
-        endingConfirm.store(true);
+    // Both decks ask for the next mix when a transition finishes, so make sure they get the same answer
+    // (otherwise a mix arriving between the two calls would leave the decks out of step)
+    if (hasLastRequest && current.id == lastRequestId)
+        return lastResult;
+    
+    MixInfo next;
     
-    removeMix(current);
+    // If the finished mix is at the front of the queue, remove it
+    if (handoff.peek(next) && next.id == current.id)
+        handoff.pop();
     
-    if (mixQueue.size() == 0)
+    if (!handoff.peek(next))
     {
-        if (ending.load())
-            return MixInfo();
+        // The next mix isn't ready, so hold the new leading track until it is (see AudioProcessor::updateHold())
+        if (current.id == MIX_ID_HOLD)
+            next = current;
+        else if (current.nextTrack != nullptr)
+            next = makeHoldMix(current);
+        else // There is no new leading track, so the mix has ended
+            next = MixInfo();
+    }
+    
+    hasLastRequest = true;
+    lastRequestId = current.id;
+    lastResult = next;
+    
+    return next;
+}
+
+
+bool ArtificialDJ::fitMix(MixInfo& mix, int leaderPlayhead)
+{
+    // The final mix just plays the leading track to the end, so it always fits
+    if (mix.nextTrack == nullptr)
+        return true;
+    
+    int barLength = mix.leadingTrack->getBarLength();
+    int trackLength = mix.leadingTrack->getLengthSamples();
+    int mixLength = juce::jmax(1, mix.leaderEnd - mix.leaderStart);
+    
+    // Leave at least a bar before the transition, so the leader has time to reach the mix bpm
+    int earliestStart = leaderPlayhead + barLength;
+    
+    // If the leader has passed the start point, shift the mix later by whole bars, so it stays in phase
+    if (mix.leaderStart < earliestStart)
+    {
+        int numBars = (earliestStart - mix.leaderStart + barLength - 1) / barLength;
+        mix.leaderStart += numBars * barLength;
+        mix.leaderEnd += numBars * barLength;
+    }
+    
+    // If the mix now runs past the end of the leading track, shorten it to the whole bars remaining
+    if (mix.leaderEnd > trackLength)
+    {
+        int newLength = ((trackLength - mix.leaderStart) / barLength) * barLength;
+        
+        if (newLength < barLength)
+            return false;
         
-        jassert(false); // Mix queue was empty!
-        generateMix();
+        // Shorten the follower's part of the mix in proportion
+        mix.followerEnd = mix.followerStart + int(juce::int64(mix.followerEnd - mix.followerStart) * newLength / mixLength);
+        mix.leaderEnd = mix.leaderStart + newLength;
     }
     
-    return mixQueue.getUnchecked(0);
+    return true;
 }
 
 
@@ -90,9 +177,7 @@ bool ArtificialDJ::isMixReady(int minimumReady)
     if (!initialised.load())
         return false;
     
-    const juce::ScopedLock sl(lock);
-    
-    return (mixQueue.size() >= minimumReady);
+    return (handoff.getNumReady() >= minimumReady);
 }
 
 
@@ -104,7 +189,7 @@ bool ArtificialDJ::canSkip()
     if (!playing)
         return false;
     
-    return isMixReady(2);
+    return isMixReady(1);
 }
 
 
@@ -112,6 +197,10 @@ void ArtificialDJ::reset()
 {
     stopThread(5000);
     
+    // Stop the audio thread taking mixes before the queue is cleared
+    if (audioProcessor != nullptr)
+        audioProcessor->pause();
+    
     playing = false;
     
     initialised.store(false);
@@ -120,19 +209,200 @@ void ArtificialDJ::reset()
     
     mixIdCounter = 0;
     
+    handoff.reset();
+    finalMix = MixInfo();
+    hasLastRequest = false;
+    
+    // Release all the audio decoded by the DJ
+    dataManager->releaseAudio(leadingAudio);
+    leadingAudio = nullptr;
+    
+    for (auto& mix : handedMixes)
+        dataManager->releaseAudio(mix.nextTrackAudio);
+    handedMixes.clear();
+    
+    numMixesFinished.store(0);
+    numMixesReleased = 0;
+    
+    for (auto* audio : speculativeAudio)
+        dataManager->releaseAudio(audio);
+    speculativeTracks.clear();
+    speculativeAudio.clear();
+    
     leadingTrack = nullptr;
 }
 
 
-void ArtificialDJ::removeMix(MixInfo mix)
+MixInfo ArtificialDJ::makeHoldMix(const MixInfo& finished)
+{
+    MixInfo hold;
+    
+    hold.id = MIX_ID_HOLD;
+    // The track that was mixed in is now leading, and there is no next track yet
+    hold.leadingTrack = finished.nextTrack;
+    // Keep the tempo of the finished transition
+    hold.bpm = finished.bpm;
+    // Set the start and end of the hold to the end of the leading track (it is looped before reaching it, see TrackProcessor::holdLoop())
+    hold.leaderStart = hold.leaderEnd = hold.leadingTrack->getLengthSamples();
+    
+    return hold;
+}
+
+
+void ArtificialDJ::pushFinalMix()
+{
+    if (!ending.load() || endingConfirm.load())
+        return;
+    
+    // Wait until the decks have taken every other mix, in case a new track is added in the meantime
+    if (handoff.getNumReady() > 0)
+        return;
+    
+    DBG("MIX ENDING CONFIRMED");
+    
+    handMix(finalMix);
+    endingConfirm.store(true);
+}
+
+
+void ArtificialDJ::handMix(const MixInfo& mix)
 {
-    if (mixQueue.size() > 0)
+    if (!handoff.push(mix))
     {
-        if (mixQueue.getUnchecked(0).id == mix.id)
+        jassert(false); // Mix queue is full (see MIX_QUEUE_LENGTH)
+        return;
+    }
+    
+    handedMixes.add(mix);
+}
+
+
+double ArtificialDJ::getSecondsUntilNextMix()
+{
+    // If the leader is being held, the decks are already waiting for the next mix
+    if (audioProcessor->getLeaderMixId() == MIX_ID_HOLD)
+        return 0.0;
+    
+    // Work out when each handed mix ends, starting with the one being performed
+    // (This is measured in samples of the original tracks, ignoring time stretching, which is close enough for scheduling)
+    int position = audioProcessor->getLeaderPlayhead();
+    juce::int64 samples = 0;
+    juce::int64 samplesUntilFirstEnd = 0;
+    
+    for (int i = 0; i < handedMixes.size(); i++)
+    {
+        const MixInfo& mix = handedMixes.getReference(i);
+        
+        samples += mix.leaderEnd - position;
+        position = mix.followerEnd;
+        
+        if (i == 0)
+            samplesUntilFirstEnd = samples;
+    }
+    
+    // If the mix is ending, the final mix is due once all the others have finished
+    if (ending.load())
+        return double(samples) / SUPPORTED_SAMPLERATE;
+    
+    // If the queue is full, nothing more can be handed over until the current mix finishes
+    if (handedMixes.size() >= MIX_QUEUE_LENGTH)
+        return double(samplesUntilFirstEnd) / SUPPORTED_SAMPLERATE;
+    
+    // Otherwise, the next mix is due when the earliest point it could start comes within the decode horizon
+#ifdef SIMPLE_MIXES
+    samples += getSimpleMixStart(leadingTrack) - position;
+#else
+    samples += getEarliestMixStart(leadingTrack) - position;
+#endif
+    
+    return double(samples) / SUPPORTED_SAMPLERATE - decodeHorizon.load();
+}
+
+
+int ArtificialDJ::getEarliestMixStart(TrackInfo* track)
+{
+    // The earliest we will start a mix is four sevenths through the leading track
+    return 4 * track->getLengthSamples() / 7;
+}
+
+
+int ArtificialDJ::getSimpleMixStart(TrackInfo* track)
+{
+    // Simple mixes start two mix lengths after the first downbeat
+    return track->getSampleOfBeat(track->downbeat + 2 * MIX_SIMPLE_LENGTH_BEATS);
+}
+
+
+void ArtificialDJ::releaseFinishedAudio()
+{
+    // Once a deck has finished a mix and loaded the track after it, the audio of the track that led the mix is no longer needed
+    // (this is counted by the decks, rather than from the queue, since a mix is removed from the queue just before its deck moves on)
+    int numFinished = juce::jmin(numMixesFinished.load() - numMixesReleased, handedMixes.size());
+    
+    for (int i = 0; i < numFinished; i++)
+    {
+        dataManager->releaseAudio(leadingAudio);
+        
+        // The track that was mixed in now leads the next mix
+        leadingAudio = handedMixes.getReference(0).nextTrackAudio;
+        handedMixes.remove(0);
+        numMixesReleased += 1;
+    }
+}
+
+
+void ArtificialDJ::speculate()
+{
+    juce::Array<TrackInfo*> candidates = chooser->getCandidates(MIX_NUM_SPECULATIVE);
+    
+    // Release the audio of tracks that are no longer likely to be chosen
+    for (int i = speculativeTracks.size() - 1; i >= 0; i--)
+    {
+        if (!candidates.contains(speculativeTracks.getUnchecked(i)))
         {
-            mixQueue.remove(0);
+            dataManager->releaseAudio(speculativeAudio.getUnchecked(i));
+            speculativeTracks.remove(i);
+            speculativeAudio.remove(i);
         }
     }
+    
+    // Decode the first candidate that isn't decoded yet (only one at a time, so the DJ thread can respond quickly)
+    for (auto* candidate : candidates)
+    {
+        if (speculativeTracks.contains(candidate))
+            continue;
+        
+        PROFILE_ZONE("speculativeDecode")
+        
+        activity.store((int)DJActivity::loadingAudio);
+        juce::AudioBuffer<float>* audio = dataManager->loadAudio(candidate->getFilename());
+        activity.store((int)DJActivity::idle);
+        
+        if (audio != nullptr)
+        {
+            speculativeTracks.add(candidate);
+            speculativeAudio.add(audio);
+        }
+        
+        break;
+    }
+}
+
+
+juce::AudioBuffer<float>* ArtificialDJ::loadTrackAudio(TrackInfo* track)
+{
+    int index = speculativeTracks.indexOf(track);
+    
+    // If the track has been decoded speculatively, take that audio
+    if (index >= 0)
+    {
+        juce::AudioBuffer<float>* audio = speculativeAudio.getUnchecked(index);
+        speculativeTracks.remove(index);
+        speculativeAudio.remove(index);
+        return audio;
+    }
+    
+    return dataManager->loadAudio(track->getFilename());
 }
 
 
@@ -147,21 +417,30 @@ void ArtificialDJ::initialise()
     chooser->initialise();
     
     // Choose the first track to play
+    activity.store((int)DJActivity::choosingTrack);
     TrackInfo* firstTrack = chooser->chooseTrack();
     // This track will lead the mix, until a transition to the next track is fully completed
     leadingTrack = firstTrack;
     
     // Load the audio for the first track
+    activity.store((int)DJActivity::loadingAudio);
     juce::AudioBuffer<float>* firstTrackAudio = dataManager->loadAudio(firstTrack->getFilename());
-    // Find musical segments in the first track
-    leadingTrackSegments = segmenter.analyse(firstTrack, firstTrackAudio);
+    leadingAudio = firstTrackAudio;
+    // Fetch the musical segments in the first track, which were found during analysis
+    leadingTrackSegments = firstTrack->getSegments();
     
     // Generate the first transition (this picks the second track)
     generateMix();
+    // If there is no second track, the first transition is the final mix
+    pushFinalMix();
     
     // Tell the processors to load the track information and prepare to play
-    leader->loadFirstTrack(firstTrack, true, firstTrackAudio);
-    follower->loadFirstTrack(leadingTrack, false);
+    // The first mix is given to them directly, since only the audio thread may take mixes from the queue
+    // (they still take it from the queue once it has been performed, see getNextMix())
+    jassert(!handedMixes.isEmpty());
+    const MixInfo& firstMix = handedMixes.getReference(0);
+    leader->loadFirstTrack(firstTrack, true, firstMix, firstTrackAudio);
+    follower->loadFirstTrack(leadingTrack, false, firstMix);
     
     // Initialisation is complete
     initialised.store(true);
@@ -171,8 +450,22 @@ void ArtificialDJ::initialise()
 }
 
 
+void ArtificialDJ::generateMix()
+{
+#ifdef SIMPLE_MIXES
+    generateMixSimple();
+#else
+    generateMixComplex();
+#endif
+    
+    activity.store((int)DJActivity::idle);
+}
+
+
 void ArtificialDJ::generateMixSimple()
 {
+    PROFILE_ZONE("generateMix")
+    
     MixInfo mix;
     
     if (endingConfirm.load())
@@ -186,6 +479,7 @@ void ArtificialDJ::generateMixSimple()
     mix.leadingTrack = leadingTrack;
     
     // Choose a new track to play
+    activity.store((int)DJActivity::choosingTrack);
     TrackInfo* nextTrack = chooser->chooseTrack();
 
     // If nextTrack is null, there are no more tracks to play
@@ -202,14 +496,13 @@ void ArtificialDJ::generateMixSimple()
         mix.bpm = mix.leadingTrack->bpm;
         // Set the start and end of this final mix to the end of the leading track, so it simply plays all the way through
         mix.leaderStart = mix.leaderEnd = mix.leadingTrack->getLengthSamples();
-        // Add the final mix to the mix queue
-        mixQueue.add(mix);
+        // Hold back the final mix until the queue is empty, since it can't be withdrawn once handed to the decks
+        finalMix = mix;
         return;
     }
     
     if (ending.load())
     {
-        mixQueue.removeLast();
         ending.store(false);
         DBG("CANELLED MIX END");
     }
@@ -222,10 +515,12 @@ void ArtificialDJ::generateMixSimple()
     mix.bpm = double(mix.leadingTrack->bpm + nextTrack->bpm) / 2;
     
     // Load the audio for the next track
-    mix.nextTrackAudio = dataManager->loadAudio(nextTrack->getFilename());
+    activity.store((int)DJActivity::loadingAudio);
+    mix.nextTrackAudio = loadTrackAudio(nextTrack);
+    activity.store((int)DJActivity::planningMix);
     
     // Choose a constant mix length (see generateMixComplex() for intelligent mixing)
-    int mixLengthBeats = 16;
+    int mixLengthBeats = MIX_SIMPLE_LENGTH_BEATS;
     
     // LEADING TRACK START --------------------------------------------------------------
     
@@ -245,7 +540,7 @@ void ArtificialDJ::generateMixSimple()
     
     // FINALISE ------------------------------------------------------------------------
     
-    mixQueue.add(mix);
+    handMix(mix);
     
     leadingTrack = nextTrack;
 }
@@ -253,6 +548,8 @@ void ArtificialDJ::generateMixSimple()
 
 void ArtificialDJ::generateMixComplex()
 {
+    PROFILE_ZONE("generateMix")
+    
     MixInfo mix;
     
     if (endingConfirm.load())
@@ -266,6 +563,7 @@ void ArtificialDJ::generateMixComplex()
     mix.leadingTrack = leadingTrack;
 
     // Choose a new track to play
+    activity.store((int)DJActivity::choosingTrack);
     TrackInfo* nextTrack = chooser->chooseTrack();
 
     // If nextTrack is null, there are no more tracks to play
@@ -282,14 +580,13 @@ void ArtificialDJ::generateMixComplex()
         mix.bpm = mix.leadingTrack->bpm;
         // Set the start and end of this final mix to the end of the leading track, so it simply plays all the way through
         mix.leaderStart = mix.leaderEnd = mix.leadingTrack->getLengthSamples();
-        // Add the final mix to the mix queue
-        mixQueue.add(mix);
+        // Hold back the final mix until the queue is empty, since it can't be withdrawn once handed to the decks
+        finalMix = mix;
         return;
     }
     
     if (ending.load())
     {
-        mixQueue.removeLast();
         ending.store(false);
         DBG("CANELLED MIX END");
     }
@@ -302,15 +599,22 @@ void ArtificialDJ::generateMixComplex()
     mix.bpm = double(mix.leadingTrack->bpm + nextTrack->bpm) / 2;
 
     // Load the audio for the next track
-    mix.nextTrackAudio = dataManager->loadAudio(nextTrack->getFilename());
-    // Use segmentation analyse to classify sections within the track
-    juce::Array<int> nextTrackSegments = segmenter.analyse(nextTrack, mix.nextTrackAudio);
+    {
+        PROFILE_ZONE("decode")
+        activity.store((int)DJActivity::loadingAudio);
+        mix.nextTrackAudio = loadTrackAudio(nextTrack);
+    }
+    
+    // Fetch the sections within the track, which were found during analysis
+    juce::Array<int> nextTrackSegments = nextTrack->getSegments();
+    
+    activity.store((int)DJActivity::planningMix);
 
 
     // LEADING TRACK START --------------------------------------------------------------
 
     // The earliest we will start this mix is three fifths through the leading track
-    int mixStartMinimum = 4 * leadingTrack->getLengthSamples() / 7;
+    int mixStartMinimum = getEarliestMixStart(leadingTrack);
 
     // Find how much of the leading track remains available for this mix
     int leadingTrackAvailable = leadingTrack->getLengthSamples() - mixStartMinimum;
@@ -396,7 +700,7 @@ void ArtificialDJ::generateMixComplex()
 
     // FINALISE ------------------------------------------------------------------------
 
-    mixQueue.add(mix);
+    handMix(mix);
 
     // Store the data for the new track to be mixed in
     // This is so the information can be used to generate the next mix
@@ -11,6 +11,7 @@
 #include <JuceHeader.h>
 #include "AudioProcessor.hpp"
 #include "MixInfo.hpp"
+#include "MixHandoff.hpp"
 #include "Track.hpp"
 #include "TrackChooser.hpp"
 #include "AnalyserSegments.hpp"
@@ -18,21 +19,40 @@
 class Track;
 
 
+#define MIX_DECODE_HORIZON_S (60.0) ///< Default time before the earliest possible start of a mix at which its audio is decoded (see setDecodeHorizon())
+#define MIX_SIMPLE_LENGTH_BEATS (16) ///< Length of every mix made by generateMixSimple(), which starts two mix lengths after the leader's first downbeat
+
+// Set the following macro to generate mixes with fixed parameters (generateMixSimple()), rather than from the tracks' content
+//#define SIMPLE_MIXES
+
+
 /**
  The artificial DJ brain which makes mixing decisions.
- These decisions are made in advance and put into a queue (an array of MixInfo).
+ These decisions are made on the DJ thread, and handed to the decks through a lock-free queue (see MixHandoff).
+ The audio thread only ever takes prepared mixes - if none is ready in time, the leading track is held (see getNextMix()).
+ 
+ Each mix is prepared just in time: the DJ thread sleeps until the earliest point the next mix could start is within the
+ decode horizon, and only then chooses the next track and decodes its audio. This keeps the amount of decoded audio in
+ memory to a minimum. While there is nothing to prepare, the DJ speculatively decodes the tracks it is most likely to
+ choose next, so that the decode is usually already done when the mix is due.
  */
 class ArtificialDJ : public juce::Thread
 {
 public:
     
-    /** Constructor. */
-    ArtificialDJ(DataManager* dm);
+    /** Constructor.
+     
+     @param[in] dm Pointer to the track data manager
+     @param[in] sharedHistory If true, the tracks played are recorded in the library, so they can't be played again until
+     DataManager::clearHistory() is called (and the UI can show them). If false, this DJ keeps its own history, and
+     doesn't modify the library at all, so several DJs can mix from the same library at once (see MixServer). */
+    ArtificialDJ(DataManager* dm, bool sharedHistory = true);
     
     /** Destructor. */
     ~ArtificialDJ() { stopThread(5000); }
     
-    /** Starts the DJ thread, which makes decisions in a loop until the app exits. */
+    /** Starts the DJ thread, which makes decisions in a loop until the app exits.
+     The thread sleeps until the next mix is due, or until woken with notify() (e.g. when a skip is requested). */
     void run();
     
     /** Sets the top-level audio processor.
@@ -41,11 +61,34 @@ public:
      @param[in] processor Pointer to the top-level audio processor instance */
     void setAudioProcessor(AudioProcessor* processor) { audioProcessor = processor; }
     
-    /** Fetches the data associated with the next mix/transition.
+    /** Fetches the data associated with the next mix/transition, removing the finished one from the queue.
+     This is lock-free, so it can be called from the audio thread (both decks get the same result for the same finished mix).
+     Only the thread rendering the decks may call this (it's the queue's consumer) - the DJ thread gives the decks the first mix directly.
+     If the next mix isn't ready yet, a hold mix (ID MIX_ID_HOLD) is returned instead, which keeps the new leading track
+     playing until a prepared mix can be taken with getReadyMix().
+     
+     @param[in] current The mix that has just finished
      
      @return Struct containing all the data necessary to execute the next transition */
     MixInfo getNextMix(MixInfo current);
     
+    /** Fetches the next prepared mix without removing it from the queue, e.g. to end a hold (audio thread only).
+     
+     @param[out] mix The next prepared mix
+     
+     @return False if no mix is ready */
+    bool getReadyMix(MixInfo& mix) { return handoff.peek(mix); }
+    
+    /** Moves a prepared mix later in the leading track, if the leader has already played past its start point.
+     This is used when a mix arrives while the leader is being held, so the transition can start from where it is.
+     The mix is shifted by whole bars, and shortened if it would run past the end of the leading track.
+     
+     @param[in,out] mix Mix to adjust
+     @param[in] leaderPlayhead Current playhead position of the leading track
+     
+     @return False if there isn't enough leading track left to perform the mix */
+    static bool fitMix(MixInfo& mix, int leaderPlayhead);
+    
     /** Toggles the playback state of the DJ mix.
      
      @return False if the DJ needs to generate mixes before playback begins */
@@ -65,7 +108,7 @@ public:
     bool isMixReady(int minimumReady = 1);
     
     /** Checks whether the DJ is ready to skip to the next mix event.
-     This requires at least 2 transitions ready in the queue.
+     This only requires the current transition to be ready - if the next one isn't, the decks hold until it is.
      
      @return Result of the check */
     bool canSkip();
@@ -73,21 +116,98 @@ public:
     /** Resets the state of the DJ, ready for a new performance. */
     void reset();
     
+    /** Checks what the DJ thread is currently doing, e.g. to explain audio glitches (see AudioLoadMonitor).
+     
+     @return Current activity of the DJ thread */
+    DJActivity getActivity() { return (DJActivity)activity.load(); }
+    
+    /** Sets how far ahead of each mix its audio is decoded.
+     Larger values give the DJ thread more slack, at the cost of holding more decoded audio in memory.
+     
+     @param[in] seconds Time before the earliest possible start of a mix, at which it is prepared */
+    void setDecodeHorizon(double seconds) { decodeHorizon.store(seconds); notify(); }
+    
+    /** Fetches how far ahead of each mix its audio is decoded.
+     
+     @return Time before the earliest possible start of a mix, at which it is prepared (seconds) */
+    double getDecodeHorizon() { return decodeHorizon.load(); }
+    
+    /** Sets the seed for the DJ's random decisions (track choices and mix timings), so the same library
+     produces the same mix every time. Only call before the mix starts.
+     
+     @param[in] seed Seed for the random number engine */
+    void setSeed(unsigned int seed) { randomGenerator.setSeed(seed); }
+    
+    /** Checks whether this DJ records the tracks it plays in the library (see constructor).
+     
+     @return Result of the check */
+    bool hasSharedHistory() { return sharedHistory; }
+    
+    /** Notifies the DJ that a deck has finished a mix and loaded the track after it, so it no longer reads the audio of
+     the track that led the mix, which can therefore be released (see releaseFinishedAudio()). Audio thread only.
+     The DJ thread isn't woken, since that isn't real-time safe - the audio is released the next time it checks. */
+    void mixFinished() { numMixesFinished.fetch_add(1); }
+    
 private:
     
-    /** Removes a mix from the queue, if it is present.
-     This checks against the ID of the supplied mix.
+    /** Creates a mix that holds the next leading track, for use when the following mix isn't ready in time.
+     
+     @param[in] finished The mix that has just finished
      
-     @param[in] mix Mix information to be removed */
-    void removeMix(MixInfo mix);
+     @return Hold mix, which plays the new leading track without a transition */
+    static MixInfo makeHoldMix(const MixInfo& finished);
+    
+    /** Hands the final mix to the decks once all other prepared mixes have been taken.
+     This is held back until then, because a mix can't be withdrawn from the queue if another track is added. */
+    void pushFinalMix();
+    
+    /** Hands a prepared mix to the decks, and keeps a record of it for scheduling.
+     
+     @param[in] mix Mix to hand over */
+    void handMix(const MixInfo& mix);
+    
+    /** Estimates how long until the next mix needs to be prepared, based on the leader's position.
+     
+     @return Time until the next mix is due (seconds), which is negative if it is overdue */
+    double getSecondsUntilNextMix();
+    
+    /** Fetches the earliest point in a track at which generateMixComplex() could start a mix.
+     
+     @param[in] track Pointer to the leading track of the mix
+     
+     @return Earliest mix start, in audio samples */
+    static int getEarliestMixStart(TrackInfo* track);
+    
+    /** Fetches the point in a track at which generateMixSimple() starts a mix.
+     
+     @param[in] track Pointer to the leading track of the mix
+     
+     @return Mix start, in audio samples */
+    static int getSimpleMixStart(TrackInfo* track);
+    
+    /** Releases the audio of tracks that have finished playing, i.e. that led mixes which the decks have finished.
+     Audio is only released once the deck that played it has loaded its next track (see mixFinished()). The UI never
+     shares the decks' audio (see DeckComponent::load()), so nothing else can still be reading it. */
+    void releaseFinishedAudio();
+    
+    /** Decodes the audio of one of the tracks most likely to be chosen next, if it isn't already decoded.
+     Decodes for tracks that are no longer likely to be chosen are released. */
+    void speculate();
+    
+    /** Fetches the audio for a chosen track, using a speculative decode if there is one.
+     
+     @param[in] track Pointer to the chosen track
+     
+     @return Pointer to the track audio */
+    juce::AudioBuffer<float>* loadTrackAudio(TrackInfo* track);
     
     /** Initialises the DJ mix, choosing the first two tracks and
      the transition to be made between them.*/
     void initialise();
     
     /** Wrapper for generating a mix transition.
-     Choose either generateMixSimple() or generateMixComplex() here. */
-    void generateMix() { generateMixComplex(); }
+     This uses generateMixSimple() if SIMPLE_MIXES is set, otherwise generateMixComplex(). */
+    void generateMix();
     
     /** Generates a transition between two tracks, using simple fixed parameters. */
     void generateMixSimple();
@@ -96,27 +216,48 @@ private:
     void generateMixComplex();
     
     
-    juce::CriticalSection lock; ///< RAII lock to ensure thread-safety while acessing data within this class
+    juce::CriticalSection lock; ///< RAII lock to ensure thread-safety of the playback state (the mix queue is lock-free)
     
     std::atomic<bool> initialised; ///< Flag to indicate whether the DJ has been initialised
     
+    std::atomic<int> activity = (int)DJActivity::idle; ///< What the DJ thread is currently doing (see DJActivity)
+    
     DataManager* dataManager = nullptr; ///< Pointer to the app's track data manager
+    bool sharedHistory = true; ///< Indicates whether the tracks played are recorded in the library (see constructor)
     AudioProcessor* audioProcessor = nullptr; ///< Pointer to the top-level audio processor
     
     std::unique_ptr<TrackChooser> chooser; ///< Handles the choice of tracks to play
     
     RandomGenerator randomGenerator; ///< Generates random values to influence mixing decisions
     
-    AnalyserSegments segmenter; ///< Finds musical sections within the tracks
+    AnalyserSegments segmenter; ///< Matches mix points to the musical sections found in each track during analysis
+    
+    MixHandoff handoff; ///< Lock-free queue of mixing decisions, grouped as transitions between tracks
+    
+    MixInfo finalMix; ///< The final mix, held back until the queue is empty (see pushFinalMix())
+    
+    juce::Array<MixInfo> handedMixes; ///< Mixes handed to the decks that haven't finished yet, the first being performed (DJ thread only)
+    juce::AudioBuffer<float>* leadingAudio = nullptr; ///< Audio of the track leading the first of handedMixes
+    
+    std::atomic<int> numMixesFinished = 0; ///< Number of handed mixes which the decks have finished (see mixFinished())
+    int numMixesReleased = 0; ///< Number of finished mixes whose leading audio has been released (DJ thread only)
+    
+    juce::Array<TrackInfo*> speculativeTracks; ///< Tracks that have been decoded speculatively (see speculate())
+    juce::Array<juce::AudioBuffer<float>*> speculativeAudio; ///< Audio of the speculatively decoded tracks, in the same order
+    
+    std::atomic<double> decodeHorizon = MIX_DECODE_HORIZON_S; ///< Time before the earliest possible start of a mix at which it is prepared (seconds)
     
-    juce::Array<MixInfo> mixQueue; ///< Queue of mixing decisions, grouped as transitions between tracks
+    // Result of the last call to getNextMix(), so that both decks receive the same mix (only accessed by the consumer)
+    bool hasLastRequest = false; ///< Indicates whether lastRequestId and lastResult are valid
+    int lastRequestId = MIX_ID_NONE; ///< ID of the finished mix passed to the last call to getNextMix()
+    MixInfo lastResult; ///< Mix returned by the last call to getNextMix()
     
     TrackInfo* leadingTrack = nullptr; ///< Pointer to information of the current track being played
     juce::Array<int> leadingTrackSegments; ///< Array of boundary points between musical section detected in the leading track
     
     bool playing = false; ///< Flag to track mix playback state
-    std::atomic<bool> ending = false; ///< Indicates that the mix will end if there are no more tracks added
-    std::atomic<bool> endingConfirm = false; ///< Indicates that the mix IS ending
+    std::atomic<bool> ending = false; ///< Indicates that the mix will end if there are no more tracks added (the final mix is waiting)
+    std::atomic<bool> endingConfirm = false; ///< Indicates that the mix IS ending (the final mix has been handed to the decks)
     
     int mixIdCounter = 0; ///< Keeps track of the ID for the next mix to be generated
     
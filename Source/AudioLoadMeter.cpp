@@ -0,0 +1,74 @@
+//
+//  AudioLoadMeter.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "AudioLoadMeter.hpp"
+
+
+AudioLoadMeter::AudioLoadMeter(AudioLoadMonitor* lm) :
+    loadMonitor(lm)
+{
+    colourBackground = getLookAndFeel().findColour(juce::ResizableWindow::backgroundColourId).withBrightness(0.15f);
+    
+    startTimerHz(AUDIO_LOAD_METER_REFRESH_HZ);
+}
+
+
+void AudioLoadMeter::paint(juce::Graphics& g)
+{
+    juce::Rectangle<float> area = getLocalBounds().toFloat();
+    
+    // Draw the background
+    g.setColour(colourBackground);
+    g.fillRoundedRectangle(area, 3.f);
+    
+    // Choose a colour based on how close we are to the deadline
+    juce::Colour colour = juce::Colours::green;
+    if (peakLoad > 1.f)
+        colour = juce::Colours::red;
+    else if (peakLoad > 0.8f)
+        colour = juce::Colours::orange;
+    
+    // Draw the smoothed load as a filled bar, and the peak load as a line
+    g.setColour(colour.withAlpha(0.5f));
+    g.fillRoundedRectangle(area.withWidth(area.getWidth() * juce::jmin(load, 1.f)), 3.f);
+    
+    g.setColour(colour);
+    float peakX = area.getWidth() * juce::jmin(peakLoad, 1.f);
+    g.drawVerticalLine(juce::jmax(1, juce::roundToInt(peakX) - 1), area.getY(), area.getBottom());
+    
+    // Draw the load percentage, and the number of missed deadlines
+    juce::String text = "DSP " + juce::String(juce::roundToInt(load * 100.f)) + "%";
+    if (numLate > 0)
+        text << " (" << numLate << " late)";
+    
+    g.setColour(juce::Colours::white.withAlpha(0.8f));
+    g.setFont(11.f);
+    g.drawText(text, getLocalBounds(), juce::Justification::centred);
+}
+
+
+void AudioLoadMeter::timerCallback()
+{
+    // Read the latest block timings (this also logs any deadline misses)
+    loadMonitor->update();
+    
+    load = loadMonitor->getLoad();
+    
+    // Hold the peak, and let it fall slowly, so that short spikes are visible
+    peakLoad = juce::jmax(loadMonitor->getPeakLoad(), peakLoad * 0.95f);
+    
+    numLate = loadMonitor->getNumBlocksOver(LoadThreshold::load100);
+    
+    repaint();
+}
+
+
+void AudioLoadMeter::mouseDown(const juce::MouseEvent&)
+{
+    // Show the full report in a pop-up, without blocking the message thread (so the meter keeps updating)
+    juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::InfoIcon, "Audio Load", loadMonitor->getReport(), "OK", this);
+}
@@ -0,0 +1,57 @@
+//
+//  AudioLoadMeter.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef AudioLoadMeter_hpp
+#define AudioLoadMeter_hpp
+
+#include <JuceHeader.h>
+#include "AudioLoadMonitor.hpp"
+
+
+#define AUDIO_LOAD_METER_REFRESH_HZ (15) ///< Rate at which the meter reads the audio load monitor
+
+
+/**
+ Small meter in the tool bar, showing how much of the real-time audio processing budget is being used.
+ Also shows how many blocks have missed their deadline - clicking the meter shows a full report.
+ */
+class AudioLoadMeter : public juce::Component, public juce::Timer
+{
+public:
+    
+    /** Constructor. */
+    AudioLoadMeter(AudioLoadMonitor* loadMonitor);
+    
+    /** Destructor. */
+    ~AudioLoadMeter() {}
+    
+    /** Called by the JUCE message thread to paint this component.
+     
+     @param[in] g  JUCE graphics handler */
+    void paint(juce::Graphics& g) override;
+    
+    /** JUCE timer callback, which reads the latest measurements from the audio load monitor. */
+    void timerCallback() override;
+    
+    /** Mouse input handler, called when the mouse is pressed on this component. Shows the audio load report. */
+    void mouseDown(const juce::MouseEvent&) override;
+    
+private:
+    
+    AudioLoadMonitor* loadMonitor = nullptr; ///< Pointer to the audio load monitor
+    
+    float load = 0.f; ///< Smoothed load to display
+    float peakLoad = 0.f; ///< Peak load to display (decays slowly)
+    juce::int64 numLate = 0; ///< Number of blocks that have missed their deadline
+    
+    juce::Colour colourBackground; ///< Base colour to paint as the background
+    
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioLoadMeter) ///< JUCE macro to add a memory leak detector
+};
+
+#endif /* AudioLoadMeter_hpp */
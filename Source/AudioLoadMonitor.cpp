@@ -0,0 +1,176 @@
+//
+//  AudioLoadMonitor.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "AudioLoadMonitor.hpp"
+
+
+/** Budget proportions corresponding to each LoadThreshold. */
+static const float loadThresholds[LoadThreshold::numThresholds] = { 0.5f, 0.8f, 1.0f };
+
+
+/** Generates a text description of a DJ activity. */
+static juce::String getActivityString(DJActivity activity)
+{
+    switch (activity)
+    {
+        case DJActivity::idle:
+            return "idle";
+        case DJActivity::choosingTrack:
+            return "choosing track";
+        case DJActivity::loadingAudio:
+            return "loading audio";
+        case DJActivity::planningMix:
+            return "planning mix";
+        default:
+            jassert(false); // Unrecognised DJ activity
+            return "unknown";
+    }
+}
+
+
+juce::String AudioBlockTiming::toString() const
+{
+    return juce::Time(time).toString(false, true, true, true)
+        + " | load " + juce::String(juce::roundToInt(getLoad() * 100.f)) + "%"
+        + " | total " + juce::String(totalMs, 3) + "ms of " + juce::String(budgetMs, 3) + "ms"
+        + " | leader " + juce::String(leaderMs, 3) + "ms"
+        + " | follower " + juce::String(followerMs, 3) + "ms"
+        + " | stretch " + juce::String(stretchMs, 3) + "ms (" + StretchProfiles::getProfile(stretchQuality).name + ")"
+        + " | DJ " + getActivityString(djActivity);
+}
+
+
+void AudioLoadMonitor::pushBlock(const AudioBlockTiming& timing)
+{
+    // Update the counters here rather than in update(), so they are correct even if the FIFO overflows
+    numBlocks.fetch_add(1, std::memory_order_relaxed);
+    
+    float blockLoad = timing.getLoad();
+    
+    for (int i = 0; i < LoadThreshold::numThresholds; i++)
+    {
+        if (blockLoad > loadThresholds[i])
+            numBlocksOver[i].fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    // Queue the timing for the message thread, if there is space
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+    
+    if (size1 + size2 == 0)
+    {
+        numDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    fifoData[(size1 > 0) ? start1 : start2] = timing;
+    fifo.finishedWrite(1);
+}
+
+
+void AudioLoadMonitor::update()
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(fifo.getNumReady(), start1, size1, start2, size2);
+    
+    // The FIFO may return two regions, if the read wraps around the end of the buffer
+    for (int region = 0; region < 2; region++)
+    {
+        int start = (region == 0) ? start1 : start2;
+        int size = (region == 0) ? size1 : size2;
+        
+        for (int i = start; i < start + size; i++)
+        {
+            const AudioBlockTiming& timing = fifoData[i];
+            float blockLoad = timing.getLoad();
+            
+            // Update the meter values
+            load = AUDIO_LOAD_SMOOTHING * load + (1.f - AUDIO_LOAD_SMOOTHING) * blockLoad;
+            peakLoad = juce::jmax(peakLoad, blockLoad);
+            
+            // If the block is worse than the best of the worst, insert it in order
+            if (worstBlocks.size() < AUDIO_LOAD_NUM_WORST || blockLoad > worstBlocks.getLast().getLoad())
+            {
+                int index = 0;
+                while (index < worstBlocks.size() && worstBlocks.getReference(index).getLoad() >= blockLoad)
+                    index++;
+                
+                worstBlocks.insert(index, timing);
+                
+                if (worstBlocks.size() > AUDIO_LOAD_NUM_WORST)
+                    worstBlocks.removeLast();
+            }
+            
+            // Log deadline misses
+            if (blockLoad > loadThresholds[LoadThreshold::load100])
+                log("Deadline missed: " + timing.toString());
+        }
+    }
+    
+    fifo.finishedRead(size1 + size2);
+    
+    juce::int64 dropped = numDropped.exchange(0);
+    if (dropped > 0)
+        log(juce::String(dropped) + " block timings dropped (FIFO full)");
+}
+
+
+float AudioLoadMonitor::getPeakLoad()
+{
+    float peak = peakLoad;
+    peakLoad = 0.f;
+    return peak;
+}
+
+
+juce::String AudioLoadMonitor::getReport()
+{
+    juce::String report;
+    
+    report << "AUDIO LOAD REPORT\n";
+    report << "Blocks: " << getNumBlocks()
+           << " | >50%: " << getNumBlocksOver(LoadThreshold::load50)
+           << " | >80%: " << getNumBlocksOver(LoadThreshold::load80)
+           << " | >100%: " << getNumBlocksOver(LoadThreshold::load100)
+           << " | underruns: " << getNumUnderruns() << "\n";
+    report << "Worst blocks:\n";
+    
+    for (auto& timing : worstBlocks)
+        report << "  " << timing.toString() << "\n";
+    
+    return report;
+}
+
+
+void AudioLoadMonitor::reset()
+{
+    // Discard any queued timings
+    fifo.finishedRead(fifo.getNumReady());
+    
+    numDropped.store(0);
+    numBlocks.store(0);
+    numUnderruns.store(0);
+    
+    for (auto& count : numBlocksOver)
+        count.store(0);
+    
+    load = 0.f;
+    peakLoad = 0.f;
+    worstBlocks.clear();
+}
+
+
+void AudioLoadMonitor::log(const juce::String& message)
+{
+    DBG(message);
+    
+    // Create the log file on first use, so nothing is written unless something goes wrong
+    if (logger == nullptr)
+        logger.reset(juce::FileLogger::createDefaultAppLogger("AutoDJ", AUDIO_LOAD_LOG_FILENAME, "AutoDJ audio load log"));
+    
+    logger->logMessage(message);
+}
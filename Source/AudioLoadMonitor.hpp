@@ -0,0 +1,151 @@
+//
+//  AudioLoadMonitor.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef AudioLoadMonitor_hpp
+#define AudioLoadMonitor_hpp
+
+#include <JuceHeader.h>
+#include "CommonDefs.hpp"
+#include "StretchProfiles.hpp"
+
+
+#define AUDIO_LOAD_FIFO_SIZE (1024) ///< Number of block timings that can be queued for the message thread (~10s at 512 samples per block)
+#define AUDIO_LOAD_NUM_WORST (8) ///< Number of worst-performing blocks to keep
+#define AUDIO_LOAD_SMOOTHING (0.9f) ///< Smoothing coefficient applied to the displayed load (per block)
+#define AUDIO_LOAD_LOG_FILENAME ("AudioLoad.log") ///< Name of the log file to which deadline misses are written
+
+
+/** Thresholds of the processing budget, above which blocks are counted (see AudioLoadMonitor::getNumBlocksOver). */
+enum LoadThreshold : int
+{
+    load50,
+    load80,
+    load100,
+    numThresholds
+};
+
+
+/** Timing measurements of a single audio processing block. */
+typedef struct AudioBlockTiming
+{
+    juce::int64 time = 0; ///< Time at which the block was processed (ms since epoch)
+    int numSamples = 0; ///< Number of samples in the block
+    float budgetMs = 0.f; ///< Duration of the block's audio, i.e. the deadline for processing it
+    float totalMs = 0.f; ///< Total time taken to process the block
+    float leaderMs = 0.f; ///< Time taken by the leading TrackProcessor
+    float followerMs = 0.f; ///< Time taken by the following TrackProcessor (the decks render in parallel, so this can overlap leaderMs)
+    float stretchMs = 0.f; ///< Time taken by the time stretchers of all decks (included in leaderMs and followerMs)
+    StretchQuality stretchQuality = StretchQuality::stretchHigh; ///< Quality profile used by the time stretchers
+    DJActivity djActivity = DJActivity::idle; ///< What the DJ thread was doing at the time
+    
+    /** Calculates the proportion of the processing budget that was used.
+     
+     @return Load, where 1.0 means the deadline was just met */
+    float getLoad() const { return (budgetMs > 0.f) ? totalMs / budgetMs : 0.f; }
+    
+    /** Generates a one-line summary of the block timing, for the log.
+     
+     @return Summary text */
+    juce::String toString() const;
+} AudioBlockTiming;
+
+
+/**
+ Measures the audio callback against its real-time deadline.
+ The audio thread pushes a timing for every block through a lock-free FIFO, and updates the threshold counters.
+ The message thread periodically calls update() to drain the FIFO, which updates the meter values,
+ keeps track of the worst-performing blocks, and logs any deadline misses.
+ */
+class AudioLoadMonitor
+{
+public:
+    
+    /** Constructor. */
+    AudioLoadMonitor() {}
+    
+    /** Destructor. */
+    ~AudioLoadMonitor() {}
+    
+    /** Adds the timing of a processed block. Only call from the thread that renders the audio (the audio thread, or the
+     render thread when the mix is rendered ahead) - this is lock-free and doesn't allocate.
+     
+     @param[in] timing Measurements of the block */
+    void pushBlock(const AudioBlockTiming& timing);
+    
+    /** Reads all queued block timings and updates the statistics. Only call from the message thread. */
+    void update();
+    
+    /** Fetches the smoothed load of recent blocks.
+     
+     @return Load, as a proportion of the processing budget */
+    float getLoad() { return load; }
+    
+    /** Fetches the highest load since the last call to this function.
+     
+     @return Peak load, as a proportion of the processing budget */
+    float getPeakLoad();
+    
+    /** Fetches the total number of blocks processed.
+     
+     @return Number of blocks */
+    juce::int64 getNumBlocks() { return numBlocks.load(); }
+    
+    /** Fetches the number of blocks that used more than a given proportion of the processing budget.
+     
+     @param[in] threshold Budget threshold
+     
+     @return Number of blocks over the threshold */
+    juce::int64 getNumBlocksOver(LoadThreshold threshold) { return numBlocksOver[threshold].load(); }
+    
+    /** Counts an underrun, i.e. the audio thread ran out of rendered audio (see RenderAhead). Lock-free, so safe to call from the audio thread. */
+    void addUnderrun() { numUnderruns.fetch_add(1, std::memory_order_relaxed); }
+    
+    /** Fetches the number of underruns.
+     
+     @return Number of times the audio thread ran out of rendered audio */
+    juce::int64 getNumUnderruns() { return numUnderruns.load(); }
+    
+    /** Fetches the worst-performing blocks so far, with the highest load first.
+     
+     @return Array of block timings */
+    juce::Array<AudioBlockTiming> getWorstBlocks() { return worstBlocks; }
+    
+    /** Generates a human-readable summary of the audio load, including the worst blocks.
+     
+     @return Report text */
+    juce::String getReport();
+    
+    /** Clears all measurements. Only call from the message thread. */
+    void reset();
+    
+private:
+    
+    /** Writes a line to the audio load log file, creating it if necessary.
+     
+     @param[in] message Text to write */
+    void log(const juce::String& message);
+    
+    
+    juce::AbstractFifo fifo { AUDIO_LOAD_FIFO_SIZE }; ///< Lock-free FIFO that manages the read/write positions in fifoData
+    AudioBlockTiming fifoData[AUDIO_LOAD_FIFO_SIZE]; ///< Block timings waiting to be read by the message thread
+    std::atomic<juce::int64> numDropped {0}; ///< Number of block timings that didn't fit in the FIFO
+    
+    std::atomic<juce::int64> numBlocks {0}; ///< Total number of blocks processed
+    std::atomic<juce::int64> numBlocksOver[LoadThreshold::numThresholds] = {}; ///< Number of blocks over each budget threshold
+    std::atomic<juce::int64> numUnderruns {0}; ///< Number of times the audio thread ran out of rendered audio
+    
+    float load = 0.f; ///< Smoothed load of recent blocks
+    float peakLoad = 0.f; ///< Highest load since the last call to getPeakLoad()
+    juce::Array<AudioBlockTiming> worstBlocks; ///< Worst-performing blocks, with the highest load first
+    
+    std::unique_ptr<juce::FileLogger> logger; ///< Writes deadline misses to the log file
+    
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioLoadMonitor) ///< JUCE macro to add a memory leak detector
+};
+
+#endif /* AudioLoadMonitor_hpp */
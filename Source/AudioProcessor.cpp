@@ -8,21 +8,99 @@
 #include "AudioProcessor.hpp"
 
 #include "CommonDefs.hpp"
+#include "ArtificialDJ.hpp"
+#include "Profiler.hpp"
+#include "RealtimeSafety.hpp"
 
 
-AudioProcessor::AudioProcessor(DataManager* dataManager, ArtificialDJ* dj, int initBlockSize)
+AudioProcessor::AudioProcessor(DataManager* dataManager, ArtificialDJ* DJ, int initBlockSize, int numRenderWorkers) :
+    dj(DJ),
+    stretchQuality(StretchProfiles::getDefaultQuality())
 {
-    trackProcessors.add(new TrackProcessor(dataManager, dj));
-    trackProcessors.add(new TrackProcessor(dataManager, dj));
+    static_assert(NUM_DECKS >= NUM_MIX_DECKS, "The DJ needs at least NUM_MIX_DECKS decks");
     
+    for (int i = 0; i < NUM_DECKS; i++)
+        trackProcessors.add(new TrackProcessor(dataManager, dj));
+    
+    // The DJ mixes between the first two decks, which hand over to each other at the end of each mix
     getTrackProcessor(0)->setPartner(getTrackProcessor(1));
     getTrackProcessor(1)->setPartner(getTrackProcessor(0));
     
+    renderGroup.reset(new DeckRenderGroup(numRenderWorkers));
+    
     prepare(initBlockSize);
 }
 
 
 void AudioProcessor::getNextAudioBlock(const juce::AudioSourceChannelInfo& outputBuffer)
+{
+    // Tag this as the audio thread, so that any real-time safety violations are detected
+    RealtimeSafety::ScopedRealtimeThread realtimeThread;
+    
+    Profiler::nameCurrentThread("AudioCallback");
+    
+    RenderedBlockInfo info;
+    
+    // If the mix is being rendered ahead, just play out the rendered audio
+    if (renderingAhead.load())
+    {
+        outputBuffer.clearActiveBufferRegion();
+        
+        if (!paused.load() && renderAhead.read(outputBuffer, info) > 0)
+            setAudiblePlayheads(info);
+    }
+    else if (renderBlock(outputBuffer, info)) // Otherwise, render the audio here
+    {
+        setAudiblePlayheads(info);
+    }
+    
+    applyVolume(outputBuffer);
+}
+
+
+void AudioProcessor::startRenderAhead()
+{
+    // The decks process fixed-size blocks, whatever the audio device's block size
+    for (auto* processor : trackProcessors)
+        processor->prepare(RENDER_AHEAD_BLOCK_SIZE);
+    
+    // The device was most likely prepared before this was called, so pass on its block size now
+    renderAhead.setDeviceBlockSize(deviceBlockSize.load());
+    renderAhead.start();
+    renderingAhead.store(true);
+}
+
+
+bool AudioProcessor::renderBlock(const juce::AudioSourceChannelInfo& outputBuffer, RenderedBlockInfo& info)
+{
+    AudioBlockTiming timing;
+    juce::int64 startTicks = juce::Time::getHighResolutionTicks();
+    
+    bool rendered;
+    
+    {
+        PROFILE_ZONE("audioBlock")
+        rendered = processBlock(outputBuffer, timing, info);
+    }
+    
+    // The deadline for this block is the duration of the audio it contains
+    timing.time = juce::Time::currentTimeMillis();
+    timing.numSamples = outputBuffer.numSamples;
+    timing.budgetMs = 1000.f * float(outputBuffer.numSamples) / SUPPORTED_SAMPLERATE;
+    timing.totalMs = float(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0);
+    timing.djActivity = dj->getActivity();
+    timing.stretchQuality = stretchQuality.load();
+    
+    loadMonitor.pushBlock(timing);
+    
+    if (rendered)
+        updateStretchQuality(timing);
+    
+    return rendered;
+}
+
+
+bool AudioProcessor::processBlock(const juce::AudioSourceChannelInfo& outputBuffer, AudioBlockTiming& timing, RenderedBlockInfo& info)
 {
     TrackProcessor* leader = nullptr;
     TrackProcessor* follower = nullptr;
@@ -31,11 +109,14 @@ void AudioProcessor::getNextAudioBlock(const juce::AudioSourceChannelInfo& outpu
     
     // If a skip has been requested, skip to the next mix event
     if (skipFlag.load())
+    {
         skipToNextEvent();
+        info.invalidated = true;
+    }
     
     // If audio is paused, return
     if (paused.load())
-        return;
+        return false;
     
     // Find which is the leading track processor (i.e. the one playing the current track)
     getTrackProcessors(&leader, &follower);
@@ -43,13 +124,104 @@ void AudioProcessor::getNextAudioBlock(const juce::AudioSourceChannelInfo& outpu
     if (!leader)
         jassert(false); // No leader!
     
-    // Process audio through the leader and follower (order here doesn't matter)
-    leader->getNextAudioBlock(outputBuffer);
-    follower->getNextAudioBlock(outputBuffer);
+    // Render every deck into its own buffer, in parallel
+    renderGroup->render(trackProcessors.data(), trackProcessors.size(), outputBuffer.numSamples);
+    
+    juce::int64 stretchTicks = 0;
+    
+    for (auto* processor : trackProcessors)
+    {
+        stretchTicks += processor->getLastStretchTicks();
+        
+        // Sum the decks that are playing into the output
+        if (processor->hasOutput())
+        {
+            for (int channel = 0; channel < 2; channel++)
+                juce::FloatVectorOperations::add(outputBuffer.buffer->getWritePointer(channel, outputBuffer.startSample),
+                                                 processor->getOutput().getReadPointer(channel), outputBuffer.numSamples);
+        }
+    }
+    
+    timing.leaderMs = float(juce::Time::highResolutionTicksToSeconds(leader->getLastRenderTicks()) * 1000.0);
+    timing.followerMs = float(juce::Time::highResolutionTicksToSeconds(follower->getLastRenderTicks()) * 1000.0);
+    timing.stretchMs = float(juce::Time::highResolutionTicksToSeconds(stretchTicks) * 1000.0);
+    
+    // Now that no deck is rendering, any track changes can be made (these affect the partner deck, and the DJ)
+    for (auto* processor : trackProcessors)
+        processor->finishBlock();
+    
+    // If the leader is being held because the next mix wasn't ready in time, check whether it is now
+    // (the processors are fetched again, since the leader changes when a transition finishes)
+    getTrackProcessors(&leader, &follower);
+    if (leader->getCurrentMix().id == MIX_ID_HOLD)
+        updateHold(leader, follower);
     
     // Check whether the follower should start playing, if it isn't already
     follower->cue(leader->getPlayheadPosition());
     
+    // Publish the leader's position, so the DJ can tell when the next mix will be needed
+    leaderMixId.store(leader->getCurrentMix().id);
+    leaderPlayhead.store(leader->getPlayheadPosition());
+    
+    // Pass on the deck positions, so they can be shown when this block is heard
+    for (int i = 0; i < NUM_DECKS; i++)
+        info.playheads[i] = getTrackProcessor(i)->getPlayheadPosition();
+    
+    return true;
+}
+
+
+void AudioProcessor::updateStretchQuality(const AudioBlockTiming& timing)
+{
+    // The measurements belong to this thread, so a reset from another thread is only requested (see reset())
+    if (stretchLoadReset.exchange(false))
+    {
+        stretchLoad = 0.f;
+        stretchPressureSeconds = 0.0;
+    }
+    
+    stretchLoad = AUDIO_LOAD_SMOOTHING * stretchLoad + (1.f - AUDIO_LOAD_SMOOTHING) * timing.getLoad();
+    
+    // Short spikes (e.g. while a track loads) are ignored - the pressure must be sustained
+    if (stretchLoad > STRETCH_DOWNGRADE_LOAD)
+        stretchPressureSeconds += timing.budgetMs / 1000.0;
+    else
+        stretchPressureSeconds = 0.0;
+    
+    if (stretchPressureSeconds < STRETCH_DOWNGRADE_SECONDS || stretchQuality.load() == StretchQuality::stretchLow)
+        return;
+    
+    // Switching profile restarts the time stretchers, which would be heard mid-transition, so wait for the transition to end
+    // (the pressure is kept meanwhile, so the switch happens as soon as it does)
+    if (isTransitionInProgress())
+        return;
+    
+    // Drop to the next cheaper profile, and give it time to take effect before dropping again
+    StretchQuality quality = (StretchQuality)(stretchQuality.load() - 1);
+    stretchQuality.store(quality);
+    
+    for (auto* processor : trackProcessors)
+        processor->setStretchQuality(quality);
+    
+    stretchLoad = 0.f;
+    stretchPressureSeconds = 0.0;
+}
+
+
+bool AudioProcessor::isTransitionInProgress()
+{
+    TrackProcessor* leader = nullptr;
+    TrackProcessor* follower = nullptr;
+    
+    getTrackProcessors(&leader, &follower);
+    
+    // The follower only plays while it is being mixed in
+    return follower != nullptr && follower->isPlaying();
+}
+
+
+void AudioProcessor::applyVolume(const juce::AudioSourceChannelInfo& outputBuffer)
+{
     // If the output volume isn't at the target set in the UI, ramp to the target value over the duration of the audio buffer
     if (volume != targetVolume.load())
     {
@@ -63,10 +235,28 @@ void AudioProcessor::getNextAudioBlock(const juce::AudioSourceChannelInfo& outpu
 }
 
 
+void AudioProcessor::setAudiblePlayheads(const RenderedBlockInfo& info)
+{
+    for (int i = 0; i < NUM_DECKS; i++)
+        getTrackProcessor(i)->setAudiblePlayhead(info.playheads[i]);
+}
+
+
+void AudioProcessor::skip()
+{
+    skipFlag.store(true);
+    
+    // Wake the DJ, since the next mix may now be needed sooner
+    dj->notify();
+}
+
+
 void AudioProcessor::getTrackProcessors(TrackProcessor** leader, TrackProcessor** follower)
 {
-    for (auto* processor : trackProcessors)
+    for (int i = 0; i < NUM_MIX_DECKS; i++)
     {
+        TrackProcessor* processor = getTrackProcessor(i);
+        
         if (processor->isLeader())
             *leader = processor;
         else
@@ -77,6 +267,17 @@ void AudioProcessor::getTrackProcessors(TrackProcessor** leader, TrackProcessor*
 
 void AudioProcessor::prepare(int blockSize)
 {
+    // Remember the device's block size, in case rendering ahead is started later (see startRenderAhead())
+    deviceBlockSize.store(blockSize);
+    
+    // When rendering ahead, the decks' block size doesn't depend on the audio device,
+    // but the device's block size sets how much audio must be rendered before playback starts
+    if (renderingAhead.load())
+    {
+        renderAhead.setDeviceBlockSize(blockSize);
+        return;
+    }
+    
     for (auto* processor : trackProcessors)
     {
         processor->prepare(blockSize);
@@ -85,6 +286,17 @@ void AudioProcessor::prepare(int blockSize)
 
 
 bool AudioProcessor::mixEnded()
+{
+    // When rendering ahead, the mix hasn't ended until all of the rendered audio has been played out
+    // (the decks belong to the render thread, so it reports when they have ended)
+    if (renderingAhead.load())
+        return renderAhead.hasEnded() && renderAhead.getNumBlocksReady() == 0;
+    
+    return decksEnded();
+}
+
+
+bool AudioProcessor::decksEnded()
 {
     TrackProcessor* leader = nullptr;
     TrackProcessor* follower = nullptr;
@@ -106,8 +318,26 @@ void AudioProcessor::reset()
     paused.store(true);
     skipFlag.store(false);
     
+    // Stop rendering while the decks are reset (the audio callback stops reading once paused)
+    if (renderingAhead.load())
+        renderAhead.stopThread(RENDER_AHEAD_STOP_TIMEOUT_MS);
+    
+    leaderMixId.store(MIX_ID_NONE);
+    leaderPlayhead.store(0);
+    
+    // Return to the deployment's quality, in case the last performance had to drop it
+    stretchQuality.store(StretchProfiles::getDefaultQuality());
+    stretchLoadReset.store(true);
+    
     for (auto* processor : trackProcessors)
+    {
         processor->reset();
+        processor->setStretchQuality(stretchQuality.load());
+    }
+    
+    // Restart rendering, ready for the next performance (the audio callback drops whatever is left in the ring)
+    if (renderingAhead.load())
+        renderAhead.restart();
 }
 
 
@@ -120,7 +350,27 @@ void AudioProcessor::skipToNextEvent()
     
     if (leader)
     {
-        leader->skipToNextEvent();
+        // There is no event to skip to while the leader is being held
+        if (leader->getCurrentMix().id != MIX_ID_HOLD)
+            leader->skipToNextEvent();
+        
         skipFlag.store(false);
     }
 }
+
+
+void AudioProcessor::updateHold(TrackProcessor* leader, TrackProcessor* follower)
+{
+    MixInfo mix;
+    
+    // If the next mix is ready and there's enough of the leading track left to perform it, start it
+    if (dj->getReadyMix(mix) && ArtificialDJ::fitMix(mix, leader->getPlayheadPosition()))
+    {
+        leader->updateMix(mix);
+        follower->loadMix(mix);
+    }
+    else // Otherwise, keep holding
+    {
+        leader->holdLoop();
+    }
+}
@@ -10,30 +10,56 @@
 
 #include <JuceHeader.h>
 #include "TrackProcessor.hpp"
+#include "AudioLoadMonitor.hpp"
+#include "RenderAhead.hpp"
+#include "DeckRenderGroup.hpp"
+
+
+#define STRETCH_DOWNGRADE_LOAD (0.8f) ///< Smoothed audio load above which the time stretchers drop to a cheaper quality profile
+#define STRETCH_DOWNGRADE_SECONDS (2.0) ///< Length of time the load must stay above STRETCH_DOWNGRADE_LOAD before dropping quality
 
 
 /**
  Top-level audio processor, which handles playback control and master DSP.
- Track-specific DSP is delegated to the TrackProcessor children.
- This class receives the audio output buffer from MainComponent.
+ Track-specific DSP is delegated to the TrackProcessor children (the decks), which are rendered in parallel by a DeckRenderGroup
+ and then summed into the output. This class receives the audio output buffer from MainComponent.
+ 
+ There are NUM_DECKS decks. The DJ mixes between the first NUM_MIX_DECKS of them (the leader and follower);
+ any further decks are rendered and summed alongside them, e.g. for drops and effects.
+ 
+ Once startRenderAhead() has been called, the TrackProcessors are run on a background thread, ahead of the audio
+ callback (see RenderAhead), and the callback just plays out the rendered audio. Otherwise, they are run in the callback.
+ 
+ If the processing load stays high, the time stretching quality is dropped one profile at a time (see updateStretchQuality()).
+ Each performance starts at the quality chosen for the deployment (see StretchProfiles::setDefaultQuality()).
  */
 class AudioProcessor
 {
 public:
     
-    /** Constructor. */
-    AudioProcessor(DataManager* dataManager, ArtificialDJ* dj, int initBlockSize);
+    /** Constructor.
+     
+     @param[in] dataManager Pointer to the app's track data manager
+     @param[in] dj Pointer to the artificial DJ brain
+     @param[in] initBlockSize Number of audio samples to expect in each processing block
+     @param[in] numRenderWorkers Number of threads to help render the decks (see DeckRenderGroup), or -1 to choose automatically */
+    AudioProcessor(DataManager* dataManager, ArtificialDJ* dj, int initBlockSize, int numRenderWorkers = -1);
     
     /** Destructor. */
     ~AudioProcessor() {}
     
-    /** Audio processing loop - applies master DSP and delegates track-specific DSP to TrackProcessor children.
+    /** Audio processing loop - applies master DSP and delegates track-specific DSP to TrackProcessor children,
+     or plays out the audio they have already rendered, if rendering ahead.
     
      @param[out] outputBuffer Buffer to fill with desired audio output samples
     
-     @see TrackProcessor::getNextAudioBlock */
+     @see TrackProcessor::renderBlock */
     void getNextAudioBlock(const juce::AudioSourceChannelInfo& outputBuffer);
     
+    /** Starts rendering the mix ahead of the audio callback, on a background thread (see RenderAhead).
+     From then on, the TrackProcessors always process blocks of RENDER_AHEAD_BLOCK_SIZE samples, whatever the audio device's block size. */
+    void startRenderAhead();
+    
     /** Resumes audio playback. */
     void play() { paused.store(false); }
     
@@ -47,7 +73,7 @@ public:
      @return Pointer to the specified TrackProcessor */
     TrackProcessor* getTrackProcessor(int index) { return trackProcessors.getUnchecked(index); }
     
-    /** Fetches both TrackProcessor children, determining which is currently leading the mix.
+    /** Fetches the two TrackProcessor children that the DJ mixes between, determining which is currently leading the mix.
      The double pointers allow the calling function to receive TrackProcessor pointers into its local scope.
      
      @param[out] leader Double pointer to the leading TrackProcessor
@@ -60,6 +86,7 @@ public:
     TrackProcessor** getTrackProcessors() { return trackProcessors.data(); }
     
     /** Prepares the processing pipeline for a given audio buffer size.
+     When rendering ahead, the decks keep their block size, and this sets how much audio must be rendered before playback starts.
      
      @param[in] blockSize Number of audio samples to expect in each processing block */
     void prepare(int blockSize);
@@ -72,9 +99,26 @@ public:
     
     /** Requests a skip to the next mix event.
      A flag is set here, which will trigger the skip during the next audio processing loop. */
-    void skip() { skipFlag.store(true); }
+    void skip();
+    
+    /** Checks whether a skip has been requested, but not yet performed.
+     
+     @return Result of the check */
+    bool isSkipPending() { return skipFlag.load(); }
     
-    /** Checks whether the DJ performance has finished.
+    /** Fetches the ID of the mix being performed by the leading TrackProcessor, as of the last audio block.
+     
+     @return Mix ID (MIX_ID_HOLD if the leader is being held, MIX_ID_NONE before playback starts) */
+    int getLeaderMixId() { return leaderMixId.load(); }
+    
+    /** Fetches the playhead position of the leading TrackProcessor, as of the last audio block.
+     When rendering ahead, this is the position that has been rendered up to, rather than the audible position.
+     This is safe to call from any thread, e.g. so the DJ can schedule its work.
+     
+     @return Playhead position, in audio samples */
+    int getLeaderPlayhead() { return leaderPlayhead.load(); }
+    
+    /** Checks whether the DJ performance has finished (including playing out any audio rendered ahead).
      
      @return Result of check */
     bool mixEnded();
@@ -82,13 +126,79 @@ public:
     /** Resets the audio processing pipeline, ready to start a new performance. */
     void reset();
     
+    /** Fetches the monitor that measures audio processing load against the real-time deadline.
+     
+     @return Pointer to the audio load monitor */
+    AudioLoadMonitor* getLoadMonitor() { return &loadMonitor; }
+    
+    /** Fetches the time stretching quality profile currently requested for the TrackProcessors.
+     
+     @return Quality tier */
+    StretchQuality getStretchQuality() { return stretchQuality.load(); }
+    
 private:
     
+    friend class RenderAhead;
+    
+    /** Runs the TrackProcessors for a block of audio, and pushes the block's timing to the load monitor.
+     Called by the audio callback, or by the render thread when rendering ahead.
+     
+     @param[out] outputBuffer Buffer to fill with the mixed audio (before the master volume is applied)
+     @param[out] info Deck positions at the end of the block, and whether a skip was performed (which makes earlier blocks stale)
+     
+     @return False if playback is paused, in which case no audio was rendered */
+    bool renderBlock(const juce::AudioSourceChannelInfo& outputBuffer, RenderedBlockInfo& info);
+    
+    /** Processes a block of audio, rendering the TrackProcessors in parallel and summing them into the output.
+     
+     @param[out] outputBuffer Buffer to fill with desired audio output samples
+     @param[out] timing Timing measurements for the block
+     @param[out] info Deck positions at the end of the block, and whether a skip was performed
+     
+     @return False if playback is paused, in which case no audio was processed */
+    bool processBlock(const juce::AudioSourceChannelInfo& outputBuffer, AudioBlockTiming& timing, RenderedBlockInfo& info);
+    
+    /** Tracks the load of each rendered block, and drops the time stretching quality by one profile
+     once the smoothed load has stayed above STRETCH_DOWNGRADE_LOAD for STRETCH_DOWNGRADE_SECONDS.
+     The drop is deferred until no transition is in progress, since it restarts the time stretchers.
+     Only called on the rendering thread, which owns the load measurements.
+     
+     @param[in] timing Timing measurements of the block */
+    void updateStretchQuality(const AudioBlockTiming& timing);
+    
+    /** Checks whether a transition is in progress, i.e. the following TrackProcessor is being mixed in.
+     
+     @return Result of the check */
+    bool isTransitionInProgress();
+    
+    /** Applies the master volume to the output, ramping to the target volume if it has changed.
+     This is applied as the audio is played out, so volume changes aren't delayed by rendering ahead.
+     
+     @param[out] outputBuffer Buffer of audio output samples */
+    void applyVolume(const juce::AudioSourceChannelInfo& outputBuffer);
+    
+    /** Passes the playhead positions of the audio being played out to the TrackProcessors, e.g. for the waveform displays.
+     
+     @param[in] info Deck positions at the end of the block being played */
+    void setAudiblePlayheads(const RenderedBlockInfo& info);
+    
+    /** Checks whether the leading TrackProcessor has finished the last track, regardless of any audio rendered ahead.
+     
+     @return Result of check */
+    bool decksEnded();
+    
     /** Skips to the next event in the mix.
      If there is a transition in progress, the net even is the end of the transition.
      Otherwise, it is the start of the next transition. */
     void skipToNextEvent();
     
+    /** Checks whether the next mix has become ready while the leader is being held, and if so, starts it.
+     Otherwise, the leader is looped to extend its track until the mix is ready (see TrackProcessor::holdLoop()).
+     
+     @param[in] leader Pointer to the leading TrackProcessor
+     @param[in] follower Pointer to the following TrackProcessor */
+    void updateHold(TrackProcessor* leader, TrackProcessor* follower);
+    
     float volume = 0.5f; ///< Current volume gain applied at the output
     std::atomic<float> targetVolume = 0.5f; ///< Target volume gain to ramp towards during the next audio processing loop
     
@@ -96,7 +206,27 @@ private:
     
     std::atomic<bool> paused = true; ///< Flag to track the audio playback state
     
-    juce::OwnedArray<TrackProcessor> trackProcessors; ///< Array of child TrackProcessors
+    std::atomic<int> leaderMixId = MIX_ID_NONE; ///< ID of the leader's mix as of the last audio block (see getLeaderMixId())
+    std::atomic<int> leaderPlayhead = 0; ///< Leader playhead position as of the last audio block (see getLeaderPlayhead())
+    
+    juce::OwnedArray<TrackProcessor> trackProcessors; ///< Array of child TrackProcessors (the decks)
+    
+    // This is declared after trackProcessors, so it is destroyed (and its threads stopped) before them
+    std::unique_ptr<DeckRenderGroup> renderGroup; ///< Renders the decks in parallel
+    
+    // This is declared after trackProcessors, so it is destroyed (and its thread stopped) before them
+    RenderAhead renderAhead {this}; ///< Renders the mix ahead of the audio callback
+    std::atomic<bool> renderingAhead = false; ///< Indicates whether the mix is being rendered ahead (see startRenderAhead())
+    std::atomic<int> deviceBlockSize = 0; ///< Block size the audio device was last prepared with (see prepare())
+    
+    ArtificialDJ* dj = nullptr; ///< Pointer to artificial DJ brain
+    
+    AudioLoadMonitor loadMonitor; ///< Measures the audio processing load, for the UI meter and log
+    
+    std::atomic<StretchQuality> stretchQuality; ///< Time stretching quality profile requested for the TrackProcessors
+    float stretchLoad = 0.f; ///< Smoothed load of recent blocks, measured on the rendering thread (see updateStretchQuality())
+    double stretchPressureSeconds = 0.0; ///< Length of time stretchLoad has been above STRETCH_DOWNGRADE_LOAD (rendering thread only)
+    std::atomic<bool> stretchLoadReset = false; ///< Flag for the rendering thread to clear the load measurements, e.g. for a new performance
     
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioProcessor) ///< JUCE macro to add a memory leak detector
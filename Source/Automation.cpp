@@ -0,0 +1,58 @@
+//
+//  Automation.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "Automation.hpp"
+
+namespace Automation {
+
+
+/** Equal-power curve (square root), sampled at AUTOMATION_CURVE_SIZE + 1 evenly spaced crossfade positions.
+ It is built when the program starts, so it is never built on the audio thread. */
+static const std::vector<float> equalPowerCurve = []() {
+    std::vector<float> curve(AUTOMATION_CURVE_SIZE + 1);
+    
+    for (int i = 0; i <= AUTOMATION_CURVE_SIZE; i++)
+        curve[i] = float(std::sqrt(double(i) / AUTOMATION_CURVE_SIZE));
+    
+    return curve;
+}();
+
+
+void renderLinear(float* output, int numSamples, float start, float end)
+{
+    // A constant is simply filled
+    if (start == end)
+    {
+        juce::FloatVectorOperations::fill(output, start, numSamples);
+        return;
+    }
+    
+    float step = (end - start) / numSamples;
+    
+    // Each sample is calculated from its index, rather than accumulated, so the loop has no dependencies and is vectorised
+    for (int i = 0; i < numSamples; i++)
+        output[i] = start + step * i;
+}
+
+
+float getEqualPowerGain(float position)
+{
+    float index = juce::jlimit(0.f, 1.f, position) * AUTOMATION_CURVE_SIZE;
+    int lower = juce::jmin(int(index), AUTOMATION_CURVE_SIZE - 1);
+    float fraction = index - lower;
+    
+    return equalPowerCurve[lower] + fraction * (equalPowerCurve[lower + 1] - equalPowerCurve[lower]);
+}
+
+
+void renderEqualPower(float* output, int numSamples, float startPosition, float endPosition)
+{
+    renderLinear(output, numSamples, getEqualPowerGain(startPosition), getEqualPowerGain(endPosition));
+}
+
+
+}
@@ -0,0 +1,54 @@
+//
+//  Automation.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef Automation_hpp
+#define Automation_hpp
+
+#include <JuceHeader.h>
+
+
+#define AUTOMATION_CURVE_SIZE (1024) ///< Number of segments in the precomputed equal-power curve
+
+
+/**
+ Renders the per-sample ramps which automate the playback DSP (e.g. the crossfade gain and filter cut-off in TrackProcessor).
+ 
+ Parameters such as those in InterpolatedParameter are updated once per block, so each block is given a ramp from the value
+ before the update to the value after it. This removes the zipper noise of holding a value for the whole block,
+ which becomes audible at larger buffer sizes.
+ */
+namespace Automation {
+
+/** Renders a linear ramp.
+ 
+ @param[out] output Output location for the ramp
+ @param[in] numSamples Length of the ramp, in samples
+ @param[in] start Value at the start of the ramp
+ @param[in] end Value the ramp reaches at the end of the block (i.e. the first sample of the next block) */
+void renderLinear(float* output, int numSamples, float start, float end);
+
+/** Looks up the equal-power gain for a crossfade position, i.e. the square root of the position,
+ which keeps the total power constant while one track fades out and another fades in.
+ 
+ @param[in] position Crossfade position (0.0 to 1.0)
+ 
+ @return Gain to apply to the audio */
+float getEqualPowerGain(float position);
+
+/** Renders a ramp of equal-power gain for a crossfade position moving linearly across the block.
+ The gain at each end of the block is looked up from a precomputed curve, and the block itself is a linear ramp between them,
+ which is indistinguishable from the curve since a crossfade lasts thousands of blocks.
+ 
+ @param[out] output Output location for the ramp
+ @param[in] numSamples Length of the ramp, in samples
+ @param[in] startPosition Crossfade position at the start of the block (0.0 to 1.0)
+ @param[in] endPosition Crossfade position at the end of the block (0.0 to 1.0) */
+void renderEqualPower(float* output, int numSamples, float startPosition, float endPosition);
+
+}
+
+#endif /* Automation_hpp */
@@ -0,0 +1,179 @@
+//
+//  BiquadBank.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "BiquadBank.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define BIQUAD_BANK_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+ #include <arm_neon.h>
+ #define BIQUAD_BANK_NEON
+#endif
+
+
+namespace {
+
+// Thin wrappers around the SIMD instructions used, so that the filter code is the same on every platform
+#if defined(BIQUAD_BANK_SSE)
+
+typedef __m128 Lanes;
+
+inline Lanes load(const float* x) { return _mm_load_ps(x); }
+inline void store(float* x, Lanes v) { _mm_store_ps(x, v); }
+inline Lanes broadcast(float x) { return _mm_set1_ps(x); }
+inline Lanes gather(const float* const* x, int index) { return _mm_set_ps(x[3][index], x[2][index], x[1][index], x[0][index]); }
+inline Lanes add(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+inline Lanes sub(Lanes a, Lanes b) { return _mm_sub_ps(a, b); }
+inline Lanes mul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+
+#elif defined(BIQUAD_BANK_NEON)
+
+typedef float32x4_t Lanes;
+
+inline Lanes load(const float* x) { return vld1q_f32(x); }
+inline void store(float* x, Lanes v) { vst1q_f32(x, v); }
+inline Lanes broadcast(float x) { return vdupq_n_f32(x); }
+inline Lanes gather(const float* const* x, int index) { float lanes[4] = { x[0][index], x[1][index], x[2][index], x[3][index] }; return vld1q_f32(lanes); }
+inline Lanes add(Lanes a, Lanes b) { return vaddq_f32(a, b); }
+inline Lanes sub(Lanes a, Lanes b) { return vsubq_f32(a, b); }
+inline Lanes mul(Lanes a, Lanes b) { return vmulq_f32(a, b); }
+
+#else
+
+// Scalar fallback, which the compiler may still vectorise
+typedef struct Lanes { float x[BIQUAD_BANK_LANES]; } Lanes;
+
+inline Lanes load(const float* x) { Lanes v; for (int i = 0; i < BIQUAD_BANK_LANES; i++) v.x[i] = x[i]; return v; }
+inline void store(float* x, Lanes v) { for (int i = 0; i < BIQUAD_BANK_LANES; i++) x[i] = v.x[i]; }
+inline Lanes broadcast(float x) { Lanes v; for (int i = 0; i < BIQUAD_BANK_LANES; i++) v.x[i] = x; return v; }
+inline Lanes gather(const float* const* x, int index) { Lanes v; for (int i = 0; i < BIQUAD_BANK_LANES; i++) v.x[i] = x[i][index]; return v; }
+inline Lanes add(Lanes a, Lanes b) { for (int i = 0; i < BIQUAD_BANK_LANES; i++) a.x[i] += b.x[i]; return a; }
+inline Lanes sub(Lanes a, Lanes b) { for (int i = 0; i < BIQUAD_BANK_LANES; i++) a.x[i] -= b.x[i]; return a; }
+inline Lanes mul(Lanes a, Lanes b) { for (int i = 0; i < BIQUAD_BANK_LANES; i++) a.x[i] *= b.x[i]; return a; }
+
+#endif
+
+}
+
+
+BiquadBank::BiquadBank()
+{
+    for (int lane = 0; lane < BIQUAD_BANK_LANES; lane++)
+    {
+        b0[lane] = 1.f;
+        b1[lane] = b2[lane] = a1[lane] = a2[lane] = 0.f;
+    }
+    
+    reset();
+}
+
+
+void BiquadBank::setCoefficients(int lane, const juce::IIRCoefficients& coefficients)
+{
+    jassert(lane >= 0 && lane < BIQUAD_BANK_LANES);
+    
+    // JUCE normalises the coefficients, and stores them in the order b0, b1, b2, a1, a2
+    b0[lane] = coefficients.coefficients[0];
+    b1[lane] = coefficients.coefficients[1];
+    b2[lane] = coefficients.coefficients[2];
+    a1[lane] = coefficients.coefficients[3];
+    a2[lane] = coefficients.coefficients[4];
+}
+
+
+void BiquadBank::setCoefficients(const juce::IIRCoefficients& coefficients)
+{
+    for (int lane = 0; lane < BIQUAD_BANK_LANES; lane++)
+        setCoefficients(lane, coefficients);
+}
+
+
+void BiquadBank::reset()
+{
+    for (int lane = 0; lane < BIQUAD_BANK_LANES; lane++)
+        v1[lane] = v2[lane] = 0.f;
+}
+
+
+void BiquadBank::processChannels(float* const* channels, int numChannels, int numSamples)
+{
+    jassert(numChannels > 0 && numChannels <= BIQUAD_BANK_LANES);
+    
+    // Unused lanes also read the first channel, so every lane can be processed unconditionally (their output is discarded)
+    const float* lanes[BIQUAD_BANK_LANES];
+    
+    for (int lane = 0; lane < BIQUAD_BANK_LANES; lane++)
+        lanes[lane] = channels[(lane < numChannels) ? lane : 0];
+    
+    Lanes c0 = load(b0), c1 = load(b1), c2 = load(b2), c3 = load(a1), c4 = load(a2);
+    Lanes s1 = load(v1), s2 = load(v2);
+    
+    alignas(16) float out[BIQUAD_BANK_LANES];
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        Lanes in = gather(lanes, i);
+        
+        // Transposed direct form II, as in juce::IIRFilter
+        Lanes y = add(mul(c0, in), s1);
+        s1 = add(sub(mul(c1, in), mul(c3, y)), s2);
+        s2 = sub(mul(c2, in), mul(c4, y));
+        
+        store(out, y);
+        
+        for (int lane = 0; lane < numChannels; lane++)
+            channels[lane][i] = out[lane];
+    }
+    
+    store(v1, s1);
+    store(v2, s2);
+    
+    snapToZero();
+}
+
+
+void BiquadBank::processSplit(const float* input, float* const* outputs, int numOutputs, int numSamples)
+{
+    jassert(numOutputs > 0 && numOutputs <= BIQUAD_BANK_LANES);
+    
+    Lanes c0 = load(b0), c1 = load(b1), c2 = load(b2), c3 = load(a1), c4 = load(a2);
+    Lanes s1 = load(v1), s2 = load(v2);
+    
+    alignas(16) float out[BIQUAD_BANK_LANES];
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        // Every lane filters the same input sample
+        Lanes in = broadcast(input[i]);
+        
+        // Transposed direct form II, as in juce::IIRFilter
+        Lanes y = add(mul(c0, in), s1);
+        s1 = add(sub(mul(c1, in), mul(c3, y)), s2);
+        s2 = sub(mul(c2, in), mul(c4, y));
+        
+        store(out, y);
+        
+        for (int lane = 0; lane < numOutputs; lane++)
+            outputs[lane][i] = out[lane];
+    }
+    
+    store(v1, s1);
+    store(v2, s2);
+    
+    snapToZero();
+}
+
+
+void BiquadBank::snapToZero()
+{
+    for (int lane = 0; lane < BIQUAD_BANK_LANES; lane++)
+    {
+        JUCE_SNAP_TO_ZERO(v1[lane]);
+        JUCE_SNAP_TO_ZERO(v2[lane]);
+    }
+}
@@ -0,0 +1,91 @@
+//
+//  BiquadBank.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef BiquadBank_hpp
+#define BiquadBank_hpp
+
+#include <JuceHeader.h>
+
+
+#define BIQUAD_BANK_LANES (4) ///< Number of filters processed in parallel, which is the width of an SSE/NEON register of floats
+
+
+/**
+ A bank of up to BIQUAD_BANK_LANES biquad (IIR) filters, which are processed together using SIMD instructions (SSE on x86, NEON on ARM).
+ 
+ Each filter occupies a lane, with its own coefficients and state. The lanes can either filter separate channels
+ (e.g. the left and right channels of a track), or the same input (e.g. the low-, band- and high-pass filters of a waveform),
+ for roughly the cost of a single scalar filter.
+ 
+ The filters use the same coefficients and transposed direct form II structure as juce::IIRFilter,
+ so they produce the same output (see DspBenchmarks for a comparison).
+ */
+class BiquadBank
+{
+public:
+    
+    /** Constructor. Every lane starts as a pass-through filter. */
+    BiquadBank();
+    
+    /** Destructor. */
+    ~BiquadBank() {}
+    
+    /** Sets the coefficients of one filter in the bank. This doesn't reset its state.
+     
+     @param[in] lane Index of the filter (0 to BIQUAD_BANK_LANES-1)
+     @param[in] coefficients Filter coefficients, e.g. from juce::IIRCoefficients::makeLowPass() */
+    void setCoefficients(int lane, const juce::IIRCoefficients& coefficients);
+    
+    /** Sets the coefficients of every filter in the bank. This doesn't reset their state.
+     
+     @param[in] coefficients Filter coefficients, e.g. from juce::IIRCoefficients::makeLowPass() */
+    void setCoefficients(const juce::IIRCoefficients& coefficients);
+    
+    /** Resets the state of every filter, ready for new audio. */
+    void reset();
+    
+    /** Filters several channels in place, each with its own filter (channel n uses lane n).
+     
+     @param[in,out] channels Pointers to the audio of each channel
+     @param[in] numChannels Number of channels (up to BIQUAD_BANK_LANES)
+     @param[in] numSamples Number of samples to process in each channel */
+    void processChannels(float* const* channels, int numChannels, int numSamples);
+    
+    /** Filters a single channel in place, using the first filter in the bank.
+     
+     @param[in,out] samples Pointer to the audio
+     @param[in] numSamples Number of samples to process */
+    void process(float* samples, int numSamples) { processChannels(&samples, 1, numSamples); }
+    
+    /** Filters one input through several filters, e.g. to split it into frequency bands (output n uses lane n).
+     
+     @param[in] input Pointer to the input audio
+     @param[out] outputs Pointers to the output location of each filter
+     @param[in] numOutputs Number of outputs (up to BIQUAD_BANK_LANES)
+     @param[in] numSamples Number of samples to process */
+    void processSplit(const float* input, float* const* outputs, int numOutputs, int numSamples);
+    
+private:
+    
+    /** Sets the state of any filter that has decayed to a denormal value to zero, as juce::IIRFilter does,
+     since processing denormals is very slow. */
+    void snapToZero();
+    
+    alignas(16) float b0[BIQUAD_BANK_LANES]; ///< Feed-forward coefficient of the current sample, for each lane
+    alignas(16) float b1[BIQUAD_BANK_LANES]; ///< Feed-forward coefficient of the previous sample, for each lane
+    alignas(16) float b2[BIQUAD_BANK_LANES]; ///< Feed-forward coefficient of the sample before that, for each lane
+    alignas(16) float a1[BIQUAD_BANK_LANES]; ///< Feedback coefficient of the previous output, for each lane
+    alignas(16) float a2[BIQUAD_BANK_LANES]; ///< Feedback coefficient of the output before that, for each lane
+    
+    alignas(16) float v1[BIQUAD_BANK_LANES]; ///< First state variable of each lane
+    alignas(16) float v2[BIQUAD_BANK_LANES]; ///< Second state variable of each lane
+    
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BiquadBank) ///< JUCE macro to add a memory leak detector
+};
+
+#endif /* BiquadBank_hpp */
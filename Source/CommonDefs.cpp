@@ -46,4 +46,28 @@ int getBeatPeriod(int bpm)
 }
 
 
+juce::String getOptionValue(const juce::ArgumentList& args, juce::StringRef option)
+{
+    int index = args.indexOfOption(option);
+    
+    if (index < 0)
+        return {};
+    
+    juce::String value = args[index].getLongOptionValue();
+    
+    // Otherwise, the value is the next argument, as long as it isn't another option
+    if (value.isEmpty() && index + 1 < args.size() && !args[index + 1].isOption())
+        value = args[index + 1].text;
+    
+    return value;
+}
+
+
+bool checkTest(bool passed, const juce::String& description)
+{
+    std::cout << (passed ? "PASS: " : "FAIL: ") << description << std::endl;
+    return passed;
+}
+
+
 } /* namespace AutoDJ */
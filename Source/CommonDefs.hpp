@@ -17,6 +17,8 @@
 #define TRACK_LENGTH_SECS_MAX (600) ///< 10 minutes maximum length
 #define BEATS_PER_BAR (4) ///< Number of beats per bar (4/4 time assumed)
 #define NUM_TRACKS_MIN (6) ///< Minimum track required to launch mix
+#define NUM_DECKS (2) ///< Number of decks (TrackProcessors) used to perform the mix
+#define NUM_MIX_DECKS (2) ///< Number of decks the DJ mixes between (the first NUM_MIX_DECKS decks), as leader and follower
 
 
 /** Enum to define a unique ID for each control (buttons & sliders). */
@@ -43,6 +45,16 @@ enum ViewID : int
 };
 
 
+/** Enum to define what the DJ thread is currently doing (see ArtificialDJ::getActivity). */
+enum class DJActivity : int
+{
+    idle,
+    choosingTrack,
+    loadingAudio,
+    planningMix
+};
+
+
 // Restrict the following functions to the AutoDJ:: namespace
 namespace AutoDJ {
 
@@ -68,6 +80,24 @@ juce::String getGrooveString(float groove);
  @return Number of samples per beat */
 int getBeatPeriod(int bpm);
 
+/** Reads the value of a command-line option given as either "--option value" or "--option=value"
+ (juce::ArgumentList::getValueForOption() only reads the second form of a long option).
+ 
+ @param[in] args Command-line arguments, which should be built from the separate parameters rather than a joined command line,
+ so that a value containing spaces is a single, unquoted argument
+ @param[in] option Long option to find, e.g. "--library"
+ 
+ @return Value of the option, or an empty string if the option or its value is missing */
+juce::String getOptionValue(const juce::ArgumentList& args, juce::StringRef option);
+
+/** Prints the outcome of a single check made by a command-line test (e.g. ExtraDeckTest), as "PASS: ..." or "FAIL: ...".
+ 
+ @param[in] passed Whether the check passed
+ @param[in] description What was checked
+ 
+ @return Whether the check passed */
+bool checkTest(bool passed, const juce::String& description);
+
 // ============== Code taken from: https://www.geeksforgeeks.org/frequent-element-array/ ==============
 /** Finds the most common value in an array of any data type.
  
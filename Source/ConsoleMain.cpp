@@ -0,0 +1,203 @@
+/*
+  ==============================================================================
+
+    This file contains the startup code for the AutoDJ console tool
+    (AutoDJ-Console.jucer), which analyses a music library without any UI:
+
+      AutoDJ-Console --analyse /path/to/music [--threads 4] [--workers] [--shared-analysis [store.db]] [--json results.json]
+
+    It uses the same DataManager, AnalysisManager and SqlDatabase as the app, so
+    the results are stored in the library's database, ready for the app to use.
+    With --workers, each track is analysed in a separate process (see AnalysisWorkerPool),
+    and --threads sets the number of worker processes. Any number of consoles can share a library.
+    With --shared-analysis, analysis is also reused from (and added to) a store shared by every
+    music folder, so copies of a track in other folders aren't analysed again.
+    With --benchmark-dsp, it instead runs the DSP microbenchmarks (see DspBenchmarks) and exits.
+    With --test-worker, it instead runs one worker job from start to finish (see AnalysisWorkerTest) and exits.
+    Exit codes: 0 success, 1 bad arguments, 2 library couldn't be analysed, 3 JSON couldn't be written, 4 test failed.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "DataManager.hpp"
+#include "AnalysisWorkerPool.hpp"
+#include "DspBenchmarks.hpp"
+#include "AnalysisWorkerTest.hpp"
+#include "CommonDefs.hpp"
+
+#define CONSOLE_POLL_INTERVAL_MS (100) ///< Interval at which the library's progress is checked
+#define CONSOLE_PROGRESS_INTERVAL_MS (5000) ///< Interval at which analysis progress is printed
+
+//==============================================================================
+static void printUsage()
+{
+    std::cout << "Usage: AutoDJ-Console --analyse <music folder> [--threads <number>] [--workers] [--shared-analysis [<store file>]] [--json <output file>]" << std::endl;
+    std::cout << "       AutoDJ-Console --benchmark-dsp" << std::endl;
+    std::cout << "       AutoDJ-Console --test-worker" << std::endl;
+}
+
+//==============================================================================
+/** Writes the analysis of every valid track in the library to a JSON file, along with the run's statistics. */
+static bool writeResults (DataManager& dataManager, const juce::File& jsonFile, juce::DynamicObject::Ptr stats)
+{
+    juce::Array<juce::var> tracks;
+    
+    for (int i = 0; i < dataManager.getNumTracks(); i++)
+    {
+        TrackInfo& track = dataManager.getTracks()[i];
+        
+        juce::DynamicObject::Ptr result = new juce::DynamicObject();
+        result->setProperty ("filename", track.getFilename());
+        result->setProperty ("artist", track.getArtist());
+        result->setProperty ("title", track.getTitle());
+        result->setProperty ("hash", track.hash);
+        result->setProperty ("lengthSec", track.length);
+        result->setProperty ("analysed", track.analysed);
+        result->setProperty ("bpm", track.bpm);
+        result->setProperty ("beatPhase", track.beatPhase);
+        result->setProperty ("downbeat", track.downbeat);
+        result->setProperty ("key", track.key);
+        result->setProperty ("groove", track.groove);
+        tracks.add (result.get());
+    }
+    
+    juce::DynamicObject::Ptr output = new juce::DynamicObject();
+    output->setProperty ("date", juce::Time::getCurrentTime().toISO8601 (true));
+    output->setProperty ("library", dataManager.getDirectory().getFullPathName());
+    output->setProperty ("stats", stats.get());
+    output->setProperty ("tracks", tracks);
+    
+    return jsonFile.replaceWithText (juce::JSON::toString (juce::var (output.get())));
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args (argc, argv);
+    
+    // When launched by an AnalysisWorkerPool, analyse one file and exit
+    if (args.containsOption (ANALYSIS_WORKER_OPTION))
+    {
+        int features = args.containsOption (ANALYSIS_WORKER_FEATURES_OPTION) ? args.getValueForOption (ANALYSIS_WORKER_FEATURES_OPTION).getIntValue() : ANALYSIS_FEATURES_REQUIRED;
+        return AnalysisWorkerPool::runWorker (juce::File (args.getValueForOption (ANALYSIS_WORKER_OPTION)), features);
+    }
+    
+    if (args.containsOption ("--benchmark-dsp"))
+    {
+        std::cout << DspBenchmarks::toString (DspBenchmarks::run());
+        return 0;
+    }
+    
+    if (args.containsOption ("--test-worker"))
+        return AnalysisWorkerTest::run() ? 0 : 4;
+    
+    // The folder is required, since an empty path would resolve to the working directory
+    if (AutoDJ::getOptionValue (args, "--analyse").isEmpty())
+    {
+        printUsage();
+        return 1;
+    }
+    
+    juce::File workingDirectory = juce::File::getCurrentWorkingDirectory();
+    juce::File musicFolder = workingDirectory.getChildFile (AutoDJ::getOptionValue (args, "--analyse"));
+    
+    if (!musicFolder.isDirectory())
+    {
+        std::cout << "Music folder not found: " << musicFolder.getFullPathName() << std::endl;
+        printUsage();
+        return 1;
+    }
+    
+    if (args.containsOption ("--workers"))
+        AnalysisWorkerPool::setEnabled (true);
+    
+    if (args.containsOption ("--shared-analysis"))
+    {
+        juce::String path = AutoDJ::getOptionValue (args, "--shared-analysis");
+        DataManager::setSharedStore (path.isEmpty() ? DataManager::getDefaultSharedStore() : workingDirectory.getChildFile (path));
+    }
+    
+    DataManager dataManager;
+    
+    if (args.containsOption ("--threads"))
+        dataManager.getAnalysisManager()->setNumThreads (juce::jmax (1, AutoDJ::getOptionValue (args, "--threads").getIntValue()));
+    
+    juce::uint32 startMs = juce::Time::getMillisecondCounter();
+    
+    // There's no UI, so there's no Direction view to update
+    if (!dataManager.initialise (musicFolder, nullptr))
+    {
+        std::cout << "Failed to initialise the database in " << musicFolder.getFullPathName() << std::endl;
+        return 2;
+    }
+    
+    double progress = 0.0;
+    
+    // Wait for the files in the library to be parsed (analysis starts automatically once they are)
+    while (dataManager.isLoading (progress))
+        juce::Thread::sleep (CONSOLE_POLL_INTERVAL_MS);
+    
+    if (!dataManager.isDirectoryValid())
+    {
+        std::cout << "The music folder needs at least " << NUM_TRACKS_MIN << " valid tracks" << std::endl;
+        return 2;
+    }
+    
+    juce::uint32 analysisStartMs = juce::Time::getMillisecondCounter();
+    juce::uint32 lastPrintMs = analysisStartMs;
+    
+    while (!dataManager.isAnalysisFinished (progress))
+    {
+        juce::Thread::sleep (CONSOLE_POLL_INTERVAL_MS);
+        
+        if (juce::Time::getMillisecondCounter() - lastPrintMs >= CONSOLE_PROGRESS_INTERVAL_MS)
+        {
+            lastPrintMs = juce::Time::getMillisecondCounter();
+            std::cout << "Analysing: " << juce::roundToInt (progress * 100.0) << "%" << std::endl;
+        }
+    }
+    
+    juce::uint32 endMs = juce::Time::getMillisecondCounter();
+    
+    AnalysisManager* analysisManager = dataManager.getAnalysisManager();
+    
+    int numAnalysed = analysisManager->getNumJobs();
+    double analysisSec = double (endMs - analysisStartMs) / 1000.0;
+    double audioSec = double (analysisManager->getNumSamplesAnalysed()) / SUPPORTED_SAMPLERATE;
+    double tracksPerSec = (analysisSec > 0.0) ? numAnalysed / analysisSec : 0.0;
+    double realtimeFactor = (analysisSec > 0.0) ? audioSec / analysisSec : 0.0;
+    
+    juce::DynamicObject::Ptr stats = new juce::DynamicObject();
+    stats->setProperty ("threads", analysisManager->getNumThreads());
+    stats->setProperty ("tracks", dataManager.getNumTracks());
+    stats->setProperty ("tracksAnalysed", numAnalysed);
+    stats->setProperty ("tracksFailed", analysisManager->getNumFailedJobs());
+    stats->setProperty ("tracksAlreadyAnalysed", dataManager.getNumTracks() - numAnalysed);
+    stats->setProperty ("totalTimeSec", double (endMs - startMs) / 1000.0);
+    stats->setProperty ("analysisTimeSec", analysisSec);
+    stats->setProperty ("audioTimeSec", audioSec);
+    stats->setProperty ("tracksPerSec", tracksPerSec);
+    stats->setProperty ("realtimeFactor", realtimeFactor);
+    
+    std::cout << "Analysed " << numAnalysed << " of " << dataManager.getNumTracks() << " tracks"
+              << " (" << (dataManager.getNumTracks() - numAnalysed) << " already in the database)"
+              << " (" << analysisManager->getNumFailedJobs() << " failed)"
+              << " using " << analysisManager->getNumThreads() << (AnalysisWorkerPool::isEnabled() ? " worker processes" : " threads") << " in " << juce::String (analysisSec, 1) << "s: "
+              << juce::String (tracksPerSec, 2) << " tracks/s, " << juce::String (realtimeFactor, 1) << "x real time" << std::endl;
+    
+    if (args.containsOption ("--json"))
+    {
+        juce::File jsonFile = workingDirectory.getChildFile (AutoDJ::getOptionValue (args, "--json"));
+        
+        if (!writeResults (dataManager, jsonFile, stats))
+        {
+            std::cout << "Failed to write " << jsonFile.getFullPathName() << std::endl;
+            return 3;
+        }
+        
+        std::cout << "Results written to " << jsonFile.getFullPathName() << std::endl;
+    }
+    
+    return 0;
+}
@@ -8,6 +8,9 @@
 #include "DataManager.hpp"
 
 #include "CommonDefs.hpp"
+#include "Profiler.hpp"
+#include "RealtimeSafety.hpp"
+#include "AnalysisWorkerPool.hpp"
 
 #include "ThirdParty/xxhash32.h"
 
@@ -16,16 +19,19 @@ extern "C" {
 }
 
 
-DataManager::DataManager() :
-    fileFilter(juce::WildcardFileFilter("*.wav,*.mp3", "*", "AudioFormats"))
+static juce::File sharedStoreFile; ///< User-level analysis store for new DataManagers to use, if set (see DataManager::setSharedStore())
+
+
+DataManager::DataManager()
 {
     formatManager.registerFormat(new juce::WavAudioFormat(), false);
     formatManager.registerFormat(new juce::MP3AudioFormat(), false);
     
-    thread.startThread(3);
-    dirContents.reset(new juce::DirectoryContentsList(&fileFilter, thread));
-    
-    analysisManager.reset(new AnalysisManager());
+    // Replace with AnalysisTest to evaluate analysis accuracy against the database, or AnalysisTest(true) to benchmark it
+    if (AnalysisWorkerPool::isEnabled())
+        analysisManager.reset(new AnalysisWorkerPool());
+    else
+        analysisManager.reset(new AnalysisManager());
     
     parser.reset(new FileParserThread(this));
     
@@ -37,28 +43,46 @@ DataManager::~DataManager()
 {
     // Delete file parser first, because it might try to access analysisManager before it dies
     parser.reset();
-    // Then delete analysisManager, because it might try to access dirContents before it dies
+    // Then delete analysisManager, because its threads might try to access this class before they die
     analysisManager.reset();
-    dirContents.reset();
 }
 
 
-bool DataManager::initialise(juce::File directory, DirectionView* direction)
+void DataManager::setSharedStore(juce::File file)
 {
-    directionView = direction;
-    
-    dirContents->setDirectory(directory, true, true);
+    sharedStoreFile = file;
+}
+
+
+juce::File DataManager::getDefaultSharedStore()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory).getChildFile("AutoDJ").getChildFile(SHARED_DATABASE_FILENAME);
+}
+
+
+bool DataManager::initialise(juce::File folder, TrackDataListener* trackDataListener)
+{
+    listener = trackDataListener;
     
-    dirContents->refresh();
+    directory = folder;
     
+    // The caller reports the failure, since there may not be a UI to show it in
     if (!database.initialise(directory))
     {
-        // Show an error window
-        juce::AlertWindow::showMessageBox(juce::AlertWindow::WarningIcon, "Error", "Failed to initialise database.", "OK");
         jassert(false); // Database failed to initialise
         return false;
     }
     
+    // The shared store is optional, so carry on without it if it can't be opened
+    if (sharedStoreFile != juce::File())
+    {
+        sharedDatabase.reset(new SqlDatabase());
+        sharedStoreFile.getParentDirectory().createDirectory();
+        
+        if (!sharedDatabase->initialise(sharedStoreFile.getParentDirectory(), sharedStoreFile.getFileName()))
+            sharedDatabase.reset();
+    }
+    
     parser->startThread();
     
     initialised.store(true);
@@ -67,18 +91,25 @@ bool DataManager::initialise(juce::File directory, DirectionView* direction)
 }
 
 
-void DataManager::storeAnalysis(TrackInfo* track)
+void DataManager::storeAnalysis(TrackInfo* track, bool addToLibrary)
 {
     const juce::ScopedLock sl(lock);
     
     // Update the database with the new track info (this replaces the existing track record if present)
     database.store(*track);
+    
+    if (sharedDatabase != nullptr)
+        sharedDatabase->store(*track);
+    
+    if (!addToLibrary)
+        return;
 
     // Pass the track to the sorter
     sorter.addTrack(track);
     
-    // Pass the track to the direction view
-    directionView->addAnalysed(track);
+    // Pass the track to the listener (e.g. the Direction view), if there is one
+    if (listener != nullptr)
+        listener->addAnalysed(track);
     
     // Increment the counters
     numTracksAnalysed += 1;
@@ -119,29 +150,105 @@ bool DataManager::canStartPlaying()
 
 juce::AudioBuffer<float>* DataManager::loadAudio(juce::String filename, bool mono)
 {
-    juce::AudioBuffer<float>* buffer;
-    juce::AudioFormatReader* reader = nullptr;
-    juce::String filePath;
+    REALTIME_UNSAFE(fileIO, "DataManager::loadAudio")
     
+    // If the stereo audio is already loaded, share it
+    if (!mono)
     {
         const juce::ScopedLock sl(lock);
-        juce::String filePath = dirContents->getDirectory().getFullPathName() + "/" + filename;
-        reader = formatManager.createReaderFor(filePath);
         
-        if (reader)
+        if (SharedAudio* shared = findSharedAudio(filename))
         {
-            audioBuffers.add(new juce::AudioBuffer<float>());
-            buffer = audioBuffers.getLast();
+            shared->numUsers += 1;
+            return shared->buffer.get();
         }
-        else
+    }
+    
+    // Decode outside the lock, so other threads aren't held up
+    std::unique_ptr<juce::AudioBuffer<float>> buffer(decodeAudio(filename, mono));
+    
+    if (buffer == nullptr)
+        return nullptr;
+    
+    const juce::ScopedLock sl(lock);
+    
+    if (mono)
+        return audioBuffers.add(buffer.release());
+    
+    // If another thread has loaded the same file in the meantime, share its copy instead
+    if (SharedAudio* shared = findSharedAudio(filename))
+    {
+        shared->numUsers += 1;
+        return shared->buffer.get();
+    }
+    
+    SharedAudio* shared = sharedAudio.add(new SharedAudio());
+    shared->filename = filename;
+    shared->buffer = std::move(buffer);
+    shared->numUsers = 1;
+    
+    return shared->buffer.get();
+}
+
+
+void DataManager::releaseAudio(juce::AudioBuffer<float>* buffer)
+{
+    const juce::ScopedLock sl(lock);
+    
+    for (int i = 0; i < sharedAudio.size(); i++)
+    {
+        SharedAudio* shared = sharedAudio.getUnchecked(i);
+        
+        if (shared->buffer.get() == buffer)
         {
-            jassert(false); // Failed to load track audio
-            return nullptr;
-            // TODO: handle the case where an audio file has been deleted when this request arrives
+            // Only unload shared audio once its last user has released it
+            shared->numUsers -= 1;
+            
+            if (shared->numUsers <= 0)
+                sharedAudio.remove(i);
+            
+            return;
         }
     }
-        
-    buffer->clear();
+    
+    audioBuffers.removeObject(buffer);
+}
+
+
+size_t DataManager::getSharedAudioBytes(int& numBuffers)
+{
+    const juce::ScopedLock sl(lock);
+    
+    size_t bytes = 0;
+    
+    for (auto* shared : sharedAudio)
+        bytes += sizeof(float) * shared->buffer->getNumChannels() * shared->buffer->getNumSamples();
+    
+    numBuffers = sharedAudio.size();
+    
+    return bytes;
+}
+
+
+juce::AudioBuffer<float>* DataManager::decodeAudio(juce::String filename, bool mono)
+{
+    juce::AudioFormatReader* reader = nullptr;
+    
+    {
+        const juce::ScopedLock sl(lock);
+        juce::String filePath = directory.getFullPathName() + "/" + filename;
+        reader = formatManager.createReaderFor(filePath);
+    }
+    
+    if (!reader)
+    {
+        jassert(false); // Failed to load track audio
+        return nullptr;
+        // TODO: handle the case where an audio file has been deleted when this request arrives
+    }
+    
+    juce::AudioBuffer<float>* buffer = new juce::AudioBuffer<float>();
+    
     buffer->setSize(reader->numChannels, (int)reader->lengthInSamples);
     
     reader->read(buffer->getArrayOfWritePointers(), reader->numChannels, 0, (int)reader->lengthInSamples);
@@ -154,6 +261,61 @@ juce::AudioBuffer<float>* DataManager::loadAudio(juce::String filename, bool mon
 }
 
 
+SharedAudio* DataManager::findSharedAudio(const juce::String& filename)
+{
+    for (auto* shared : sharedAudio)
+    {
+        if (shared->filename == filename)
+            return shared;
+    }
+    
+    return nullptr;
+}
+
+
+bool DataManager::readStoredAnalysis(TrackInfo* track)
+{
+    TrackInfo stored;
+    
+    {
+        const juce::ScopedLock sl(lock);
+        stored = database.read(track->getFilename());
+    }
+    
+    // Ignore analysis of a different version of the file
+    if (stored.hash != track->hash)
+        return false;
+    
+    // Take any outdated features that have since been recomputed
+    AnalysisFeatures::copyFeatures(*track, stored, AnalysisFeatures::getOutdatedFeatures(*track) & AnalysisFeatures::getCurrentFeatures(stored));
+    track->analysed = (AnalysisFeatures::getStaleFeatures(*track) == 0);
+    
+    return AnalysisFeatures::getOutdatedFeatures(*track) == 0;
+}
+
+
+void DataManager::storeWaveform(int hash, const juce::MemoryBlock& waveform)
+{
+    const juce::ScopedLock sl(lock);
+    
+    database.storeWaveform(hash, waveform);
+    
+    if (sharedDatabase != nullptr)
+        sharedDatabase->storeWaveform(hash, waveform);
+}
+
+
+bool DataManager::readWaveform(int hash, juce::MemoryBlock& waveform)
+{
+    const juce::ScopedLock sl(lock);
+    
+    if (database.readWaveform(hash, waveform))
+        return true;
+    
+    return (sharedDatabase != nullptr && sharedDatabase->readWaveform(hash, waveform));
+}
+
+
 void DataManager::adjustChannels(juce::AudioBuffer<float>* buffer, bool mono)
 {
     if (mono && buffer->getNumChannels() >= 2)
@@ -196,6 +358,8 @@ void DataManager::printTrackInfo(TrackInfo info)
 
 void DataManager::parseFile(juce::File file)
 {
+    PROFILE_ZONE("parseFile")
+    
     TrackInfo trackInfo, existingInfo;
     
     trackInfo.hash = getHash(file);
@@ -209,11 +373,30 @@ void DataManager::parseFile(juce::File file)
         // (If the existing hash is zero, the track hasn't been found in the database)
         if (trackInfo.hash != existingInfo.hash)
         {
+            // Reuse the analysis if the same audio has been analysed under another name, or in another music folder
+            findExistingAnalysis(trackInfo);
             database.store(trackInfo);
         }
         else
         {
             trackInfo = existingInfo;
+            
+            // The track may have been analysed in another music folder since it was added to this one
+            if (AnalysisFeatures::getStaleFeatures(trackInfo) != 0 && findExistingAnalysis(trackInfo))
+                database.store(trackInfo);
+        }
+        
+        // If an analyser has changed since the track was analysed, it is queued again, but only its stale features are recomputed
+        trackInfo.analysed = (AnalysisFeatures::getStaleFeatures(trackInfo) == 0);
+        
+        // Add analysis from this folder to the shared store, so other folders with the same track can use it
+        if (trackInfo.analysed && sharedDatabase != nullptr && AnalysisFeatures::getStaleFeatures(sharedDatabase->readByHash(trackInfo.hash)) != 0)
+        {
+            sharedDatabase->store(trackInfo);
+            
+            juce::MemoryBlock waveform;
+            if (database.readWaveform(trackInfo.hash, waveform))
+                sharedDatabase->storeWaveform(trackInfo.hash, waveform);
         }
         
         tracks[numTracks] = trackInfo;
@@ -224,12 +407,17 @@ void DataManager::parseFile(juce::File file)
         {
             analysisManager->processResult(trackPtr);
             sorter.addTrack(trackPtr);
-            directionView->addAnalysed(trackPtr);
+            if (listener != nullptr)
+                listener->addAnalysed(trackPtr);
             
             trackDataUpdate.store(true);
             
             numTracksAnalysed += 1;
             numTracksAnalysedUnqueued += 1;
+            
+            // The track can be mixed already, but its optional features (e.g. the waveform overview) are still computed
+            if (AnalysisFeatures::getOutdatedFeatures(trackInfo) != 0)
+                analysisManager->addOptionalJob(trackPtr);
         }
         else
         {
@@ -259,6 +447,40 @@ bool DataManager::getTrackInfo(juce::File file, TrackInfo& trackInfo)
 }
 
 
+bool DataManager::findExistingAnalysis(TrackInfo& track)
+{
+    PROFILE_ZONE("findExistingAnalysis")
+    
+    bool found = false;
+    
+    // Check this folder first (renamed or moved files), then the shared store (other folders)
+    for (SqlDatabase* store : { &database, sharedDatabase.get() })
+    {
+        int stale = AnalysisFeatures::getStaleFeatures(track);
+        
+        if (store == nullptr || stale == 0)
+            continue;
+        
+        TrackInfo existing = store->readByHash(track.hash);
+        
+        // Only take the features that are current in the existing analysis
+        int features = stale & AnalysisFeatures::getCurrentFeatures(existing);
+        
+        if (existing.hash == 0 || features == 0)
+            continue;
+        
+        DBG("Reusing analysis of " << existing.getFilename() << " for " << track.getFilename() << " (features 0x" << juce::String::toHexString(features) << ")");
+        
+        AnalysisFeatures::copyFeatures(track, existing, features);
+        found = true;
+    }
+    
+    track.analysed = (AnalysisFeatures::getStaleFeatures(track) == 0);
+    
+    return found;
+}
+
+
 int DataManager::getHash(juce::File file)
 {
     juce::MemoryBlock rawFile;
@@ -272,6 +494,22 @@ int DataManager::getHash(juce::File file)
 }
 
 
+juce::Array<TrackInfo*> DataManager::getAnalysedTracks()
+{
+    const juce::ScopedLock sl(lock);
+    
+    juce::Array<TrackInfo*> analysed;
+    
+    for (int i = 0; i < numTracks; i++)
+    {
+        if (tracks[i].analysed)
+            analysed.add(&tracks[i]);
+    }
+    
+    return analysed;
+}
+
+
 void DataManager::clearHistory()
 {
     const juce::ScopedLock sl(lock);
@@ -279,7 +517,8 @@ void DataManager::clearHistory()
     TrackInfo* track;
     
     sorter.reset();
-    directionView->reset();
+    if (listener != nullptr)
+        listener->reset();
     
     numTracksAnalysed = 0;
     numTracksAnalysedUnqueued = 0;
@@ -300,8 +539,9 @@ void DataManager::clearHistory()
             
             sorter.addTrack(track);
             
-            // Pass the track to the direction view
-            directionView->addAnalysed(track);
+            // Pass the track to the listener (e.g. the Direction view), if there is one
+            if (listener != nullptr)
+                listener->addAnalysed(track);
         }
     }
     
@@ -322,14 +562,19 @@ void DataManager::reset()
 
 void FileParserThread::run()
 {
-    int numFiles;
+    // Find the audio files at the top level of the music folder, in alphabetical order
+    // (wildcards are case-sensitive on Linux, so the extensions are checked separately, ignoring case)
+    juce::Array<juce::File> files = dataManager->directory.findChildFiles(juce::File::findFiles, false);
     
-    while (dataManager->dirContents->isStillLoading())
+    for (int i = files.size() - 1; i >= 0; i--)
     {
-        _mm_pause();
+        if (!files.getReference(i).hasFileExtension(AUDIO_FILE_EXTENSIONS))
+            files.remove(i);
     }
     
-    numFiles = dataManager->dirContents->getNumFiles();
+    files.sort();
+    
+    int numFiles = files.size();
     DBG("Num files in directory: " << numFiles);
     
     dataManager->tracks = (TrackInfo*)malloc(sizeof(TrackInfo) * numFiles);
@@ -338,7 +583,7 @@ void FileParserThread::run()
     {
         if (threadShouldExit()) return;
         progress.store(double(i) / numFiles);
-        dataManager->parseFile(dataManager->dirContents->getFile(i));
+        dataManager->parseFile(files.getReference(i));
     }
     
     // Now that we know how many valid tracks there are,
@@ -12,11 +12,23 @@
 #include "SqlDatabase.hpp"
 #include "TrackSorter.hpp"
 #include "AnalysisTest.hpp"
-#include "DirectionView.hpp"
+#include "TrackDataListener.hpp"
 
 class FileParserThread;
 
 
+#define AUDIO_FILE_EXTENSIONS (".wav;.mp3") ///< Extensions of the audio files that can be used (matched regardless of case, e.g. .MP3)
+
+
+/** Decoded stereo audio for a track, which is shared between everyone playing it (see DataManager::loadAudio()). */
+typedef struct SharedAudio
+{
+    juce::String filename; ///< Name of the audio file
+    std::unique_ptr<juce::AudioBuffer<float>> buffer; ///< Decoded audio
+    int numUsers = 0; ///< Number of loadAudio() calls not yet matched by releaseAudio()
+} SharedAudio;
+
+
 /**
  Controls the flow of track data throughout the application.
  Uses an SQL database for persistent storage of track data
@@ -36,16 +48,34 @@ public:
      whether the provided directory contains enough valid music files.
      
      @param[in] directory Chosen music folder
-     @param[in] directionView Pointer to direction view
+     @param[in] listener Object to notify when track data changes, e.g. the Direction view (nullptr if there is no UI)
      
      @return False if database initialisation fails */
-    bool initialise(juce::File directory, DirectionView* directionView);
+    bool initialise(juce::File directory, TrackDataListener* listener);
+    
+    /** Sets the user-level analysis store, which is shared by every music folder (and every process),
+     so that tracks analysed in one folder aren't analysed again in another. Applies to DataManagers initialised afterwards.
+     Tracks are found in the store by the hash of their audio, but stored by filename, so a different file with the
+     same name replaces an older entry (which only means that entry can't be reused).
+     
+     @param[in] file Database file to use, or an empty File to disable the shared store (the default) */
+    static void setSharedStore(juce::File file);
+    
+    /** Fetches the default location of the shared analysis store, in the user's application data folder.
+     
+     @return Default database file */
+    static juce::File getDefaultSharedStore();
     
     /** Fetches the track info array.
      
      @return Pointer array of track data */
     TrackInfo* getTracks() { return tracks; }
     
+    /** Fetches the chosen music folder.
+     
+     @return Music folder, which also holds the track database */
+    juce::File getDirectory() { return directory; }
+    
     /** Fetches the number of tracks in the library.
      
      @return Number of tracks in the track data array */
@@ -58,8 +88,9 @@ public:
     
     /** Stores updated track information in the database
      
-     @param[in] track Pointer to newly analysed track */
-    void storeAnalysis(TrackInfo* track);
+     @param[in] track Pointer to newly analysed track
+     @param[in] addToLibrary Whether to add the track to the sorter and listener (false if it's already there, see AnalysisManager::addOptionalJob()) */
+    void storeAnalysis(TrackInfo* track, bool addToLibrary = true);
     
     /** Notifies that a track has been queued, so the number of tracks ready to play can be decremented. */
     void trackQueued() { numTracksAnalysedUnqueued -= 1; }
@@ -94,17 +125,70 @@ public:
     bool canStartPlaying();
     
     /** Loads the audio data for a given file, optionally converting stereo to mono.
+     Stereo audio is shared: if the file is already loaded, the same buffer is returned, so it must only be read.
+     Mono audio is always loaded into a new buffer, since the analysers process it in place.
      
      @param[in] filename Name of the audio file to load
      @param[in] mono Indicates desired channel configuration
      
-     @return Pointer to the buffer of loaded audio (which will be owned by DataManager during its whole lifetime) */
+     @return Pointer to the buffer of loaded audio (owned by DataManager, until every user has called releaseAudio()) */
     juce::AudioBuffer<float>* loadAudio(juce::String filename, bool mono = false);
     
-    /** Unloads audio data from memory.
+    /** Unloads audio data from memory, once every user of a shared buffer has released it.
      
      @param[in] buffer Pointer to the audio buffer to release */
-    void releaseAudio(juce::AudioBuffer<float>* buffer) { const juce::ScopedLock sl(lock); audioBuffers.removeObject(buffer); }
+    void releaseAudio(juce::AudioBuffer<float>* buffer);
+    
+    /** Fetches the amount of memory used by shared (stereo) audio.
+     
+     @param[out] numBuffers Number of shared buffers currently loaded
+     
+     @return Size of the shared buffers, in bytes */
+    size_t getSharedAudioBytes(int& numBuffers);
+    
+    /** Copies a track's analysis from the database, if it has been stored there since the library was loaded
+     (e.g. by another process analysing the same library).
+     
+     Only the features which are outdated in the track are copied, and only if they are current in the database.
+     
+     @param[in,out] track Pointer to the track, which receives the stored analysis
+     
+     @return True if the track no longer has any outdated features, required or optional */
+    bool readStoredAnalysis(TrackInfo* track);
+    
+    /** Stores the waveform overview of a track (see AnalyserWaveform), in this folder's database and the shared analysis store.
+     
+     @param[in] hash Hash of the track's audio file
+     @param[in] waveform Waveform data to store */
+    void storeWaveform(int hash, const juce::MemoryBlock& waveform);
+    
+    /** Reads the stored waveform overview of a track, from this folder's database or the shared analysis store.
+     
+     @param[in] hash Hash of the track's audio file
+     @param[out] waveform Output location for the waveform data
+     
+     @return True if the waveform was found */
+    bool readWaveform(int hash, juce::MemoryBlock& waveform);
+    
+    /** Generates the hash for a given audio file, using the xxHash32 algorithm.
+     This hash can be used to uniquely identify the file.
+     (xxHash32 doesn't guarantee unique hash for EVERY possible file, but highly unlikely to run into problems here)
+     
+     @param[in] file Audio file to hash
+     
+     @return Hash of file*/
+    static int getHash(juce::File file);
+    
+    /** Adjusts the channels of the provided audio buffer to meet to given specification.
+     
+     @param[in,out] buffer Pointer to audio buffer
+     @param[in] mono Determines whether the buffer should be changed to stereo or mono */
+    static void adjustChannels(juce::AudioBuffer<float>* buffer, bool mono);
+    
+    /** Fetches all of the analysed tracks, e.g. to fill a private TrackSorter.
+     
+     @return Array of pointers to analysed track information */
+    juce::Array<TrackInfo*> getAnalysedTracks();
     
     /** Fetches the track sorter (quadtree).
      
@@ -128,11 +212,20 @@ public:
       
 private:
     
-    /** Adjusts the channels of the provided audio buffer to meet to given specification.
+    /** Decodes the audio data for a given file into a new buffer.
      
-     @param[in,out] buffer Pointer to audio buffer
-     @param[in] mono Determines whether the buffer should be changed to stereo or mono */
-    void adjustChannels(juce::AudioBuffer<float>* buffer, bool mono);
+     @param[in] filename Name of the audio file to load
+     @param[in] mono Indicates desired channel configuration
+     
+     @return New buffer, or nullptr if the file couldn't be read */
+    juce::AudioBuffer<float>* decodeAudio(juce::String filename, bool mono);
+    
+    /** Finds the shared audio buffer for a given file, if it is loaded. The lock must be held when calling this.
+     
+     @param[in] filename Name of the audio file
+     
+     @return Pointer to the shared audio, or nullptr if not loaded */
+    SharedAudio* findSharedAudio(const juce::String& filename);
     
     /** Prints the information for a given track to the debug console.
      
@@ -156,26 +249,28 @@ private:
      @return True if the audio file is valid */
     bool getTrackInfo(juce::File file, TrackInfo& trackInfo);
     
-    /** Generates the hash for a given audio file, using the xxHash32 algorithm.
-     This hash can be used to uniquely identify the file.
-     (xxHash32 doesn't guarantee unique hash for EVERY possible file, but highly unlikely to run into problems here)
+    /** Finds existing analysis of the given track's audio content, stored under a different filename
+     (i.e. the file has been renamed or moved), or in the shared analysis store.
      
-     @param[in] file Audio file to hash
+     Only features which are stale in the track, but current in the existing analysis, are copied.
      
-     @return Hash of file*/
-    int getHash(juce::File file);
+     @param[in,out] track Track to search for, which receives the existing analysis if found
+     
+     @return True if any features were copied */
+    bool findExistingAnalysis(TrackInfo& track);
     
     /** Resets the data manager ready to open a new music directory. */
     void reset();
     
-    juce::OwnedArray<juce::AudioBuffer<float>> audioBuffers; ///< Array of audio buffer loaded by loadAudio()
+    juce::OwnedArray<juce::AudioBuffer<float>> audioBuffers; ///< Array of mono audio buffers loaded by loadAudio()
+    juce::OwnedArray<SharedAudio> sharedAudio; ///< Array of stereo audio buffers loaded by loadAudio(), shared between their users
     
     std::unique_ptr<AnalysisManager> analysisManager; ///< Analysis manager
     
     juce::AudioFormatManager formatManager; ///< Audio file format handler
-    juce::WildcardFileFilter fileFilter; ///< File filter, used for finding releveant files in the chosen directory
     
     SqlDatabase database; ///< SQL database for persistent storage of track data
+    std::unique_ptr<SqlDatabase> sharedDatabase; ///< User-level analysis store shared by every music folder (optional, see setSharedStore())
     
     TrackSorter sorter; ///< Track sorter which uses a quadtree representation to sort tracks in 2D
     
@@ -185,8 +280,7 @@ private:
     int numTracksAnalysed; ///< Number of analysed tracks in the array
     int numTracksAnalysedUnqueued; ///< Number of analysed, unqueued tracks in the array (i.e. number of track left to choose from)
     
-    std::unique_ptr<juce::DirectoryContentsList> dirContents; ///< Directory scanner, which discovers files in the chosen directory
-    juce::TimeSliceThread thread {"BackgroundUpdateThread"}; ///< Background thread which dirContents uses to update itself
+    juce::File directory; ///< The chosen music folder
     
     juce::CriticalSection lock; ///< RAII lock to ensure thread-safety while acessing data within this class
     
@@ -197,7 +291,7 @@ private:
     
     std::atomic<bool> validDirectory = false; ///< Thread-safe variable to indicates whether the chosen music folder is valid
     
-    DirectionView* directionView; ///< Pointer to the Direction view, so it can be refreshed when track data changes
+    TrackDataListener* listener = nullptr; ///< Object to notify when track data changes, e.g. the Direction view (optional)
     
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DataManager) ///< JUCE macro to add a memory leak detector
@@ -89,6 +89,10 @@ void DeckComponent::update()
         track.leader = true;
         updateMixMarkers();
     }
+    else if (trackProcessor->getCurrentMix().id != mixId)
+    {
+        updateMixMarkers();
+    }
     
     if (ready.load())
     {
@@ -100,7 +104,7 @@ void DeckComponent::update()
 void DeckComponent::logPlayheadPosition()
 {
     if (ready.load())
-        playhead = trackProcessor->getTrack()->getPlayhead();
+        playhead = trackProcessor->getAudiblePlayhead();
 }
 
 
@@ -110,6 +114,10 @@ void DeckComponent::load(Track* trackPtr)
     
     track = *trackPtr;
     
+    // The deck's audio is released by the DJ as soon as the track finishes, which could be while the waveform is still
+    // being loaded from it, so the waveform is read from the database (or decoded again) instead
+    track.audio = nullptr;
+    
     title = track.info->getArtistTitle();
     info = "Length: " + AutoDJ::getLengthString(track.info->length) +  "    BPM: " + juce::String(track.info->bpm) +  "    Key: " + CamelotKey(track.info->key).getName() +  "    Groove: " + AutoDJ::getGrooveString(track.info->groove);
     
@@ -129,6 +137,8 @@ void DeckComponent::reset()
     title.clear();
     info.clear();
     
+    mixId = MIX_ID_NONE;
+    
     ready.store(false);
 }
 
@@ -140,6 +150,7 @@ void DeckComponent::updateMixMarkers()
     int start, end;
     
     MixInfo mix = trackProcessor->getCurrentMix();
+    mixId = mix.id;
     
     waveform->clearMarkers();
     
@@ -154,10 +165,9 @@ void DeckComponent::updateMixMarkers()
         end = mix.followerEnd;
     }
     
+    // The markers are drawn on a separate overlay, so the waveform doesn't need to be reloaded
     waveform->insertMarker(start);
     waveform->insertMarker(end);
     
-    waveform->load(&track, true);
-    
     ready.store(true);
 }
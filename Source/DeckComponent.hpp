@@ -61,6 +61,7 @@ private:
     TrackProcessor* trackProcessor = nullptr; ///< Pointer to track audio processor associated with this deck
     
     Track track; ///< Information on the current track
+    int mixId = MIX_ID_NONE; ///< ID of the mix whose markers are shown (markers are updated when it changes, e.g. at the end of a hold)
     
     int playhead = 0; ///< Track playhead position (current audio sample reached in track)
     
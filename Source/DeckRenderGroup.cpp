@@ -0,0 +1,166 @@
+//
+//  DeckRenderGroup.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "DeckRenderGroup.hpp"
+
+#include "TrackProcessor.hpp"
+#include "Profiler.hpp"
+#include "RealtimeSafety.hpp"
+
+
+DeckRenderGroup::DeckRenderGroup(int numWorkers)
+{
+    if (numWorkers < 0)
+        numWorkers = getDefaultNumWorkers();
+    
+    for (int i = 0; i < numWorkers; i++)
+        workers.add(new Worker(this))->startThread(DECK_RENDER_PRIORITY);
+}
+
+
+DeckRenderGroup::~DeckRenderGroup()
+{
+    for (auto* worker : workers)
+        worker->stop();
+}
+
+
+int DeckRenderGroup::getDefaultNumWorkers()
+{
+    // The calling thread renders too, and a core is left for the audio callback when rendering ahead
+    return juce::jlimit(0, NUM_DECKS - 1, juce::SystemStats::getNumCpus() - 2);
+}
+
+
+void DeckRenderGroup::render(TrackProcessor** blockDecks, int blockNumDecks, int blockNumSamples)
+{
+    PROFILE_ZONE("renderDecks")
+    
+    jassert(blockNumDecks <= 0xFFFF);
+    
+    // Every deck of the last block has been rendered, so no thread still reads the job, and it can be replaced
+    decks = blockDecks;
+    numSamples = blockNumSamples;
+    numRendered.store(0, std::memory_order_relaxed);
+    
+    // Publish the decks to claim (this releases the job above to whoever claims them)
+    juce::uint32 block = blockNumber.load(std::memory_order_relaxed) + 1;
+    nextClaim.store(makeClaim(block, blockNumDecks, 0), std::memory_order_release);
+    
+    // Publish the block, and wake any workers that are sleeping
+    // (sequentially consistent, so that a worker going to sleep either sees the new block, or is seen to be sleeping)
+    blockNumber.store(block);
+    
+    for (auto* worker : workers)
+        worker->wake();
+    
+    renderDecks(block);
+    
+    // Barrier: wait for every deck to be rendered, so their output is complete
+    // (the remaining decks are already being rendered, so this wait is short)
+    while (numRendered.load(std::memory_order_acquire) < blockNumDecks)
+        juce::Thread::yield();
+}
+
+
+void DeckRenderGroup::renderDecks(juce::uint32 block)
+{
+    juce::uint64 claim = nextClaim.load(std::memory_order_acquire);
+    
+    while (true)
+    {
+        int count = int((claim >> 16) & 0xFFFF);
+        int index = int(claim & 0xFFFF);
+        
+        // Stop if the block has moved on (the decks belong to a newer block), or every deck has been claimed
+        if (juce::uint32(claim >> 32) != block || index >= count)
+            return;
+        
+        // Claim the deck (if another thread claimed it first, the claim is reloaded, and the next deck is tried)
+        if (nextClaim.compare_exchange_weak(claim, claim + 1, std::memory_order_acquire))
+        {
+            decks[index]->renderBlock(numSamples);
+            numRendered.fetch_add(1, std::memory_order_release);
+            
+            claim = nextClaim.load(std::memory_order_acquire);
+        }
+    }
+}
+
+
+DeckRenderGroup::Worker::Worker(DeckRenderGroup* g) :
+    juce::Thread("DeckRender"), group(g)
+{
+}
+
+
+void DeckRenderGroup::Worker::run()
+{
+    Profiler::nameCurrentThread("DeckRender");
+    
+    while (waitForBlock())
+    {
+        // The decks have the same deadline as the thread that renders the block, so check them for real-time safety
+        RealtimeSafety::ScopedRealtimeThread realtimeThread;
+        group->renderDecks(lastBlock);
+    }
+}
+
+
+bool DeckRenderGroup::Worker::waitForBlock()
+{
+    juce::int64 spinTicks = juce::Time::secondsToHighResolutionTicks(DECK_RENDER_SPIN_US / 1000000.0);
+    juce::int64 spinEnd = juce::Time::getHighResolutionTicks() + spinTicks;
+    
+    while (!threadShouldExit())
+    {
+        juce::uint32 block = group->blockNumber.load(std::memory_order_acquire);
+        
+        if (block != lastBlock)
+        {
+            lastBlock = block;
+            return true;
+        }
+        
+        // Spin for a fixed time rather than a number of checks, since the time a yield takes varies with the load
+        if (juce::Time::getHighResolutionTicks() < spinEnd)
+        {
+            juce::Thread::yield();
+            continue;
+        }
+        
+        // Sleep until the next block, checking once more after announcing it, so a wake-up can't be missed
+        sleeping.store(true);
+        
+        if (group->blockNumber.load() == lastBlock)
+            wakeEvent.wait(DECK_RENDER_WAIT_MS);
+        
+        sleeping.store(false);
+        spinEnd = juce::Time::getHighResolutionTicks() + spinTicks;
+    }
+    
+    return false;
+}
+
+
+void DeckRenderGroup::Worker::wake()
+{
+    // Only signal the event if the worker is sleeping, which avoids its lock while blocks come back-to-back
+    if (sleeping.load())
+    {
+        REALTIME_UNSAFE(lock, "DeckRenderGroup::Worker::wake")
+        wakeEvent.signal();
+    }
+}
+
+
+void DeckRenderGroup::Worker::stop()
+{
+    signalThreadShouldExit();
+    wakeEvent.signal();
+    stopThread(DECK_RENDER_STOP_TIMEOUT_MS);
+}
@@ -0,0 +1,143 @@
+//
+//  DeckRenderGroup.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef DeckRenderGroup_hpp
+#define DeckRenderGroup_hpp
+
+#include <JuceHeader.h>
+#include "CommonDefs.hpp"
+
+class TrackProcessor;
+
+
+// The worker threads must keep up with the audio callback, so they run at real-time priority:
+// on macOS, the audio thread's time-constraint policy, and elsewhere the highest priority (SCHED_RR on Linux, if permitted)
+#if JUCE_MAC
+ #define DECK_RENDER_PRIORITY (juce::Thread::realtimeAudioPriority) ///< Priority of the worker threads
+#else
+ #define DECK_RENDER_PRIORITY (10) ///< Priority of the worker threads (0-10)
+#endif
+#define DECK_RENDER_SPIN_US (200) ///< Time for which a worker checks for the next block (yielding in between) before it sleeps
+#define DECK_RENDER_WAIT_MS (50) ///< Longest time a sleeping worker waits before checking whether it should exit
+#define DECK_RENDER_STOP_TIMEOUT_MS (2000) ///< Time to wait for each worker thread to stop
+
+
+/**
+ Renders the decks (TrackProcessors) of a block in parallel, on a small group of worker threads plus the calling thread.
+ 
+ For each block, the calling thread publishes the job and wakes the workers, then every thread claims decks until none
+ are left. render() returns once every deck has been rendered (a barrier), so the decks' output can be read straight away,
+ without waiting for workers that are still waking up. Claims are tagged with the block number, so a worker that wakes
+ late can only claim decks from the block it woke for, and never one from the next block.
+ Each deck only touches its own state while rendering - anything that affects other decks (e.g. loading the next track)
+ is done afterwards, on the calling thread (see TrackProcessor::finishBlock()).
+ 
+ Between blocks, the workers spin briefly (which catches back-to-back blocks when rendering ahead, see RenderAhead),
+ then sleep until they are woken by the next block. Waking a sleeping worker takes a lock, so it is reported as a
+ real-time safety violation (see RealtimeSafety). The workers run at real-time priority (see DECK_RENDER_PRIORITY),
+ since the block can't finish until they do.
+ */
+class DeckRenderGroup
+{
+public:
+    
+    /** Constructor - starts the worker threads.
+     
+     @param[in] numWorkers Number of worker threads, where 0 renders every deck on the calling thread,
+     and -1 chooses automatically (one fewer than the number of decks, if there are enough CPU cores) */
+    DeckRenderGroup(int numWorkers);
+    
+    /** Destructor - stops the worker threads. */
+    ~DeckRenderGroup();
+    
+    /** Renders a block of audio through each deck, into their own buffers (see TrackProcessor::renderBlock()).
+     Only call from the thread that renders the audio (the audio thread, or the render thread when rendering ahead).
+     
+     @param[in] decks Array of decks to render
+     @param[in] numDecks Number of decks in the array
+     @param[in] numSamples Number of samples in the block */
+    void render(TrackProcessor** decks, int numDecks, int numSamples);
+    
+    /** Fetches the number of worker threads, not including the calling thread.
+     
+     @return Number of worker threads */
+    int getNumWorkers() { return workers.size(); }
+    
+    /** Calculates the number of worker threads used when the number isn't specified, based on the number of decks and CPU cores.
+     
+     @return Default number of worker threads */
+    static int getDefaultNumWorkers();
+    
+private:
+    
+    /** A worker thread, which renders decks whenever a new block is published. */
+    class Worker : public juce::Thread
+    {
+    public:
+        
+        /** Constructor.
+         
+         @param[in] group Pointer to the group that owns the worker */
+        Worker(DeckRenderGroup* group);
+        
+        /** Worker thread loop, which waits for each block and helps to render it. */
+        void run() override;
+        
+        /** Wakes the worker if it is sleeping. */
+        void wake();
+        
+        /** Stops the worker thread, waking it if necessary. */
+        void stop();
+    
+    private:
+        
+        /** Waits for the next block to be published.
+         
+         @return False if the thread should exit instead */
+        bool waitForBlock();
+        
+        DeckRenderGroup* group = nullptr; ///< Pointer to the group that owns the worker
+        juce::WaitableEvent wakeEvent; ///< Wakes the worker when it is sleeping between blocks
+        std::atomic<bool> sleeping = false; ///< Indicates whether the worker is (about to be) waiting on wakeEvent
+        juce::uint32 lastBlock = 0; ///< Number of the last block the worker rendered
+    
+    
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Worker) ///< JUCE macro to add a memory leak detector
+    };
+    
+    /** Renders decks until there are none left in a block. Called by every thread in the group.
+     
+     @param[in] block Number of the block to render, which the decks are claimed from */
+    void renderDecks(juce::uint32 block);
+    
+    /** Packs the state of a block's claims into one word, so they can be claimed atomically.
+     
+     @param[in] block Number of the block
+     @param[in] count Number of decks in the block
+     @param[in] index Index of the next deck to be claimed
+     
+     @return Claim word (see nextClaim) */
+    static juce::uint64 makeClaim(juce::uint32 block, int count, int index)
+    {
+        return ((juce::uint64)block << 32) | ((juce::uint64)count << 16) | (juce::uint64)index;
+    }
+    
+    
+    juce::OwnedArray<Worker> workers; ///< Worker threads
+    
+    std::atomic<juce::uint32> blockNumber = 0; ///< Number of blocks published, which the workers watch for changes
+    std::atomic<juce::uint64> nextClaim = 0; ///< Block number (upper 32 bits), number of decks (16 bits), and index of the next deck to claim (lower 16 bits)
+    std::atomic<int> numRendered = 0; ///< Number of decks that have been rendered in the current block (see render())
+    
+    TrackProcessor** decks = nullptr; ///< Decks of the current block (only read after claiming one of them)
+    int numSamples = 0; ///< Number of samples in the current block (only read after claiming a deck)
+    
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DeckRenderGroup) ///< JUCE macro to add a memory leak detector
+};
+
+#endif /* DeckRenderGroup_hpp */
@@ -12,12 +12,13 @@
 #include "TrackDotComponent.hpp"
 #include "AnalysisManager.hpp"
 #include "TransitionLine.hpp"
+#include "TrackDataListener.hpp"
 
 
 /**
  The Direction view UI, which shows the music library distributed in terms of tempo and groove, with colour-coding against Camelot key signature.
  */
-class DirectionView : public juce::Component, public juce::HighResolutionTimer
+class DirectionView : public juce::Component, public juce::HighResolutionTimer, public TrackDataListener
 {
 public:
     
@@ -45,13 +46,13 @@ public:
     /** Adds a newly-analysed track to be displayed.
      
      @param[in] track Information of the track to be added */
-    void addAnalysed(TrackInfo* track);
+    void addAnalysed(TrackInfo* track) override;
     
     /** Places every track in the 2D tempo/groove distribution. */
     void calculatePositions();
     
     /** Removes all tracks from the view. */
-    void reset();
+    void reset() override;
     
 private:
     
@@ -0,0 +1,306 @@
+//
+//  DspBenchmarks.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "DspBenchmarks.hpp"
+
+#include "CommonDefs.hpp"
+#include "BiquadBank.hpp"
+#include "StateVariableFilter.hpp"
+#include "Automation.hpp"
+#include "Interleave.hpp"
+#include "Track.hpp"
+#include "AnalyserWaveform.hpp"
+
+#define DSP_BENCHMARK_BLOCK_SIZE (512) ///< Size of the audio blocks in playback benchmarks, as in the audio callback
+
+namespace DspBenchmarks {
+
+
+/** Times a function, taking the fastest of DSP_BENCHMARK_REPEATS runs.
+ 
+ @param[in] function Function to time
+ @param[in] numSamples Number of samples processed by the function
+ 
+ @return Time taken, in nanoseconds per sample */
+static double timeNsPerSample(std::function<void()> function, int numSamples)
+{
+    double fastest = std::numeric_limits<double>::max();
+    
+    for (int i = 0; i < DSP_BENCHMARK_REPEATS; i++)
+    {
+        juce::int64 start = juce::Time::getHighResolutionTicks();
+        function();
+        juce::int64 end = juce::Time::getHighResolutionTicks();
+        
+        fastest = juce::jmin(fastest, juce::Time::highResolutionTicksToSeconds(end - start));
+    }
+    
+    return fastest * 1e9 / numSamples;
+}
+
+
+/** Finds the largest difference between two sets of channels.
+ 
+ @param[in] a First set of channels
+ @param[in] b Second set of channels
+ 
+ @return Largest absolute difference between any two samples */
+static float getMaxError(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+{
+    float maxError = 0.f;
+    
+    for (int channel = 0; channel < a.getNumChannels(); channel++)
+        for (int i = 0; i < a.getNumSamples(); i++)
+            maxError = juce::jmax(maxError, std::abs(a.getSample(channel, i) - b.getSample(channel, i)));
+    
+    return maxError;
+}
+
+
+/** Stereo high-pass filter: two juce::IIRFilters against one BiquadBank. */
+static DspBenchmarkResult benchmarkStereoHighPass(const juce::AudioBuffer<float>& audio)
+{
+    DspBenchmarkResult result;
+    result.name = "Stereo high-pass biquad";
+    
+    int numSamples = audio.getNumSamples();
+    juce::IIRCoefficients coefficients = juce::IIRCoefficients::makeHighPass(SUPPORTED_SAMPLERATE, 1000, 1.0);
+    
+    juce::AudioBuffer<float> reference(audio);
+    juce::AudioBuffer<float> optimised(audio);
+    
+    result.referenceNs = timeNsPerSample([&]() {
+        juce::IIRFilter filterL, filterR;
+        filterL.setCoefficients(coefficients);
+        filterR.setCoefficients(coefficients);
+        reference.makeCopyOf(audio);
+        
+        for (int start = 0; start + DSP_BENCHMARK_BLOCK_SIZE <= numSamples; start += DSP_BENCHMARK_BLOCK_SIZE)
+        {
+            filterL.processSamples(reference.getWritePointer(0, start), DSP_BENCHMARK_BLOCK_SIZE);
+            filterR.processSamples(reference.getWritePointer(1, start), DSP_BENCHMARK_BLOCK_SIZE);
+        }
+    }, numSamples);
+    
+    result.optimisedNs = timeNsPerSample([&]() {
+        BiquadBank filter;
+        filter.setCoefficients(coefficients);
+        optimised.makeCopyOf(audio);
+        
+        for (int start = 0; start + DSP_BENCHMARK_BLOCK_SIZE <= numSamples; start += DSP_BENCHMARK_BLOCK_SIZE)
+        {
+            float* channels[2] = { optimised.getWritePointer(0, start), optimised.getWritePointer(1, start) };
+            filter.processChannels(channels, 2, DSP_BENCHMARK_BLOCK_SIZE);
+        }
+    }, numSamples);
+    
+    result.maxError = getMaxError(reference, optimised);
+    
+    return result;
+}
+
+
+/** Splitting audio into the three waveform colour bands, as in AnalyserWaveform: three juce::IIRFilters against one BiquadBank. */
+static DspBenchmarkResult benchmarkBandSplit(const juce::AudioBuffer<float>& audio)
+{
+    DspBenchmarkResult result;
+    result.name = "Three-band split (AnalyserWaveform)";
+    
+    int numSamples = audio.getNumSamples();
+    int blockSize = WAVEFORM_BLOCK_FRAMES * WAVEFORM_FRAME_SIZE;
+    
+    juce::IIRCoefficients coefficients[3] = {
+        juce::IIRCoefficients::makeLowPass(SUPPORTED_SAMPLERATE, 200, 1.0),
+        juce::IIRCoefficients::makeBandPass(SUPPORTED_SAMPLERATE, 500, 1.0),
+        juce::IIRCoefficients::makeHighPass(SUPPORTED_SAMPLERATE, 10000, 1.0)
+    };
+    
+    juce::AudioBuffer<float> reference(3, numSamples);
+    juce::AudioBuffer<float> optimised(3, numSamples);
+    
+    result.referenceNs = timeNsPerSample([&]() {
+        juce::IIRFilter filters[3];
+        
+        for (int band = 0; band < 3; band++)
+            filters[band].setCoefficients(coefficients[band]);
+        
+        for (int start = 0; start + blockSize <= numSamples; start += blockSize)
+        {
+            for (int band = 0; band < 3; band++)
+            {
+                reference.copyFrom(band, start, audio, 0, start, blockSize);
+                filters[band].processSamples(reference.getWritePointer(band, start), blockSize);
+            }
+        }
+    }, numSamples);
+    
+    result.optimisedNs = timeNsPerSample([&]() {
+        BiquadBank filters;
+        
+        for (int band = 0; band < 3; band++)
+            filters.setCoefficients(band, coefficients[band]);
+        
+        for (int start = 0; start + blockSize <= numSamples; start += blockSize)
+        {
+            float* outputs[3] = { optimised.getWritePointer(0, start), optimised.getWritePointer(1, start), optimised.getWritePointer(2, start) };
+            filters.processSplit(audio.getReadPointer(0, start), outputs, 3, blockSize);
+        }
+    }, numSamples);
+    
+    result.maxError = getMaxError(reference, optimised);
+    
+    return result;
+}
+
+
+/** Crossfade gain and filter sweep, as in TrackProcessor: a constant sqrt() gain and juce::IIRCoefficients recalculated every block,
+ against per-sample equal-power gain and cut-off ramps (see Automation) applied in one pass by a StateVariableFilter.
+ The reference is stepped, so the outputs aren't expected to match. */
+static DspBenchmarkResult benchmarkCrossfade(const juce::AudioBuffer<float>& audio)
+{
+    DspBenchmarkResult result;
+    result.name = "Crossfade gain and high-pass sweep (TrackProcessor)";
+    
+    int numSamples = audio.getNumSamples();
+    int numBlocks = numSamples / DSP_BENCHMARK_BLOCK_SIZE;
+    
+    juce::AudioBuffer<float> output(audio);
+    juce::AudioBuffer<float> automation(2, DSP_BENCHMARK_BLOCK_SIZE);
+    
+    result.referenceNs = timeNsPerSample([&]() {
+        juce::IIRFilter filterL, filterR;
+        output.makeCopyOf(audio);
+        
+        for (int block = 0; block < numBlocks; block++)
+        {
+            int start = block * DSP_BENCHMARK_BLOCK_SIZE;
+            double position = double(block + 1) / numBlocks;
+            int frequency = juce::roundToInt(HIGH_PASS_MAX * position);
+            
+            output.applyGain(start, DSP_BENCHMARK_BLOCK_SIZE, float(std::sqrt(1.0 - position)));
+            
+            juce::IIRCoefficients coefficients = juce::IIRCoefficients::makeHighPass(SUPPORTED_SAMPLERATE, juce::jmax(1, frequency), 1.0);
+            filterL.setCoefficients(coefficients);
+            filterR.setCoefficients(coefficients);
+            
+            filterL.processSamples(output.getWritePointer(0, start), DSP_BENCHMARK_BLOCK_SIZE);
+            filterR.processSamples(output.getWritePointer(1, start), DSP_BENCHMARK_BLOCK_SIZE);
+        }
+    }, numSamples);
+    
+    result.optimisedNs = timeNsPerSample([&]() {
+        StateVariableFilter filter;
+        output.makeCopyOf(audio);
+        
+        for (int block = 0; block < numBlocks; block++)
+        {
+            int start = block * DSP_BENCHMARK_BLOCK_SIZE;
+            float startPosition = float(block) / numBlocks;
+            float endPosition = float(block + 1) / numBlocks;
+            
+            float* gainRamp = automation.getWritePointer(0);
+            float* highPassRamp = automation.getWritePointer(1);
+            Automation::renderEqualPower(gainRamp, DSP_BENCHMARK_BLOCK_SIZE, 1.f - startPosition, 1.f - endPosition);
+            Automation::renderLinear(highPassRamp, DSP_BENCHMARK_BLOCK_SIZE, HIGH_PASS_MAX * startPosition, HIGH_PASS_MAX * endPosition);
+            
+            float* channels[2] = { output.getWritePointer(0, start), output.getWritePointer(1, start) };
+            filter.processHighPass(channels, 2, DSP_BENCHMARK_BLOCK_SIZE, highPassRamp, gainRamp);
+        }
+    }, numSamples);
+    
+    result.maxError = -1.f;
+    
+    return result;
+}
+
+
+/** Interleaving stereo audio for SoundTouch and back, as in TimeStretcher: getSample()/setSample() loops against the Interleave kernels. */
+static DspBenchmarkResult benchmarkInterleave(const juce::AudioBuffer<float>& audio)
+{
+    DspBenchmarkResult result;
+    result.name = "Stereo interleave round trip (TimeStretcher)";
+    
+    int numSamples = audio.getNumSamples();
+    
+    juce::AudioBuffer<float> interleaved(1, DSP_BENCHMARK_BLOCK_SIZE * 2);
+    juce::AudioBuffer<float> reference(audio);
+    juce::AudioBuffer<float> optimised(audio);
+    
+    result.referenceNs = timeNsPerSample([&]() {
+        for (int start = 0; start + DSP_BENCHMARK_BLOCK_SIZE <= numSamples; start += DSP_BENCHMARK_BLOCK_SIZE)
+        {
+            for (int i = 0; i < DSP_BENCHMARK_BLOCK_SIZE; i++)
+            {
+                interleaved.setSample(0, i*2, audio.getSample(0, start + i));
+                interleaved.setSample(0, i*2 + 1, audio.getSample(1, start + i));
+            }
+            
+            for (int i = 0; i < DSP_BENCHMARK_BLOCK_SIZE; i++)
+            {
+                reference.setSample(0, start + i, interleaved.getSample(0, i*2));
+                reference.setSample(1, start + i, interleaved.getSample(0, i*2 + 1));
+            }
+        }
+    }, numSamples);
+    
+    result.optimisedNs = timeNsPerSample([&]() {
+        for (int start = 0; start + DSP_BENCHMARK_BLOCK_SIZE <= numSamples; start += DSP_BENCHMARK_BLOCK_SIZE)
+        {
+            Interleave::interleave(audio.getReadPointer(0, start), audio.getReadPointer(1, start), interleaved.getWritePointer(0), DSP_BENCHMARK_BLOCK_SIZE);
+            Interleave::deinterleave(interleaved.getReadPointer(0), optimised.getWritePointer(0, start), optimised.getWritePointer(1, start), DSP_BENCHMARK_BLOCK_SIZE);
+        }
+    }, numSamples);
+    
+    result.maxError = getMaxError(reference, optimised);
+    
+    return result;
+}
+
+
+juce::Array<DspBenchmarkResult> run()
+{
+    // Use white noise as the test audio, so that the filters never decay to silence
+    juce::AudioBuffer<float> audio(2, DSP_BENCHMARK_SECONDS * SUPPORTED_SAMPLERATE);
+    juce::Random random(1);
+    
+    for (int channel = 0; channel < audio.getNumChannels(); channel++)
+        for (int i = 0; i < audio.getNumSamples(); i++)
+            audio.setSample(channel, i, random.nextFloat() * 2.f - 1.f);
+    
+    juce::Array<DspBenchmarkResult> results;
+    results.add(benchmarkStereoHighPass(audio));
+    results.add(benchmarkBandSplit(audio));
+    results.add(benchmarkCrossfade(audio));
+    results.add(benchmarkInterleave(audio));
+    
+    return results;
+}
+
+
+juce::String toString(const juce::Array<DspBenchmarkResult>& results)
+{
+    juce::String text;
+    
+    for (auto& result : results)
+    {
+        double speedup = (result.optimisedNs > 0.0) ? result.referenceNs / result.optimisedNs : 0.0;
+        
+        text << result.name << ": "
+             << juce::String(result.referenceNs, 2) << " ns/sample -> " << juce::String(result.optimisedNs, 2) << " ns/sample"
+             << " (" << juce::String(speedup, 2) << "x";
+        
+        if (result.maxError >= 0.f)
+            text << ", max error " << juce::String(result.maxError, 8);
+        
+        text << ")" << juce::newLine;
+    }
+    
+    return text;
+}
+
+
+}
@@ -0,0 +1,49 @@
+//
+//  DspBenchmarks.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef DspBenchmarks_hpp
+#define DspBenchmarks_hpp
+
+#include <JuceHeader.h>
+
+
+#define DSP_BENCHMARK_SECONDS (60) ///< Length of the test audio processed by each benchmark
+#define DSP_BENCHMARK_REPEATS (5) ///< Number of times each benchmark is repeated, of which the fastest is reported
+
+
+/** Result of a single DSP microbenchmark, comparing an optimised implementation against the reference it replaces. */
+typedef struct DspBenchmarkResult {
+    juce::String name; ///< Name of the benchmark
+    double referenceNs; ///< Time taken by the reference implementation, in nanoseconds per sample
+    double optimisedNs; ///< Time taken by the optimised implementation, in nanoseconds per sample
+    float maxError; ///< Largest difference between the outputs of the two implementations, or -1 if they aren't expected to match
+} DspBenchmarkResult;
+
+
+/**
+ Microbenchmarks for the low-level DSP used in analysis and playback, each of which times an optimised
+ implementation against the simpler one it replaced (e.g. BiquadBank against juce::IIRFilter), on the same test audio.
+ 
+ Run them with: AutoDJ-Console --benchmark-dsp
+ */
+namespace DspBenchmarks {
+
+/** Runs every benchmark.
+ 
+ @return Results of each benchmark */
+juce::Array<DspBenchmarkResult> run();
+
+/** Formats benchmark results as a table, for printing.
+ 
+ @param[in] results Results of run()
+ 
+ @return Text of the table */
+juce::String toString(const juce::Array<DspBenchmarkResult>& results);
+
+}
+
+#endif /* DspBenchmarks_hpp */
@@ -0,0 +1,117 @@
+//
+//  ExtraDeckTest.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "ExtraDeckTest.hpp"
+
+#include "CommonDefs.hpp"
+#include "TrackProcessor.hpp"
+#include "DeckRenderGroup.hpp"
+
+
+namespace ExtraDeckTest {
+
+/** Renders and finishes one block on every deck, as AudioProcessor::processBlock() does.
+ 
+ @param[in] group Render group to use
+ @param[in] decks Decks to render
+ 
+ @return True if only the extra deck produced any audio */
+static bool renderBlock(DeckRenderGroup& group, juce::OwnedArray<TrackProcessor>& decks)
+{
+    group.render(decks.data(), decks.size(), EXTRA_DECK_TEST_BLOCK_SIZE);
+    
+    bool mixDecksSilent = true;
+    
+    for (int i = 0; i < NUM_MIX_DECKS; i++)
+        mixDecksSilent = mixDecksSilent && !decks[i]->hasOutput();
+    
+    for (auto* deck : decks)
+        deck->finishBlock();
+    
+    return mixDecksSilent;
+}
+
+
+bool run()
+{
+    // A sine tone at the track's tempo, so the deck plays it without time stretching
+    int numSamples = EXTRA_DECK_TEST_SECONDS * SUPPORTED_SAMPLERATE;
+    juce::AudioBuffer<float> audio(2, numSamples);
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        float sample = 0.5f * std::sin(juce::MathConstants<float>::twoPi * 440.0f * i / SUPPORTED_SAMPLERATE);
+        audio.setSample(0, i, sample);
+        audio.setSample(1, i, sample);
+    }
+    
+    TrackInfo info;
+    info.bpm = EXTRA_DECK_TEST_BPM;
+    info.length = EXTRA_DECK_TEST_SECONDS;
+    
+    // The mix decks are partnered as in AudioProcessor, but never loaded, and there is no DJ to take mixes from
+    juce::OwnedArray<TrackProcessor> decks;
+    
+    for (int i = 0; i < EXTRA_DECK_TEST_NUM_DECKS; i++)
+    {
+        decks.add(new TrackProcessor(nullptr, nullptr));
+        decks.getLast()->prepare(EXTRA_DECK_TEST_BLOCK_SIZE);
+    }
+    
+    decks[0]->setPartner(decks[1]);
+    decks[1]->setPartner(decks[0]);
+    
+    TrackProcessor* extraDeck = decks.getLast();
+    
+    bool passed = AutoDJ::checkTest(decks[0]->isMixDeck() && !extraDeck->isMixDeck(), "only the first " + juce::String(NUM_MIX_DECKS) + " decks are mix decks");
+    
+    // Render with a worker per extra deck, so the decks are claimed by more than one thread
+    DeckRenderGroup group(EXTRA_DECK_TEST_NUM_DECKS - 1);
+    
+    // Play the whole track, which must stop by itself once it ends
+    extraDeck->playTrack(&info, &audio);
+    
+    int maxBlocks = 2 * numSamples / EXTRA_DECK_TEST_BLOCK_SIZE;
+    int numBlocks = 0;
+    int numAudible = 0;
+    bool mixDecksSilent = true;
+    
+    while (extraDeck->isPlaying() && numBlocks < maxBlocks)
+    {
+        mixDecksSilent = renderBlock(group, decks) && mixDecksSilent;
+        
+        if (extraDeck->hasOutput() && extraDeck->getOutput().getMagnitude(0, EXTRA_DECK_TEST_BLOCK_SIZE) > 0.f)
+            numAudible += 1;
+        
+        numBlocks += 1;
+    }
+    
+    passed = AutoDJ::checkTest(numAudible > 0, "the extra deck plays its track (" + juce::String(numAudible) + " audible blocks)") && passed;
+    passed = AutoDJ::checkTest(!extraDeck->isPlaying(), "the extra deck stops at the end of its track (after " + juce::String(numBlocks) + " blocks)") && passed;
+    passed = AutoDJ::checkTest(mixDecksSilent, "the mix decks stay silent") && passed;
+    
+    renderBlock(group, decks);
+    passed = AutoDJ::checkTest(!extraDeck->hasOutput(), "the extra deck is silent once stopped") && passed;
+    
+    for (int i = 0; i < NUM_MIX_DECKS; i++)
+        passed = AutoDJ::checkTest(!decks[i]->isReady() && !decks[i]->mixEnded(), "mix deck " + juce::String(i) + " is untouched") && passed;
+    
+    // Play from halfway, and stop early
+    extraDeck->playTrack(&info, &audio, numSamples / 2);
+    renderBlock(group, decks);
+    passed = AutoDJ::checkTest(extraDeck->hasOutput() && extraDeck->isPlaying(), "the extra deck plays from a given position") && passed;
+    
+    extraDeck->stop();
+    renderBlock(group, decks);
+    passed = AutoDJ::checkTest(!extraDeck->hasOutput() && !extraDeck->isPlaying(), "the extra deck stops when asked") && passed;
+    
+    std::cout << (passed ? "Extra deck test passed" : "Extra deck test FAILED") << std::endl;
+    
+    return passed;
+}
+
+}
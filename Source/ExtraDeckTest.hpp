@@ -0,0 +1,37 @@
+//
+//  ExtraDeckTest.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef ExtraDeckTest_hpp
+#define ExtraDeckTest_hpp
+
+#include <JuceHeader.h>
+
+
+#define EXTRA_DECK_TEST_NUM_DECKS (NUM_MIX_DECKS + 1) ///< Number of decks in the test, one more than the DJ mixes between
+#define EXTRA_DECK_TEST_BLOCK_SIZE (512) ///< Size of the simulated audio blocks
+#define EXTRA_DECK_TEST_SECONDS (2) ///< Length of the synthetic track played on the extra deck
+#define EXTRA_DECK_TEST_BPM (120) ///< Tempo of the synthetic track
+
+
+/**
+ Tests a deck outside the DJ's mix (one beyond the first NUM_MIX_DECKS, see AudioProcessor), which has no partner.
+ The decks are rendered by a DeckRenderGroup and finished in the same order as AudioProcessor::processBlock(),
+ with the mix decks left unloaded and no DJ at all, so the extra deck must never reach for the DJ's next mix.
+ Checks that a track played on the extra deck produces audio, stops by itself when it ends, and can be stopped early.
+ 
+ Run it with: AutoDJ --test-decks
+ */
+namespace ExtraDeckTest {
+
+/** Runs the test, printing each check as it goes.
+ 
+ @return True if every check passed */
+bool run();
+
+}
+
+#endif /* ExtraDeckTest_hpp */
@@ -0,0 +1,83 @@
+//
+//  Interleave.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "Interleave.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define INTERLEAVE_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+ #include <arm_neon.h>
+ #define INTERLEAVE_NEON
+#endif
+
+namespace Interleave {
+
+
+void interleave(const float* left, const float* right, float* output, int numSamples)
+{
+    int i = 0;
+
+#if defined(INTERLEAVE_SSE)
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        __m128 l = _mm_loadu_ps(left + i);
+        __m128 r = _mm_loadu_ps(right + i);
+        
+        // L0 R0 L1 R1, then L2 R2 L3 R3
+        _mm_storeu_ps(output + i*2, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(output + i*2 + 4, _mm_unpackhi_ps(l, r));
+    }
+#elif defined(INTERLEAVE_NEON)
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        float32x4x2_t lr = { { vld1q_f32(left + i), vld1q_f32(right + i) } };
+        vst2q_f32(output + i*2, lr);
+    }
+#endif
+    
+    // Remaining samples (or all of them, without SIMD)
+    for (; i < numSamples; i++)
+    {
+        output[i*2] = left[i];
+        output[i*2 + 1] = right[i];
+    }
+}
+
+
+void deinterleave(const float* input, float* left, float* right, int numSamples)
+{
+    int i = 0;
+
+#if defined(INTERLEAVE_SSE)
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        __m128 a = _mm_loadu_ps(input + i*2);
+        __m128 b = _mm_loadu_ps(input + i*2 + 4);
+        
+        // Even elements are left samples, odd elements are right samples
+        _mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+#elif defined(INTERLEAVE_NEON)
+    for (; i + 4 <= numSamples; i += 4)
+    {
+        float32x4x2_t lr = vld2q_f32(input + i*2);
+        vst1q_f32(left + i, lr.val[0]);
+        vst1q_f32(right + i, lr.val[1]);
+    }
+#endif
+    
+    for (; i < numSamples; i++)
+    {
+        left[i] = input[i*2];
+        right[i] = input[i*2 + 1];
+    }
+}
+
+
+}
@@ -0,0 +1,40 @@
+//
+//  Interleave.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef Interleave_hpp
+#define Interleave_hpp
+
+#include <JuceHeader.h>
+
+
+/**
+ Converts stereo audio between separate left/right channels (as in juce::AudioBuffer) and a single buffer of
+ interleaved L/R sample pairs (as required by SoundTouch, see TimeStretcher).
+ 
+ The conversion is done four samples at a time using SIMD instructions (SSE on x86, NEON on ARM), with a scalar fallback.
+ */
+namespace Interleave {
+
+/** Interleaves two channels of audio into one buffer.
+ 
+ @param[in] left Pointer to left channel samples
+ @param[in] right Pointer to right channel samples
+ @param[out] output Output location for the interleaved samples, which must have space for 2 * numSamples
+ @param[in] numSamples Number of stereo samples to interleave */
+void interleave(const float* left, const float* right, float* output, int numSamples);
+
+/** De-interleaves one buffer of audio into two channels.
+ 
+ @param[in] input Pointer to interleaved samples, of which there are 2 * numSamples
+ @param[out] left Output location for left channel samples
+ @param[out] right Output location for right channel samples
+ @param[in] numSamples Number of stereo samples to de-interleave */
+void deinterleave(const float* input, float* left, float* right, int numSamples);
+
+}
+
+#endif /* Interleave_hpp */
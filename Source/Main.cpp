@@ -8,9 +8,18 @@
 
 #include <JuceHeader.h>
 #include "MainComponent.hpp"
+#include "Tracer.hpp"
+#include "RealtimeSafety.hpp"
+#include "MixServer.hpp"
+#include "AnalysisWorkerPool.hpp"
+#include "StretchProfiles.hpp"
+#include "ExtraDeckTest.hpp"
+#include "RealtimeSafetyTest.hpp"
+#include "CommonDefs.hpp"
 
 //==============================================================================
-class AutoDJApplication  : public juce::JUCEApplication
+class AutoDJApplication  : public juce::JUCEApplication,
+                           private juce::Timer
 {
 public:
     //==============================================================================
@@ -25,6 +34,98 @@ public:
     {
         // This method is where you should put your application's initialisation code..
 
+        // When launched by an AnalysisWorkerPool, analyse one file and exit, without opening a window
+        if (commandLine.contains (ANALYSIS_WORKER_OPTION))
+        {
+            // The worker's path is a single argument (see AnalysisWorkerPool::getWorkerCommand()), so it's read from the
+            // parameter array rather than the joined command line, in which a path containing spaces is quoted
+            juce::ArgumentList args ("AutoDJ", getCommandLineParameterArray());
+            juce::File file (args.getValueForOption (ANALYSIS_WORKER_OPTION));
+            int features = args.containsOption (ANALYSIS_WORKER_FEATURES_OPTION) ? args.getValueForOption (ANALYSIS_WORKER_FEATURES_OPTION).getIntValue() : ANALYSIS_FEATURES_REQUIRED;
+            setApplicationReturnValue (AnalysisWorkerPool::runWorker (file, features));
+            quit();
+            return;
+        }
+
+        // Analyse the library in separate worker processes, so a file that crashes the analysers can't take down the app:
+        //   --analysis-workers [8]
+        if (commandLine.contains ("--analysis-workers"))
+        {
+            juce::ArgumentList args ("AutoDJ", getCommandLineParameterArray());
+            int numWorkers = AutoDJ::getOptionValue (args, "--analysis-workers").getIntValue();
+            AnalysisWorkerPool::setEnabled (true, numWorkers > 0 ? numWorkers : -1);
+        }
+
+        // Reuse analysis across music folders, using a store in the user's application data (or the given file):
+        //   --shared-analysis [/path/to/store.db]
+        if (commandLine.contains ("--shared-analysis"))
+        {
+            // Read from the parameter array, in which a path containing spaces is a single unquoted argument
+            juce::ArgumentList args ("AutoDJ", getCommandLineParameterArray());
+            juce::String path = AutoDJ::getOptionValue (args, "--shared-analysis");
+            DataManager::setSharedStore (path.isEmpty() ? DataManager::getDefaultSharedStore()
+                                                        : juce::File::getCurrentWorkingDirectory().getChildFile (path));
+        }
+
+        // Record a timeline of all thread activity, written to a Chrome trace file at exit
+        if (commandLine.contains("--trace"))
+            Tracer::setEnabled(true);
+
+        // Log any real-time safety violation (e.g. allocation on the audio thread), or also trap them in the debugger
+        if (commandLine.contains("--rt-trap"))
+            RealtimeSafety::setMode(RealtimeSafety::Mode::trapping);
+        else if (commandLine.contains("--rt-check"))
+            RealtimeSafety::setMode(RealtimeSafety::Mode::logging);
+
+        // Choose the time stretching quality for this deployment (it is still dropped automatically if the audio load stays high):
+        //   --stretch-quality low|medium|high
+        if (commandLine.contains ("--stretch-quality"))
+        {
+            juce::ArgumentList args ("AutoDJ", getCommandLineParameterArray());
+            juce::String name = AutoDJ::getOptionValue (args, "--stretch-quality");
+            StretchQuality quality;
+
+            if (StretchProfiles::findQuality (name, quality))
+                StretchProfiles::setDefaultQuality (quality);
+            else
+                std::cerr << "Unknown stretch quality: " << name << " (use low, medium or high)" << std::endl;
+        }
+
+        // Test a deck outside the DJ's mix, without opening a window (exit code 0 if it passes)
+        if (commandLine.contains ("--test-decks"))
+        {
+            setApplicationReturnValue (ExtraDeckTest::run() ? 0 : 1);
+            quit();
+            return;
+        }
+
+        // Print the CPU cost of each time stretching quality profile, and exit
+        if (commandLine.contains ("--benchmark-stretch"))
+        {
+            std::cout << StretchProfiles::benchmark();
+            quit();
+            return;
+        }
+
+        // Run the real-time safety test on a library, without opening a window or an audio device (exit code 0 if it passes):
+        //   --rt-test --library /path/to/music
+        if (commandLine.contains ("--rt-test"))
+        {
+            startRealtimeTest();
+            return;
+        }
+
+        // Run mixes without opening a window or an audio device, either rendering one mix straight to a file:
+        //   --render=mix.flac --library=/path/to/music [--minutes=120] [--seed=1]
+        // or serving several independent mixes from the same library, to files or local sockets:
+        //   --serve --library=/path/to/music --sessions=12 (--output=/path/to/folder | --port=9000) [--minutes=120] [--seed=1]
+        // (each value can also be given after a space, e.g. --library /path/to/music)
+        if (commandLine.contains("--render") || commandLine.contains("--serve"))
+        {
+            startMixServer();
+            return;
+        }
+
         mainWindow.reset (new MainWindow (getApplicationName()));
     }
 
@@ -33,6 +134,15 @@ public:
         // Add your application's shutdown code here..
 
         mainWindow = nullptr; // (deletes our window)
+
+        stopTimer();
+        mixServer = nullptr; // (stops the sessions, if they haven't finished)
+        realtimeTest = nullptr; // (stops the test, if it hasn't finished)
+        testDataManager = nullptr;
+
+        // Now that all threads have stopped, write the complete trace
+        if (Tracer::isEnabled())
+            Tracer::writeTrace(Tracer::getDefaultFile());
     }
 
     //==============================================================================
@@ -50,6 +160,124 @@ public:
         // the other instance's command-line arguments were.
     }
 
+    //==============================================================================
+    /** Starts a headless mix server, using the options given on the command line (as "--option value" or "--option=value"). */
+    void startMixServer()
+    {
+        // Read from the parameter array, in which a path containing spaces is a single unquoted argument
+        juce::ArgumentList args ("AutoDJ", getCommandLineParameterArray());
+        juce::File workingDirectory = juce::File::getCurrentWorkingDirectory();
+        juce::Array<MixSessionConfig> sessions;
+
+        // Without a library, the working directory would be used instead
+        juce::String library = AutoDJ::getOptionValue (args, "--library");
+
+        if (library.isEmpty())
+        {
+            juce::Logger::writeToLog ("Mix server failed: no music library given (use --library /path/to/music)");
+            setApplicationReturnValue (1);
+            quit();
+            return;
+        }
+
+        int numSessions = args.containsOption ("--render") ? 1 : juce::jmax (1, AutoDJ::getOptionValue (args, "--sessions").getIntValue());
+
+        for (int i = 0; i < numSessions; i++)
+        {
+            MixSessionConfig config;
+            config.id = i + 1;
+            config.maxMinutes = AutoDJ::getOptionValue (args, "--minutes").getDoubleValue();
+
+            // Give each session a different seed, so they play different mixes
+            if (args.containsOption ("--seed"))
+                config.seed = AutoDJ::getOptionValue (args, "--seed").getLargeIntValue() + i;
+            else
+                config.seed = juce::Random::getSystemRandom().nextInt (std::numeric_limits<int>::max());
+
+            if (args.containsOption ("--render"))
+                config.output = AutoDJ::getOptionValue (args, "--render");
+            else if (args.containsOption ("--port"))
+                config.output = MIX_SESSION_STREAM_PREFIX + juce::String (AutoDJ::getOptionValue (args, "--port").getIntValue() + i);
+            else
+                config.output = workingDirectory.getChildFile (AutoDJ::getOptionValue (args, "--output")).getChildFile ("channel-" + juce::String (config.id) + ".flac").getFullPathName();
+
+            sessions.add (config);
+        }
+
+        mixServer.reset (new MixServer (workingDirectory.getChildFile (library), sessions));
+
+        if (!mixServer->initialise())
+        {
+            juce::Logger::writeToLog ("Mix server failed: could not open the music library");
+            setApplicationReturnValue (1);
+            quit();
+            return;
+        }
+
+        mixServer->startThread();
+        startTimer (MIX_SERVER_STATUS_INTERVAL_MS);
+    }
+
+    /** Starts the real-time safety test on the library given on the command line (as "--library path" or "--library=path"). */
+    void startRealtimeTest()
+    {
+        juce::ArgumentList args ("AutoDJ", getCommandLineParameterArray());
+        juce::String path = AutoDJ::getOptionValue (args, "--library");
+
+        // Without a library, the working directory would be tested instead
+        if (path.isEmpty())
+        {
+            juce::Logger::writeToLog ("Real-time safety test failed: no music library given (use --library /path/to/music)");
+            setApplicationReturnValue (1);
+            quit();
+            return;
+        }
+
+        juce::File library = juce::File::getCurrentWorkingDirectory().getChildFile (path);
+
+        // There's no UI, so there's no Direction view to update
+        testDataManager.reset (new DataManager());
+
+        if (!testDataManager->initialise (library, nullptr))
+        {
+            juce::Logger::writeToLog ("Real-time safety test failed: could not open the music library");
+            setApplicationReturnValue (1);
+            quit();
+            return;
+        }
+
+        realtimeTest.reset (new RealtimeSafetyTest (testDataManager.get()));
+        realtimeTest->startThread();
+        startTimer (REALTIME_TEST_POLL_INTERVAL_MS);
+    }
+
+    void timerCallback() override
+    {
+        // Print the real-time safety test's report once it has finished, and quit
+        if (realtimeTest != nullptr)
+        {
+            if (realtimeTest->isFinished())
+            {
+                stopTimer();
+                juce::Logger::writeToLog (realtimeTest->getReport());
+                setApplicationReturnValue (realtimeTest->hasPassed() ? 0 : 1);
+                quit();
+            }
+
+            return;
+        }
+
+        // Print the progress of every session to the console, and quit once they have all finished
+        juce::Logger::writeToLog (mixServer->getStatus());
+
+        if (mixServer->isFinished())
+        {
+            stopTimer();
+            setApplicationReturnValue (mixServer->getStage() == ServerStage::finished ? 0 : 1);
+            quit();
+        }
+    }
+
     //==============================================================================
     /*
         This class implements the desktop window that contains an instance of
@@ -98,6 +326,9 @@ public:
 
 private:
     std::unique_ptr<MainWindow> mainWindow;
+    std::unique_ptr<MixServer> mixServer;
+    std::unique_ptr<DataManager> testDataManager;
+    std::unique_ptr<RealtimeSafetyTest> realtimeTest;
 };
 
 //==============================================================================
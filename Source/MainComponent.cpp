@@ -1,6 +1,7 @@
 #include "MainComponent.hpp"
 
 #include "CommonDefs.hpp"
+#include "Profiler.hpp"
 
 
 MainComponent::MainComponent() :
@@ -44,6 +45,9 @@ MainComponent::MainComponent() :
     // Pass the audio processor to the DJ
     dj->setAudioProcessor(audioProcessor.get());
     
+    // Render the mix ahead of the audio callback, so the callback only has to play it out
+    audioProcessor->startRenderAhead();
+    
     // Instantiate the Library view and add it as a child
     libraryView.reset(new LibraryView(dataManager.get()));
     addChildComponent(libraryView.get());
@@ -111,6 +115,10 @@ MainComponent::~MainComponent()
     
     // Shut down the JUCE audio device
     shutdownAudio();
+    
+    // If profiling was enabled, output the measurements taken during this session
+    if (Profiler::isEnabled())
+        DBG(Profiler::getReport());
 }
 
 
@@ -398,8 +406,11 @@ void MainComponent::chooseFolder()
         
         // Pass the directory to the data manager for parsing
         if (!dataManager->initialise(chooser.getResult(), directionView.get()))
-            // If the data manager says the directory is not valid, return
+        {
+            // If the database couldn't be initialised, show an error window and return
+            juce::AlertWindow::showMessageBox(juce::AlertWindow::WarningIcon, "Error", "Failed to initialise database.", "OK");
             return;
+        }
         
         // Enter the loading files state
         loadingFiles = true;
@@ -0,0 +1,49 @@
+//
+//  MixHandoff.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "MixHandoff.hpp"
+
+
+bool MixHandoff::push(const MixInfo& mix)
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(1, start1, size1, start2, size2);
+    
+    if (size1 + size2 == 0)
+        return false;
+    
+    mixes[(size1 > 0) ? start1 : start2] = mix;
+    fifo.finishedWrite(1);
+    
+    return true;
+}
+
+
+bool MixHandoff::peek(MixInfo& mix)
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(1, start1, size1, start2, size2);
+    
+    if (size1 + size2 == 0)
+        return false;
+    
+    // Don't call finishedRead(), so the mix stays in the queue
+    mix = mixes[(size1 > 0) ? start1 : start2];
+    
+    return true;
+}
+
+
+bool MixHandoff::pop()
+{
+    if (fifo.getNumReady() == 0)
+        return false;
+    
+    fifo.finishedRead(1);
+    
+    return true;
+}
@@ -0,0 +1,72 @@
+//
+//  MixHandoff.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef MixHandoff_hpp
+#define MixHandoff_hpp
+
+#include <JuceHeader.h>
+#include "MixInfo.hpp"
+
+
+#define MIX_HANDOFF_SIZE (8) ///< Maximum number of prepared mixes that can be waiting for the decks
+
+
+/**
+ Wait-free single-producer/single-consumer queue of prepared mixes, which passes them from the DJ thread to the audio thread.
+ The producer (DJ thread) only calls push(), and the consumer (audio thread) only calls peek() and pop().
+ Neither side ever blocks or allocates, so the audio thread never has to wait for the DJ.
+ 
+ Once pushed, a mix can't be taken back by the producer - so anything that might be retracted (e.g. the final mix,
+ see ArtificialDJ) must be held back until it is certain.
+ */
+class MixHandoff
+{
+public:
+    
+    /** Constructor. */
+    MixHandoff() {}
+    
+    /** Destructor. */
+    ~MixHandoff() {}
+    
+    /** Adds a prepared mix to the back of the queue. Only call from the producer thread.
+     
+     @param[in] mix Mix to hand to the decks
+     
+     @return False if the queue is full, in which case the mix is not added */
+    bool push(const MixInfo& mix);
+    
+    /** Copies the mix at the front of the queue, without removing it. Only call from the consumer thread.
+     
+     @param[out] mix Mix at the front of the queue
+     
+     @return False if the queue is empty, in which case the output is unchanged */
+    bool peek(MixInfo& mix);
+    
+    /** Removes the mix at the front of the queue. Only call from the consumer thread.
+     
+     @return False if the queue was empty */
+    bool pop();
+    
+    /** Fetches the number of mixes in the queue. Can be called from any thread.
+     
+     @return Number of mixes waiting to be played (including the one currently playing, until it is popped) */
+    int getNumReady() { return fifo.getNumReady(); }
+    
+    /** Empties the queue. Only call when neither the producer nor the consumer is running. */
+    void reset() { fifo.reset(); }
+    
+private:
+    
+    juce::AbstractFifo fifo { MIX_HANDOFF_SIZE }; ///< Lock-free FIFO that manages the read/write positions in mixes
+    MixInfo mixes[MIX_HANDOFF_SIZE]; ///< Storage for the queued mixes
+    
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MixHandoff) ///< JUCE macro to add a memory leak detector
+};
+
+#endif /* MixHandoff_hpp */
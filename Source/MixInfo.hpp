@@ -12,13 +12,17 @@
 #include <JuceHeader.h>
 
 
+#define MIX_ID_NONE (-1) ///< ID of an empty mix, i.e. before the first mix or after the last
+#define MIX_ID_HOLD (-2) ///< ID of a placeholder mix, used to hold the leading track while the next mix isn't ready (see ArtificialDJ::getNextMix)
+
+
 /**
  Holds all the mixing decisions related to a single DJ transition.
  */
 typedef struct MixInfo {
-    int id = -1; ///< Unique ID of the transition
-    TrackInfo* leadingTrack; ///< Pointer to information of track to be mixed out
-    TrackInfo* nextTrack; ///< Pointer to information of new track to be mixed in
+    int id = MIX_ID_NONE; ///< Unique ID of the transition
+    TrackInfo* leadingTrack = nullptr; ///< Pointer to information of track to be mixed out
+    TrackInfo* nextTrack = nullptr; ///< Pointer to information of new track to be mixed in
     juce::AudioBuffer<float>* nextTrackAudio = nullptr; ///< Pointer to audio data for the track to be mixed in
     int leaderStart = 0; ///< Position / audio sample in leading track where mix begins
     int leaderEnd = 0; ///< Position / audio sample in leading track where mix finishes
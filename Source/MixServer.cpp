@@ -0,0 +1,176 @@
+//
+//  MixServer.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "MixServer.hpp"
+
+#include "CommonDefs.hpp"
+#include "Profiler.hpp"
+
+
+MixServer::MixServer(juce::File folder, const juce::Array<MixSessionConfig>& configs) :
+    juce::Thread("MixServer"), musicFolder(folder), sessionConfigs(configs)
+{
+    dataManager.reset(new DataManager());
+    
+    int numRenderWorkers = getNumRenderWorkers(sessionConfigs.size());
+    
+    for (auto& config : sessionConfigs)
+        config.numRenderWorkers = numRenderWorkers;
+}
+
+
+int MixServer::getNumRenderWorkers(int numSessions)
+{
+    // Each session's own thread renders too, so only the cores beyond one per session are shared out
+    int numSpare = juce::SystemStats::getNumCpus() - numSessions;
+    
+    return juce::jlimit(0, NUM_DECKS - 1, numSpare / juce::jmax(1, numSessions));
+}
+
+
+MixServer::~MixServer()
+{
+    stopThread(10000);
+    
+    // Stop the sessions before the library they're using
+    const juce::ScopedLock sl(lock);
+    sessions.clear();
+}
+
+
+bool MixServer::initialise()
+{
+    // There's no UI, so there's no Direction view to update
+    if (!dataManager->initialise(musicFolder, nullptr))
+    {
+        stage.store((int)ServerStage::failed);
+        return false;
+    }
+    
+    return true;
+}
+
+
+void MixServer::run()
+{
+    Profiler::nameCurrentThread("MixServer");
+    
+    if (!prepareLibrary())
+    {
+        stage.store((int)ServerStage::failed);
+        return;
+    }
+    
+    {
+        const juce::ScopedLock sl(lock);
+        
+        for (auto& config : sessionConfigs)
+            sessions.add(new MixSession(dataManager.get(), config))->startThread();
+    }
+    
+    stage.store((int)ServerStage::running);
+    
+    bool finished = false;
+    bool failed = false;
+    
+    // Wait for every session to finish (the lock is only held while checking, so the status can be read meanwhile)
+    while (!finished)
+    {
+        if (threadShouldExit())
+        {
+            stage.store((int)ServerStage::failed);
+            return;
+        }
+        
+        wait(100);
+        
+        const juce::ScopedLock sl(lock);
+        
+        finished = true;
+        failed = false;
+        
+        for (auto* session : sessions)
+        {
+            if (!session->isFinished())
+                finished = false;
+            else if (session->hasFailed())
+                failed = true;
+        }
+    }
+    
+    stage.store((int)(failed ? ServerStage::failed : ServerStage::finished));
+}
+
+
+juce::String MixServer::getStatus()
+{
+    double progress = 0.0;
+    
+    switch (getStage())
+    {
+        case ServerStage::loadingLibrary:
+            return "Loading library...";
+        case ServerStage::analysingLibrary:
+            dataManager->isAnalysisFinished(progress);
+            return "Analysing library: " + juce::String(juce::roundToInt(progress * 100.0)) + "%";
+        default:
+            break;
+    }
+    
+    juce::String status;
+    
+    {
+        const juce::ScopedLock sl(lock);
+        
+        for (auto* session : sessions)
+            status << session->getStatus() << "\n";
+    }
+    
+    int numBuffers;
+    size_t bytes = dataManager->getSharedAudioBytes(numBuffers);
+    
+    status << "Shared audio: " << numBuffers << " tracks, " << juce::File::descriptionOfSizeInBytes(juce::int64(bytes));
+    
+    if (getStage() == ServerStage::failed)
+        status << "\nFailed";
+    
+    return status;
+}
+
+
+bool MixServer::prepareLibrary()
+{
+    double progress;
+    
+    // Wait for the files in the library to be parsed
+    while (dataManager->isLoading(progress))
+    {
+        if (threadShouldExit())
+            return false;
+        
+        sleep(100);
+    }
+    
+    if (!dataManager->isDirectoryValid())
+    {
+        DBG("Mix server failed: the music folder needs at least " << NUM_TRACKS_MIN << " valid tracks");
+        return false;
+    }
+    
+    // Wait for analysis of the whole library, so the DJs can choose from every track
+    stage.store((int)ServerStage::analysingLibrary);
+    
+    while (!dataManager->isAnalysisFinished())
+    {
+        if (threadShouldExit())
+            return false;
+        
+        sleep(100);
+    }
+    
+    return dataManager->canStartPlaying();
+}
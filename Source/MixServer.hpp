@@ -0,0 +1,106 @@
+//
+//  MixServer.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef MixServer_hpp
+#define MixServer_hpp
+
+#include <JuceHeader.h>
+#include "DataManager.hpp"
+#include "MixSession.hpp"
+
+
+#define MIX_SERVER_STATUS_INTERVAL_MS (5000) ///< Interval at which the server status is printed to the console
+
+
+/** Stages of a mix server's lifetime. */
+enum class ServerStage : int
+{
+    loadingLibrary,
+    analysingLibrary,
+    running,
+    finished,
+    failed
+};
+
+
+/**
+ Hosts any number of independent DJ sessions (see MixSession) without a UI or audio device, e.g. to render mixes
+ to files offline, or to stream several channels from one library.
+ 
+ The library is loaded and analysed once, and shared by every session: they all read the same track information,
+ and share decoded audio whenever they play the same track (see DataManager::loadAudio()). Each session has its own DJ,
+ decks, random seed, track history and output, so they don't affect each other.
+ 
+ The CPU cores beyond one per session are shared out between the sessions, to render their decks in parallel
+ (e.g. a single render gets NUM_DECKS - 1 helper threads, if there are enough cores).
+ */
+class MixServer : public juce::Thread
+{
+public:
+    
+    /** Constructor.
+     
+     @param[in] musicFolder Music library to mix from (analysed first, if necessary)
+     @param[in] sessions Settings for each session to run */
+    MixServer(juce::File musicFolder, const juce::Array<MixSessionConfig>& sessions);
+    
+    /** Destructor. */
+    ~MixServer();
+    
+    /** Starts loading the music library. Call this before startThread().
+     
+     @return False if the library's database couldn't be initialised */
+    bool initialise();
+    
+    /** Loads the library, then runs every session until they have all finished - call startThread() rather than calling this directly. */
+    void run() override;
+    
+    /** Fetches the current stage of the server.
+     
+     @return Server stage */
+    ServerStage getStage() { return (ServerStage)stage.load(); }
+    
+    /** Checks whether the server has finished (successfully or not).
+     
+     @return Result of the check */
+    bool isFinished() { return getStage() == ServerStage::finished || getStage() == ServerStage::failed; }
+    
+    /** Generates a summary of the progress of every session, for the console.
+     
+     @return Status text (one line per session) */
+    juce::String getStatus();
+    
+    /** Calculates the number of threads each session gets to help render its decks, sharing out the spare CPU cores.
+     
+     @param[in] numSessions Number of sessions running at once
+     
+     @return Number of render workers per session (see DeckRenderGroup) */
+    static int getNumRenderWorkers(int numSessions);
+    
+private:
+    
+    /** Waits for the music library to be loaded and analysed.
+     
+     @return False if the library couldn't be loaded, or doesn't have enough valid tracks */
+    bool prepareLibrary();
+    
+    
+    juce::File musicFolder; ///< Music library to mix from
+    juce::Array<MixSessionConfig> sessionConfigs; ///< Settings for each session
+    
+    std::unique_ptr<DataManager> dataManager; ///< Track data manager for the library, shared by all sessions
+    
+    juce::CriticalSection lock; ///< RAII lock to ensure thread-safety while acessing the sessions array
+    juce::OwnedArray<MixSession> sessions; ///< Running sessions (declared after dataManager, so they are deleted first)
+    
+    std::atomic<int> stage = (int)ServerStage::loadingLibrary; ///< Current stage of the server (see ServerStage)
+    
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MixServer) ///< JUCE macro to add a memory leak detector
+};
+
+#endif /* MixServer_hpp */
@@ -0,0 +1,271 @@
+//
+//  MixSession.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "MixSession.hpp"
+
+#include "ArtificialDJ.hpp"
+#include "AudioProcessor.hpp"
+
+
+MixSession::MixSession(DataManager* dm, const MixSessionConfig& c) :
+    juce::Thread("MixSession " + juce::String(c.id)), dataManager(dm), config(c)
+{
+    maxSamples = juce::int64(config.maxMinutes * 60.0 * SUPPORTED_SAMPLERATE);
+}
+
+
+void MixSession::run()
+{
+    if (openOutput())
+        render();
+    else
+        failed.store(true);
+    
+    // Deleting the writer flushes the remaining audio and closes the file
+    writer.reset();
+    writerThread.stopThread(10000);
+    
+    connection.reset();
+    listener.reset();
+    
+    if (threadShouldExit())
+        failed.store(true);
+    
+    finished.store(true);
+}
+
+
+double MixSession::getRealtimeMultiple()
+{
+    juce::uint32 start = renderStartMs.load();
+    juce::uint32 end = renderEndMs.load();
+    
+    if (start == 0)
+        return 0.0;
+    
+    if (end == 0)
+        end = juce::Time::getMillisecondCounter();
+    
+    double elapsedSeconds = double(end - start) / 1000.0;
+    
+    return (elapsedSeconds > 0.0) ? getRenderedSeconds() / elapsedSeconds : 0.0;
+}
+
+
+juce::String MixSession::getStatus()
+{
+    juce::String status = "Session " + juce::String(config.id) + " (" + config.output + "): ";
+    
+    if (isFinished() && hasFailed())
+        return status + "failed";
+    
+    if (waitingForListener.load())
+        return status + "waiting for a listener";
+    
+    status << "rendered " << AutoDJ::getLengthString(juce::roundToInt(getRenderedSeconds()))
+           << " (" << numMixes.load() << " mixes) at " << juce::String(getRealtimeMultiple(), 1) << "x real time";
+    
+    if (isFinished())
+        status << ", finished";
+    
+    return status;
+}
+
+
+bool MixSession::openOutput()
+{
+    if (isStream())
+    {
+        int port = config.output.fromFirstOccurrenceOf(MIX_SESSION_STREAM_PREFIX, false, false).getIntValue();
+        
+        // Only accept local connections
+        listener.reset(new juce::StreamingSocket());
+        
+        if (!listener->createListener(port, "127.0.0.1"))
+        {
+            DBG("Mix session " << config.id << " failed: could not listen on port " << port);
+            return false;
+        }
+        
+        streamBuffer.allocate(2 * MIX_SESSION_BLOCK_SIZE, true);
+        
+        return true;
+    }
+    
+    juce::File outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(config.output);
+    std::unique_ptr<juce::AudioFormat> format;
+    
+    if (outputFile.hasFileExtension("flac"))
+        format.reset(new juce::FlacAudioFormat());
+    else
+        format.reset(new juce::WavAudioFormat());
+    
+    outputFile.deleteFile();
+    std::unique_ptr<juce::FileOutputStream> stream(outputFile.createOutputStream());
+    
+    if (stream == nullptr)
+    {
+        DBG("Mix session " << config.id << " failed: could not create " << outputFile.getFullPathName());
+        return false;
+    }
+    
+    juce::AudioFormatWriter* fileWriter = format->createWriterFor(stream.get(), SUPPORTED_SAMPLERATE, 2, MIX_SESSION_BIT_DEPTH, {}, 0);
+    
+    if (fileWriter == nullptr)
+    {
+        jassert(false); // Format doesn't support the output settings
+        return false;
+    }
+    
+    // The writer now owns the stream
+    stream.release();
+    
+    writerThread.startThread(3);
+    writer.reset(new juce::AudioFormatWriter::ThreadedWriter(fileWriter, writerThread, MIX_SESSION_WRITER_FIFO_SIZE));
+    
+    return true;
+}
+
+
+void MixSession::render()
+{
+    // Use a separate DJ and audio processor, exactly as the app does, but driven by this thread instead of an audio device
+    // The DJ keeps its own history, so it doesn't affect any other session using the library
+    ArtificialDJ dj(dataManager, false);
+    // The decks are rendered in parallel if there are cores to spare (see MixServer::getNumRenderWorkers())
+    AudioProcessor processor(dataManager, &dj, MIX_SESSION_BLOCK_SIZE, config.numRenderWorkers);
+    dj.setAudioProcessor(&processor);
+    
+    if (config.seed >= 0)
+        dj.setSeed((unsigned int)config.seed);
+    
+    // Files render much faster than real time, so prepare mixes as early as the DJ's queue allows
+    // (streams play in real time, so they keep the default horizon, which holds less decoded audio)
+    if (!isStream())
+        dj.setDecodeHorizon(MIX_SESSION_DECODE_HORIZON_S);
+    
+    juce::AudioBuffer<float> buffer(2, MIX_SESSION_BLOCK_SIZE);
+    juce::AudioSourceChannelInfo outputBuffer(&buffer, 0, MIX_SESSION_BLOCK_SIZE);
+    
+    // Start the DJ, which initialises the mix on its own thread, and starts playback once ready
+    dj.playPause();
+    
+    while (!dj.isInitialised() && !threadShouldExit())
+        sleep(10);
+    
+    renderStartMs.store(juce::Time::getMillisecondCounter());
+    
+    int currentMixId = MIX_ID_NONE;
+    juce::uint32 waitStart = juce::Time::getMillisecondCounter();
+    
+    while (!threadShouldExit() && !processor.mixEnded())
+    {
+        if (maxSamples > 0 && numSamplesRendered.load() >= maxSamples)
+            break;
+        
+        // If the decks have caught up with the DJ, wait for it to prepare the next mix, rather than holding the leading track
+        // (a stream plays in real time, like a live DJ, so it holds the leading track as the app would)
+        if (!isStream() && processor.getLeaderMixId() == MIX_ID_HOLD && !dj.isMixReady()
+            && juce::Time::getMillisecondCounter() - waitStart < MIX_SESSION_MIX_TIMEOUT_MS)
+        {
+            dj.notify();
+            sleep(5);
+            continue;
+        }
+        
+        waitStart = juce::Time::getMillisecondCounter();
+        
+        processor.getNextAudioBlock(outputBuffer);
+        write(buffer);
+        
+        numSamplesRendered += MIX_SESSION_BLOCK_SIZE;
+        
+        // Count the number of transitions rendered (a hold isn't a transition, so it isn't counted)
+        int mixId = processor.getLeaderMixId();
+        
+        if (mixId != currentMixId && mixId != MIX_ID_HOLD)
+        {
+            currentMixId = mixId;
+            numMixes += 1;
+        }
+    }
+    
+    renderEndMs.store(juce::Time::getMillisecondCounter());
+    
+    // Stop the DJ and release the audio it decoded
+    dj.reset();
+}
+
+
+void MixSession::write(const juce::AudioBuffer<float>& buffer)
+{
+    if (isStream())
+    {
+        writeStream(buffer);
+        return;
+    }
+    
+    // If the writer thread falls behind, wait for it to make space
+    while (!writer->write(buffer.getArrayOfReadPointers(), buffer.getNumSamples()))
+    {
+        if (threadShouldExit())
+            return;
+        
+        sleep(5);
+    }
+}
+
+
+void MixSession::writeStream(const juce::AudioBuffer<float>& buffer)
+{
+    int numSamples = buffer.getNumSamples();
+    
+    // Interleave the channels as little-endian 16-bit samples
+    for (int channel = 0; channel < 2; channel++)
+        juce::AudioDataConverters::convertFloatToInt16LE(buffer.getReadPointer(channel), streamBuffer.get() + channel, numSamples, 2 * sizeof(juce::int16));
+    
+    int numBytes = 2 * numSamples * sizeof(juce::int16);
+    
+    while (!threadShouldExit())
+    {
+        // If there's no listener, wait for one to connect
+        if (connection == nullptr)
+        {
+            waitingForListener.store(true);
+            
+            if (listener->waitUntilReady(true, 100) != 1)
+                continue;
+            
+            connection.reset(listener->waitForNextConnection());
+            
+            if (connection == nullptr)
+                continue;
+            
+            waitingForListener.store(false);
+            
+            // Pace the stream from the point the listener connected
+            streamStartMs = juce::Time::getMillisecondCounter();
+            streamStartSamples = numSamplesRendered.load();
+        }
+        
+        // If the listener has disconnected, drop it and wait for the next one (the block is sent to them instead)
+        if (connection->write(streamBuffer.get(), numBytes) != numBytes)
+        {
+            connection.reset();
+            continue;
+        }
+        
+        break;
+    }
+    
+    // Stay no more than MIX_SESSION_STREAM_LEAD_MS ahead of real time
+    juce::int64 sentMs = (numSamplesRendered.load() + numSamples - streamStartSamples) * 1000 / SUPPORTED_SAMPLERATE;
+    juce::int64 aheadMs = sentMs - juce::int64(juce::Time::getMillisecondCounter() - streamStartMs) - MIX_SESSION_STREAM_LEAD_MS;
+    
+    if (aheadMs > 0 && !threadShouldExit())
+        sleep(int(aheadMs));
+}
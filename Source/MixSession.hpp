@@ -0,0 +1,142 @@
+//
+//  MixSession.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef MixSession_hpp
+#define MixSession_hpp
+
+#include <JuceHeader.h>
+#include "DataManager.hpp"
+
+
+#define MIX_SESSION_BLOCK_SIZE (4096) ///< Number of samples processed at a time (larger than a device buffer, since there's no deadline)
+#define MIX_SESSION_BIT_DEPTH (24) ///< Bit depth of output files
+#define MIX_SESSION_DECODE_HORIZON_S (600.0) ///< DJ decode horizon when rendering to a file, so mixes are prepared as early as possible
+#define MIX_SESSION_WRITER_FIFO_SIZE (1 << 20) ///< Number of samples buffered for the file writer thread (~24s)
+#define MIX_SESSION_MIX_TIMEOUT_MS (60000) ///< Maximum time to wait for the DJ to prepare the next mix, before the decks are held
+#define MIX_SESSION_STREAM_LEAD_MS (500) ///< How far ahead of real time a stream is sent, to absorb scheduling jitter
+#define MIX_SESSION_STREAM_PREFIX ("tcp:") ///< Output prefix which selects streaming to a local socket, e.g. "tcp:9000"
+
+
+/** Settings for a single mix session. */
+typedef struct MixSessionConfig
+{
+    int id = 0; ///< Number of the session, shown in its status
+    juce::String output; ///< Audio file to write (".flac" for FLAC, otherwise WAV), or MIX_SESSION_STREAM_PREFIX followed by a port number
+    juce::int64 seed = -1; ///< Seed for the DJ's random decisions, or -1 to seed from the clock
+    double maxMinutes = 0.0; ///< Maximum length of the mix, or 0 to mix until the library runs out
+    int numRenderWorkers = 0; ///< Number of threads to help render the decks (see DeckRenderGroup), set by MixServer from the number of cores
+} MixSessionConfig;
+
+
+/**
+ Runs one complete DJ performance - its own ArtificialDJ and AudioProcessor - without an audio device.
+ 
+ The session keeps its own track history, and only reads the library, so any number of sessions can mix from one
+ DataManager at once (see MixServer). Decoded audio is shared between sessions playing the same track (see DataManager::loadAudio()).
+ 
+ The output is either:
+ - A file, rendered as fast as the CPU allows and encoded on a separate writer thread.
+ - A local TCP socket, streamed as raw interleaved 16-bit stereo PCM at SUPPORTED_SAMPLERATE, in real time.
+   The session waits for a listener to connect, and pauses whenever there is none.
+ 
+ The DJ's schedule is driven by the deck positions, so whenever the decks of a file session catch up with it, rendering waits
+ for the next mix instead of holding the leading track (unless it takes longer than MIX_SESSION_MIX_TIMEOUT_MS).
+ A stream can't stop for the DJ, so it holds the leading track on a loop, as the app does.
+ */
+class MixSession : public juce::Thread
+{
+public:
+    
+    /** Constructor.
+     
+     @param[in] dataManager Pointer to the track data manager, which must have finished loading the library
+     @param[in] config Settings for this session */
+    MixSession(DataManager* dataManager, const MixSessionConfig& config);
+    
+    /** Destructor. */
+    ~MixSession() { stopThread(10000); }
+    
+    /** Runs the session - call startThread() rather than calling this directly. */
+    void run() override;
+    
+    /** Checks whether the session has finished (successfully or not).
+     
+     @return Result of the check */
+    bool isFinished() { return finished.load(); }
+    
+    /** Checks whether the session failed, e.g. because its output couldn't be opened (only valid once finished).
+     
+     @return Result of the check */
+    bool hasFailed() { return failed.load(); }
+    
+    /** Fetches the duration of audio rendered so far.
+     
+     @return Rendered duration, in seconds */
+    double getRenderedSeconds() { return double(numSamplesRendered.load()) / SUPPORTED_SAMPLERATE; }
+    
+    /** Fetches the render speed, as a multiple of real time (e.g. 20.0 means a minute of audio takes 3 seconds).
+     
+     @return Speed of rendering since it started, or 0 if it hasn't started */
+    double getRealtimeMultiple();
+    
+    /** Generates a one-line summary of the session's progress, for the console.
+     
+     @return Status text */
+    juce::String getStatus();
+    
+private:
+    
+    /** Checks whether the output is a socket stream, rather than a file.
+     
+     @return Result of the check */
+    bool isStream() { return config.output.startsWith(MIX_SESSION_STREAM_PREFIX); }
+    
+    /** Creates the output file writer, or the socket listener for a stream.
+     
+     @return False if the output couldn't be opened */
+    bool openOutput();
+    
+    /** Runs the DJ and decks, writing the mix to the output. */
+    void render();
+    
+    /** Passes a rendered block to the output, waiting for the writer thread (file) or real time (stream) as necessary.
+     
+     @param[in] buffer Rendered audio */
+    void write(const juce::AudioBuffer<float>& buffer);
+    
+    /** Sends a rendered block to the stream's listener, waiting for one to connect if necessary.
+     
+     @param[in] buffer Rendered audio */
+    void writeStream(const juce::AudioBuffer<float>& buffer);
+    
+    
+    DataManager* dataManager = nullptr; ///< Pointer to the shared track data manager
+    MixSessionConfig config; ///< Settings for this session
+    juce::int64 maxSamples = 0; ///< Maximum length of the mix in samples, or 0 for no limit
+    
+    juce::TimeSliceThread writerThread {"MixSessionWriter"}; ///< Thread on which the output file is encoded
+    std::unique_ptr<juce::AudioFormatWriter::ThreadedWriter> writer; ///< Buffers rendered audio for the writer thread
+    
+    std::unique_ptr<juce::StreamingSocket> listener; ///< Socket which accepts stream listeners
+    std::unique_ptr<juce::StreamingSocket> connection; ///< Socket connected to the current stream listener
+    juce::HeapBlock<juce::int16> streamBuffer; ///< Interleaved 16-bit samples waiting to be sent
+    juce::uint32 streamStartMs = 0; ///< Time at which the current listener connected (millisecond counter)
+    juce::int64 streamStartSamples = 0; ///< Number of samples rendered when the current listener connected
+    
+    std::atomic<bool> finished = false; ///< Indicates that the session has finished
+    std::atomic<bool> failed = false; ///< Indicates that the session failed
+    std::atomic<bool> waitingForListener = false; ///< Indicates that a stream is waiting for a listener to connect
+    std::atomic<juce::int64> numSamplesRendered {0}; ///< Number of samples rendered so far
+    std::atomic<int> numMixes {0}; ///< Number of transitions rendered so far
+    std::atomic<juce::uint32> renderStartMs {0}; ///< Time at which rendering started (millisecond counter)
+    std::atomic<juce::uint32> renderEndMs {0}; ///< Time at which rendering finished (millisecond counter), or 0 if it hasn't
+    
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MixSession) ///< JUCE macro to add a memory leak detector
+};
+
+#endif /* MixSession_hpp */
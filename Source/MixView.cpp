@@ -12,10 +12,8 @@
 
 MixView::MixView(TrackProcessor** processors)
 {
-    decks.add(new DeckComponent(0, processors[0]));
-    decks.add(new DeckComponent(1, processors[1]));
-    addAndMakeVisible(decks.getUnchecked(0));
-    addAndMakeVisible(decks.getUnchecked(1));
+    for (int i = 0; i < NUM_DECKS; i++)
+        addAndMakeVisible(decks.add(new DeckComponent(i, processors[i])));
     
     startTimer(33); // 33ms = 30.3Hz
 }
@@ -23,11 +21,9 @@ MixView::MixView(TrackProcessor** processors)
 
 void MixView::resized()
 {
-    decks.getUnchecked(0)->setSize(getWidth(), getHeight()/2);
-    decks.getUnchecked(1)->setSize(getWidth(), getHeight()/2);
-    
-    decks.getUnchecked(0)->setTopLeftPosition(0, 0);
-    decks.getUnchecked(1)->setTopLeftPosition(0, getHeight()/2);
+    // Stack the decks vertically, sharing the height equally
+    for (int i = 0; i < decks.size(); i++)
+        decks.getUnchecked(i)->setBounds(0, i * getHeight() / decks.size(), getWidth(), getHeight() / decks.size());
 }
 
 
@@ -37,11 +33,11 @@ void MixView::hiResTimerCallback()
     // This is so that the decks are as synchronised as possible
     // (If this was done in the update() function, the audio thread playhead would
     // have moved by the time the second deck updates)
-    decks.getUnchecked(0)->logPlayheadPosition();
-    decks.getUnchecked(1)->logPlayheadPosition();
+    for (auto* deck : decks)
+        deck->logPlayheadPosition();
     
-    decks.getUnchecked(0)->update();
-    decks.getUnchecked(1)->update();
+    for (auto* deck : decks)
+        deck->update();
     
     juce::MessageManager::callAsync(std::function<void()>([this]() {
         repaint();
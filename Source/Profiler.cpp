@@ -0,0 +1,576 @@
+//
+//  Profiler.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "Profiler.hpp"
+#include "RealtimeSafety.hpp"
+
+#include <map>
+
+#if JUCE_MSVC
+#include <intrin.h>
+#endif
+
+
+/** Measurements for a single zone on a single thread. Only the owning thread writes to these. */
+struct ProfilerNode
+{
+    ProfilerNode()
+    {
+        for (auto& bucket : buckets)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+    
+    const char* name = nullptr; ///< Name of the zone
+    int parent = -1; ///< Index of the enclosing zone, or -1 if this is a top-level zone
+    
+    std::atomic<juce::int64> count {0}; ///< Number of times the zone was entered
+    std::atomic<juce::int64> totalTicks {0}; ///< Total time spent in the zone
+    std::atomic<juce::int64> maxTicks {0}; ///< Longest time spent in the zone
+    std::atomic<juce::uint32> buckets[PROFILER_NUM_BUCKETS]; ///< Histogram of durations (see getBucket())
+};
+
+
+/** All the zones that have been entered on a single thread. */
+struct ProfilerThread
+{
+    juce::String name; ///< Name of the thread, used in reports
+    std::atomic<bool> active {true}; ///< False once the thread has exited, so its slot can be reused by a new thread with the same name
+    
+    ProfilerNode nodes[PROFILER_MAX_ZONES]; ///< Every zone that has been entered on this thread, in the order they were first entered
+    std::atomic<int> numNodes {0}; ///< Number of valid zones in the nodes array
+    
+    std::atomic<juce::uint32> resetRequested {0}; ///< Incremented by Profiler::reset(), to ask the owning thread to clear its zones
+    std::atomic<juce::uint32> resetDone {0}; ///< Value of resetRequested when the zones were last cleared
+    
+    int stack[PROFILER_MAX_DEPTH]; ///< Indices of the zones currently entered, from outermost to innermost
+    int depth = 0; ///< Number of zones currently entered
+};
+
+
+/** Thread-local handle to the calling thread's profiler data, which marks it as inactive when the thread exits. */
+struct ProfilerThreadHandle
+{
+    ~ProfilerThreadHandle()
+    {
+        if (thread != nullptr)
+            thread->active.store(false);
+    }
+    
+    ProfilerThread* thread = nullptr; ///< Profiler data for this thread, or nullptr if not yet registered
+    const char* requestedName = nullptr; ///< Name given by Profiler::nameCurrentThread(), if any
+    bool registrationFailed = false; ///< Indicates that too many threads were registered, so this one can't be profiled
+};
+
+
+/** Combined measurements of one or more zones, used to generate reports. */
+struct ProfilerAccumulator
+{
+    juce::int64 count = 0;
+    juce::int64 totalTicks = 0;
+    juce::int64 maxTicks = 0;
+    juce::uint64 buckets[PROFILER_NUM_BUCKETS] = {};
+};
+
+
+#if JUCE_DEBUG
+std::atomic<bool> profilerEnabled {true};
+#else
+std::atomic<bool> profilerEnabled {false};
+#endif
+
+std::unique_ptr<ProfilerThread> profilerThreads[PROFILER_MAX_THREADS];
+std::atomic<int> numProfilerThreads {0};
+juce::CriticalSection profilerLock; // Only taken when registering threads and generating reports, never when timing zones
+
+thread_local ProfilerThreadHandle currentProfilerThread;
+
+
+/** Converts a number of high-resolution ticks to nanoseconds. */
+static double ticksToNanoseconds(juce::int64 ticks)
+{
+    static const double nanosecondsPerTick = 1.0e9 / juce::Time::getHighResolutionTicksPerSecond();
+    return ticks * nanosecondsPerTick;
+}
+
+
+/** Finds the index of the highest set bit of a (non-zero) value. */
+static int getHighestBit(juce::uint64 value)
+{
+#if JUCE_MSVC
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return (int)index;
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+
+/** Finds the histogram bucket for a duration.
+ Each doubling of duration is split into PROFILER_SUB_BUCKETS (4) buckets, using the 2 bits below the highest set bit. */
+static int getBucket(juce::uint64 nanoseconds)
+{
+    // Durations below 4ns are stored exactly
+    if (nanoseconds < PROFILER_SUB_BUCKETS)
+        return (int)nanoseconds;
+    
+    int octave = getHighestBit(nanoseconds);
+    int subBucket = (int)((nanoseconds >> (octave - 2)) & (PROFILER_SUB_BUCKETS - 1));
+    
+    return juce::jmin(octave*PROFILER_SUB_BUCKETS + subBucket, PROFILER_NUM_BUCKETS - 1);
+}
+
+
+/** Finds the longest duration that would be placed in a histogram bucket (the inverse of getBucket()). */
+static double getBucketUpperBound(int bucket)
+{
+    int octave = bucket / PROFILER_SUB_BUCKETS;
+    int subBucket = bucket % PROFILER_SUB_BUCKETS;
+    
+    // The first buckets store durations exactly (see getBucket()) and the next few are unused
+    if (octave < 2)
+        return bucket;
+    
+    double width = double(juce::uint64(1) << (octave - 2));
+    
+    return (PROFILER_SUB_BUCKETS + subBucket + 1) * width - 1.0;
+}
+
+
+/** Fetches the profiler data for the calling thread, registering it on first use.
+ 
+ @return Thread data, or nullptr if the maximum number of threads has been reached */
+static ProfilerThread* getCurrentThread()
+{
+    if (currentProfilerThread.thread != nullptr)
+        return currentProfilerThread.thread;
+    
+    if (currentProfilerThread.registrationFailed)
+        return nullptr;
+    
+    // Registration allocates, but only happens once per thread, so don't flag it (see RealtimeSafety)
+    RealtimeSafety::ScopedAllow allowAllocation;
+    
+    juce::String name = Profiler::getCurrentThreadName();
+    
+    const juce::ScopedLock sl(profilerLock);
+    
+    int numThreads = numProfilerThreads.load();
+    
+    // If a thread with the same name has exited, reuse its data, so that threads which are restarted (e.g. for each analysis run)
+    // accumulate into a single place rather than using up more slots
+    for (int i = 0; i < numThreads; i++)
+    {
+        ProfilerThread* thread = profilerThreads[i].get();
+        
+        if (!thread->active.load() && thread->name == name)
+        {
+            thread->depth = 0;
+            thread->active.store(true);
+            currentProfilerThread.thread = thread;
+            return thread;
+        }
+    }
+    
+    if (numThreads >= PROFILER_MAX_THREADS)
+    {
+        DBG("Profiler: too many threads, not profiling " << name);
+        currentProfilerThread.registrationFailed = true;
+        return nullptr;
+    }
+    
+    profilerThreads[numThreads].reset(new ProfilerThread());
+    profilerThreads[numThreads]->name = name;
+    currentProfilerThread.thread = profilerThreads[numThreads].get();
+    
+    // Publish the new thread, so that reports can see it
+    numProfilerThreads.store(numThreads + 1);
+    
+    return currentProfilerThread.thread;
+}
+
+
+/** Clears the measurements of every zone on a thread, but keeps the zones, since the thread might be inside them.
+ Only call this from the owning thread, or while holding profilerLock for a thread that has exited. */
+static void clearNodes(ProfilerThread* thread)
+{
+    for (int i = 0; i < thread->numNodes.load(); i++)
+    {
+        ProfilerNode& node = thread->nodes[i];
+        
+        node.count.store(0, std::memory_order_relaxed);
+        node.totalTicks.store(0, std::memory_order_relaxed);
+        node.maxTicks.store(0, std::memory_order_relaxed);
+        
+        for (auto& bucket : node.buckets)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+    
+    thread->resetDone.store(thread->resetRequested.load(), std::memory_order_release);
+}
+
+
+/** Checks whether a thread has measurements from before the last reset, which it hasn't cleared yet. */
+static bool isResetPending(ProfilerThread* thread)
+{
+    return thread->resetDone.load(std::memory_order_acquire) != thread->resetRequested.load(std::memory_order_relaxed);
+}
+
+
+/** Builds the full path of a zone, by walking up through its parents. */
+static juce::String getPath(ProfilerThread* thread, int node)
+{
+    juce::String path = thread->nodes[node].name;
+    
+    for (int parent = thread->nodes[node].parent; parent >= 0; parent = thread->nodes[parent].parent)
+        path = juce::String(thread->nodes[parent].name) + "/" + path;
+    
+    return path;
+}
+
+
+/** Adds the measurements of a zone to an accumulator. */
+static void accumulate(ProfilerAccumulator& result, ProfilerNode& node)
+{
+    result.count += node.count.load(std::memory_order_relaxed);
+    result.totalTicks += node.totalTicks.load(std::memory_order_relaxed);
+    result.maxTicks = juce::jmax(result.maxTicks, node.maxTicks.load(std::memory_order_relaxed));
+    
+    for (int i = 0; i < PROFILER_NUM_BUCKETS; i++)
+        result.buckets[i] += node.buckets[i].load(std::memory_order_relaxed);
+}
+
+
+/** Estimates a percentile from the histogram of an accumulator, in milliseconds. */
+static double getPercentile(const ProfilerAccumulator& result, double percentile, double maxNanoseconds)
+{
+    juce::uint64 histogramCount = 0;
+    for (auto bucket : result.buckets)
+        histogramCount += bucket;
+    
+    if (histogramCount == 0)
+        return 0.0;
+    
+    // Find the bucket containing the requested proportion of measurements
+    juce::uint64 target = juce::jmax(juce::uint64(1), juce::uint64(std::ceil(percentile * histogramCount)));
+    juce::uint64 cumulative = 0;
+    
+    for (int i = 0; i < PROFILER_NUM_BUCKETS; i++)
+    {
+        cumulative += result.buckets[i];
+        
+        // Use the upper bound of the bucket, but never report more than the actual maximum
+        if (cumulative >= target)
+            return juce::jmin(getBucketUpperBound(i), maxNanoseconds) / 1.0e6;
+    }
+    
+    return maxNanoseconds / 1.0e6;
+}
+
+
+/** Converts an accumulator into a set of statistics. */
+static ProfilerZoneStats getStatsFromAccumulator(const ProfilerAccumulator& result)
+{
+    ProfilerZoneStats stats;
+    
+    double maxNanoseconds = ticksToNanoseconds(result.maxTicks);
+    
+    stats.count = result.count;
+    stats.totalMs = ticksToNanoseconds(result.totalTicks) / 1.0e6;
+    stats.meanMs = (result.count > 0) ? stats.totalMs / result.count : 0.0;
+    stats.p50Ms = getPercentile(result, 0.5, maxNanoseconds);
+    stats.p95Ms = getPercentile(result, 0.95, maxNanoseconds);
+    stats.p99Ms = getPercentile(result, 0.99, maxNanoseconds);
+    stats.maxMs = maxNanoseconds / 1.0e6;
+    
+    return stats;
+}
+
+
+/** Converts a set of statistics to a JSON object. */
+static juce::var getStatsJson(const ProfilerZoneStats& stats)
+{
+    juce::DynamicObject::Ptr zone = new juce::DynamicObject();
+    
+    zone->setProperty("path", stats.path);
+    zone->setProperty("count", stats.count);
+    zone->setProperty("totalMs", stats.totalMs);
+    zone->setProperty("meanMs", stats.meanMs);
+    zone->setProperty("p50Ms", stats.p50Ms);
+    zone->setProperty("p95Ms", stats.p95Ms);
+    zone->setProperty("p99Ms", stats.p99Ms);
+    zone->setProperty("maxMs", stats.maxMs);
+    
+    return juce::var(zone.get());
+}
+
+
+void Profiler::setEnabled(bool shouldBeEnabled)
+{
+    profilerEnabled.store(shouldBeEnabled);
+}
+
+
+bool Profiler::isEnabled()
+{
+    return profilerEnabled.load(std::memory_order_relaxed);
+}
+
+
+void Profiler::nameCurrentThread(const char* name)
+{
+    currentProfilerThread.requestedName = name;
+}
+
+
+juce::String Profiler::getCurrentThreadName()
+{
+    if (currentProfilerThread.requestedName != nullptr)
+        return currentProfilerThread.requestedName;
+    
+    if (auto* thread = juce::Thread::getCurrentThread())
+        return thread->getThreadName();
+    
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        return "MessageThread";
+    
+    return "Thread " + juce::String::toHexString((juce::pointer_sized_int)juce::Thread::getCurrentThreadId());
+}
+
+
+void Profiler::reset()
+{
+    const juce::ScopedLock sl(profilerLock);
+    
+    for (int i = 0; i < numProfilerThreads.load(); i++)
+    {
+        ProfilerThread* thread = profilerThreads[i].get();
+        
+        thread->resetRequested.fetch_add(1);
+        
+        // The calling thread's zones can be cleared here, as can those of a thread that has exited (it can't be reused without the lock).
+        // Otherwise, the owning thread might be updating them, so leave it to clear them itself (see exitZone())
+        if (thread == currentProfilerThread.thread || !thread->active.load())
+            clearNodes(thread);
+    }
+}
+
+
+juce::Array<ProfilerZoneStats> Profiler::getStats(bool mergeThreads)
+{
+    const juce::ScopedLock sl(profilerLock);
+    
+    // Accumulate zones by path (and thread, if not merging), using a sorted map so the report is in path order
+    std::map<std::pair<juce::String, juce::String>, ProfilerAccumulator> accumulators;
+    
+    for (int i = 0; i < numProfilerThreads.load(); i++)
+    {
+        ProfilerThread* thread = profilerThreads[i].get();
+        
+        // Leave out measurements from before the last reset
+        if (isResetPending(thread))
+            continue;
+        
+        for (int j = 0; j < thread->numNodes.load(); j++)
+        {
+            juce::String threadName = mergeThreads ? juce::String() : thread->name;
+            accumulate(accumulators[{ getPath(thread, j), threadName }], thread->nodes[j]);
+        }
+    }
+    
+    juce::Array<ProfilerZoneStats> result;
+    
+    for (auto& entry : accumulators)
+    {
+        // Skip zones that haven't been entered since the last reset
+        if (entry.second.count == 0)
+            continue;
+        
+        ProfilerZoneStats stats = getStatsFromAccumulator(entry.second);
+        stats.path = entry.first.first;
+        stats.thread = entry.first.second;
+        result.add(stats);
+    }
+    
+    return result;
+}
+
+
+ProfilerZoneStats Profiler::getZoneStats(const juce::String& name)
+{
+    const juce::ScopedLock sl(profilerLock);
+    
+    ProfilerAccumulator accumulator;
+    
+    for (int i = 0; i < numProfilerThreads.load(); i++)
+    {
+        ProfilerThread* thread = profilerThreads[i].get();
+        
+        if (isResetPending(thread))
+            continue;
+        
+        for (int j = 0; j < thread->numNodes.load(); j++)
+        {
+            if (name == thread->nodes[j].name)
+                accumulate(accumulator, thread->nodes[j]);
+        }
+    }
+    
+    ProfilerZoneStats stats = getStatsFromAccumulator(accumulator);
+    stats.path = name;
+    
+    return stats;
+}
+
+
+juce::String Profiler::getReport(bool mergeThreads)
+{
+    juce::String report;
+    
+    report << "PROFILER REPORT (times in ms)\n";
+    report << juce::String("Zone").paddedRight(' ', 48) << juce::String("Count").paddedLeft(' ', 10)
+           << juce::String("Total").paddedLeft(' ', 12) << juce::String("Mean").paddedLeft(' ', 10)
+           << juce::String("p50").paddedLeft(' ', 10) << juce::String("p95").paddedLeft(' ', 10)
+           << juce::String("p99").paddedLeft(' ', 10) << juce::String("Max").paddedLeft(' ', 10) << "\n";
+    
+    for (auto& stats : getStats(mergeThreads))
+    {
+        juce::String zone = mergeThreads ? stats.path : stats.thread + ": " + stats.path;
+        
+        report << zone.paddedRight(' ', 48) << juce::String(stats.count).paddedLeft(' ', 10)
+               << juce::String(stats.totalMs, 1).paddedLeft(' ', 12) << juce::String(stats.meanMs, 3).paddedLeft(' ', 10)
+               << juce::String(stats.p50Ms, 3).paddedLeft(' ', 10) << juce::String(stats.p95Ms, 3).paddedLeft(' ', 10)
+               << juce::String(stats.p99Ms, 3).paddedLeft(' ', 10) << juce::String(stats.maxMs, 3).paddedLeft(' ', 10) << "\n";
+    }
+    
+    return report;
+}
+
+
+juce::var Profiler::getReportJson()
+{
+    // Group the zones by thread
+    juce::StringArray threadNames;
+    juce::Array<juce::Array<juce::var>> threadZones;
+    
+    for (auto& stats : getStats(false))
+    {
+        int index = threadNames.indexOf(stats.thread);
+        
+        if (index < 0)
+        {
+            threadNames.add(stats.thread);
+            threadZones.add(juce::Array<juce::var>());
+            index = threadNames.size() - 1;
+        }
+        
+        threadZones.getReference(index).add(getStatsJson(stats));
+    }
+    
+    juce::Array<juce::var> threads;
+    
+    for (int i = 0; i < threadNames.size(); i++)
+    {
+        juce::DynamicObject::Ptr thread = new juce::DynamicObject();
+        thread->setProperty("name", threadNames[i]);
+        thread->setProperty("zones", threadZones[i]);
+        threads.add(thread.get());
+    }
+    
+    // Also include the zones merged across threads, which is usually the more useful summary
+    juce::Array<juce::var> merged;
+    for (auto& stats : getStats(true))
+        merged.add(getStatsJson(stats));
+    
+    juce::DynamicObject::Ptr report = new juce::DynamicObject();
+    report->setProperty("threads", threads);
+    report->setProperty("merged", merged);
+    
+    return juce::var(report.get());
+}
+
+
+bool Profiler::writeReport(juce::File file)
+{
+    return file.replaceWithText(juce::JSON::toString(getReportJson()));
+}
+
+
+bool Profiler::enterZone(const char* name)
+{
+    ProfilerThread* thread = getCurrentThread();
+    
+    if (thread == nullptr || thread->depth >= PROFILER_MAX_DEPTH)
+        return false;
+    
+    int parent = (thread->depth > 0) ? thread->stack[thread->depth - 1] : -1;
+    int numNodes = thread->numNodes.load(std::memory_order_relaxed);
+    int node = -1;
+    
+    // Find the zone with this name and parent (only this thread adds zones, so no synchronisation is needed)
+    for (int i = 0; i < numNodes; i++)
+    {
+        ProfilerNode& candidate = thread->nodes[i];
+        
+        if (candidate.parent == parent && (candidate.name == name || strcmp(candidate.name, name) == 0))
+        {
+            node = i;
+            break;
+        }
+    }
+    
+    // If this is the first time the zone has been entered, add it
+    if (node < 0)
+    {
+        if (numNodes >= PROFILER_MAX_ZONES)
+        {
+            jassert(false); // Too many zones - increase PROFILER_MAX_ZONES
+            return false;
+        }
+        
+        thread->nodes[numNodes].name = name;
+        thread->nodes[numNodes].parent = parent;
+        
+        // Publish the new zone, so that reports can see it
+        thread->numNodes.store(numNodes + 1, std::memory_order_release);
+        node = numNodes;
+    }
+    
+    thread->stack[thread->depth] = node;
+    thread->depth += 1;
+    
+    return true;
+}
+
+
+void Profiler::exitZone(juce::int64 durationTicks)
+{
+    ProfilerThread* thread = currentProfilerThread.thread;
+    
+    if (thread == nullptr || thread->depth == 0)
+    {
+        jassert(false); // Zones must be exited in the reverse order that they were entered
+        return;
+    }
+    
+    // If Profiler::reset() has been called, clear this thread's zones before adding to them
+    if (isResetPending(thread))
+        clearNodes(thread);
+    
+    thread->depth -= 1;
+    ProfilerNode& node = thread->nodes[thread->stack[thread->depth]];
+    
+    // Only this thread writes to the zone (even when resetting), so a load and store is enough (no read-modify-write needed)
+    node.count.store(node.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    node.totalTicks.store(node.totalTicks.load(std::memory_order_relaxed) + durationTicks, std::memory_order_relaxed);
+    
+    if (durationTicks > node.maxTicks.load(std::memory_order_relaxed))
+        node.maxTicks.store(durationTicks, std::memory_order_relaxed);
+    
+    std::atomic<juce::uint32>& bucket = node.buckets[getBucket((juce::uint64)ticksToNanoseconds(durationTicks))];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
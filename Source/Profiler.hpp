@@ -0,0 +1,175 @@
+//
+//  Profiler.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef Profiler_hpp
+#define Profiler_hpp
+
+#include <JuceHeader.h>
+
+#include "Tracer.hpp"
+
+
+#define PROFILER_MAX_THREADS (64) ///< Maximum number of threads that can be profiled at once
+#define PROFILER_MAX_ZONES (128) ///< Maximum number of distinct (nested) zones per thread
+#define PROFILER_MAX_DEPTH (32) ///< Maximum nesting depth of zones
+#define PROFILER_SUB_BUCKETS (4) ///< Number of histogram buckets per doubling of duration (i.e. ~19% resolution)
+#define PROFILER_NUM_BUCKETS (42*PROFILER_SUB_BUCKETS) ///< Number of histogram buckets, covering durations up to ~73 minutes
+
+
+// Simply include this file, and then use the following macro to time the enclosing scope.
+// The name must be a string literal, and zones can be nested to build up a hierarchy (e.g. "analyse/beats/tempo").
+// Zones are also recorded as trace events, if the Tracer is enabled.
+// When the profiler and tracer are disabled, the only cost is two atomic flag checks.
+#define PROFILE_ZONE(name) ProfilerZone JUCE_JOIN_MACRO(profilerZone, __LINE__) (name);
+
+
+/** Summary of the time measurements for a single profiler zone. */
+typedef struct ProfilerZoneStats
+{
+    juce::String path; ///< Full path of the zone, e.g. "analyse/beats/tempo"
+    juce::String thread; ///< Name of the thread on which the zone ran (empty if merged across threads)
+    juce::int64 count = 0; ///< Number of times the zone was entered
+    double totalMs = 0.0; ///< Total time spent in the zone
+    double meanMs = 0.0; ///< Mean duration
+    double p50Ms = 0.0; ///< Median duration
+    double p95Ms = 0.0; ///< 95th percentile duration
+    double p99Ms = 0.0; ///< 99th percentile duration
+    double maxMs = 0.0; ///< Longest duration
+} ProfilerZoneStats;
+
+
+/**
+ Low-overhead, thread-safe hierarchical profiler, for timing sections of code on any thread.
+ 
+ Use the PROFILE_ZONE macro to time a scope. Each thread accumulates its own measurements without locking:
+ the first zone on a thread registers it (which does take a lock, once), and after that each zone only touches
+ data owned by its thread, using relaxed atomics so that reports can be generated from any other thread at any time.
+ 
+ Rather than just a mean, every zone keeps a logarithmic histogram of its durations,
+ from which percentiles (p50/p95/p99) are estimated, to within the resolution of the histogram buckets.
+ */
+class Profiler
+{
+public:
+    
+    /** Enables/disables profiling at runtime. Disabled zones cost a single atomic flag check.
+     
+     @param[in] shouldBeEnabled New profiling state */
+    static void setEnabled(bool shouldBeEnabled);
+    
+    /** Checks whether profiling is enabled.
+     
+     @return True if enabled */
+    static bool isEnabled();
+    
+    /** Names the calling thread in reports, for threads that aren't juce::Threads (e.g. the audio callback).
+     Must be called before the first zone on that thread - afterwards, this does nothing.
+     
+     @param[in] name Name of the calling thread (must be a string literal) */
+    static void nameCurrentThread(const char* name);
+    
+    /** Fetches the name of the calling thread, as used in reports (and traces, see Tracer).
+     
+     @return Name given by nameCurrentThread(), or the juce::Thread name, or a placeholder based on the thread ID */
+    static juce::String getCurrentThreadName();
+    
+    /** Clears all measurements, ready to profile something new.
+     Each thread clears its own measurements the next time it exits a zone, and they are left out of reports until then. */
+    static void reset();
+    
+    /** Fetches the measurements for every zone.
+     
+     @param[in] mergeThreads If true, zones with the same path on different threads are combined
+     
+     @return Array of zone measurements, sorted by path */
+    static juce::Array<ProfilerZoneStats> getStats(bool mergeThreads = true);
+    
+    /** Fetches the measurements for all zones with the given name, merged across threads and parent zones.
+     
+     @param[in] name Name of the zone (the last part of its path), e.g. "tempo"
+     
+     @return Combined measurements (count is 0 if the zone was never entered) */
+    static ProfilerZoneStats getZoneStats(const juce::String& name);
+    
+    /** Generates a human-readable table of all zone measurements, e.g. for the debug console.
+     
+     @param[in] mergeThreads If true, zones with the same path on different threads are combined
+     
+     @return Report text */
+    static juce::String getReport(bool mergeThreads = true);
+    
+    /** Generates a JSON representation of all zone measurements, separated by thread.
+     
+     @return Report as a JSON object */
+    static juce::var getReportJson();
+    
+    /** Writes the JSON report to a file.
+     
+     @param[in] file File to write
+     
+     @return True if successful */
+    static bool writeReport(juce::File file);
+    
+    /** Enters a zone on the calling thread - use PROFILE_ZONE rather than calling this directly.
+     
+     @param[in] name Name of the zone (must be a string literal)
+     
+     @return True if the zone was entered, in which case exitZone() must be called */
+    static bool enterZone(const char* name);
+    
+    /** Exits the innermost zone on the calling thread - use PROFILE_ZONE rather than calling this directly.
+     
+     @param[in] durationTicks Time spent in the zone, measured in high-resolution ticks */
+    static void exitZone(juce::int64 durationTicks);
+    
+};
+
+
+/**
+ RAII helper which measures the time between its construction and destruction, and adds it to the Profiler.
+ Use the PROFILE_ZONE macro rather than instantiating this directly.
+ */
+class ProfilerZone
+{
+public:
+    
+    /** Constructor - enters the zone, if profiling and/or tracing is enabled. */
+    ProfilerZone(const char* zoneName) : name(zoneName)
+    {
+        profiling = Profiler::isEnabled() && Profiler::enterZone(name);
+        tracing = Tracer::isEnabled();
+        
+        if (profiling || tracing)
+            startTicks = juce::Time::getHighResolutionTicks();
+    }
+    
+    /** Destructor - exits the zone, recording its duration and/or trace event. */
+    ~ProfilerZone()
+    {
+        if (startTicks < 0)
+            return;
+        
+        juce::int64 endTicks = juce::Time::getHighResolutionTicks();
+        
+        if (profiling)
+            Profiler::exitZone(endTicks - startTicks);
+        
+        if (tracing)
+            Tracer::addEvent(name, startTicks, endTicks);
+    }
+    
+private:
+    
+    const char* name; ///< Name of the zone
+    bool profiling = false; ///< Indicates that the zone was entered in the Profiler
+    bool tracing = false; ///< Indicates that a trace event should be recorded when the zone exits
+    juce::int64 startTicks = -1; ///< Time at which the zone was entered, or -1 if profiling and tracing were disabled
+    
+    JUCE_DECLARE_NON_COPYABLE(ProfilerZone) ///< JUCE macro to prevent copying
+};
+
+#endif /* Profiler_hpp */
@@ -24,6 +24,11 @@ public:
     /** Destructor. */
     ~RandomGenerator() {}
     
+    /** Restarts the random sequence from a given seed, so that the same choices are made every time.
+     
+     @param[in] seed Seed for the random algorithm */
+    void setSeed(unsigned int seed) { algorithm.seed(seed); }
+    
     /** Generates a random double within the provided range, using a normal (Gaussian) distribution.
      
      @param[in] stdDev Standard deviation to be used for the normal distribution
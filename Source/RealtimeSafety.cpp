@@ -0,0 +1,283 @@
+//
+//  RealtimeSafety.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "RealtimeSafety.hpp"
+
+#include <cstdlib>
+#include <new>
+
+
+// These are plain integers rather than objects, so that they are safe to access from within operator new
+thread_local int realtimeDepth = 0; // Number of ScopedRealtimeThread objects alive on this thread
+thread_local int allowDepth = 0; // Number of ScopedAllow objects alive on this thread (also used while reporting)
+
+std::atomic<int> realtimeSafetyMode {RealtimeSafety::Mode::off};
+std::atomic<int> numRealtimeViolations {0};
+
+
+/** Stored violations, which are only accessed while the lock is held. */
+struct ViolationStore
+{
+    juce::CriticalSection lock;
+    juce::Array<RealtimeSafety::Violation> violations;
+};
+
+
+/** Fetches the violation store, creating it on first use (so that it's available during static initialisation). */
+static ViolationStore& getViolationStore()
+{
+    static ViolationStore store;
+    return store;
+}
+
+
+/** Generates a text description of a violation type. */
+static juce::String getTypeString(RealtimeSafety::ViolationType type)
+{
+    switch (type)
+    {
+        case RealtimeSafety::ViolationType::allocation:
+            return "Heap allocation";
+        case RealtimeSafety::ViolationType::deallocation:
+            return "Heap deallocation";
+        case RealtimeSafety::ViolationType::lock:
+            return "Lock";
+        case RealtimeSafety::ViolationType::fileIO:
+            return "File I/O";
+        default:
+            jassert(false); // Unrecognised violation type
+            return "Unknown";
+    }
+}
+
+
+/** Records a violation on the calling (real-time) thread. */
+static void reportViolation(RealtimeSafety::ViolationType type, const char* description)
+{
+    // Reporting allocates, so suspend checking until we're done
+    RealtimeSafety::ScopedAllow allow;
+    
+    numRealtimeViolations.fetch_add(1);
+    
+    juce::String stackTrace = juce::SystemStats::getStackBacktrace();
+    
+    bool isNew = false;
+    
+    {
+        ViolationStore& store = getViolationStore();
+        const juce::ScopedLock sl(store.lock);
+        
+        bool found = false;
+        
+        // Count repeats of the same violation from the same call stack
+        for (auto& violation : store.violations)
+        {
+            if (violation.type == type && violation.description == description && violation.stackTrace == stackTrace)
+            {
+                violation.count += 1;
+                found = true;
+                break;
+            }
+        }
+        
+        if (!found && store.violations.size() < REALTIME_SAFETY_MAX_VIOLATIONS)
+        {
+            RealtimeSafety::Violation violation;
+            violation.type = type;
+            violation.description = description;
+            violation.stackTrace = stackTrace;
+            violation.count = 1;
+            store.violations.add(violation);
+            isNew = true;
+        }
+    }
+    
+    // Only log the first occurence of each violation, otherwise the audio thread would be flooded
+    if (isNew)
+    {
+        DBG("REAL-TIME SAFETY VIOLATION: " << getTypeString(type) << " (" << description << ") on the audio thread\n" << stackTrace);
+        
+        if (realtimeSafetyMode.load() == RealtimeSafety::Mode::trapping)
+            jassert(false); // Real-time safety violation - see the stack trace above
+    }
+}
+
+
+RealtimeSafety::ScopedRealtimeThread::ScopedRealtimeThread()
+{
+    realtimeDepth += 1;
+}
+
+
+RealtimeSafety::ScopedRealtimeThread::~ScopedRealtimeThread()
+{
+    realtimeDepth -= 1;
+}
+
+
+RealtimeSafety::ScopedAllow::ScopedAllow()
+{
+    allowDepth += 1;
+}
+
+
+RealtimeSafety::ScopedAllow::~ScopedAllow()
+{
+    allowDepth -= 1;
+}
+
+
+void RealtimeSafety::setMode(Mode newMode)
+{
+    realtimeSafetyMode.store(newMode);
+}
+
+
+RealtimeSafety::Mode RealtimeSafety::getMode()
+{
+    return (Mode)realtimeSafetyMode.load();
+}
+
+
+bool RealtimeSafety::isRealtimeThread()
+{
+    return realtimeDepth > 0 && allowDepth == 0;
+}
+
+
+void RealtimeSafety::check(ViolationType type, const char* description)
+{
+    if (isRealtimeThread() && realtimeSafetyMode.load(std::memory_order_relaxed) != Mode::off)
+        reportViolation(type, description);
+}
+
+
+juce::Array<RealtimeSafety::Violation> RealtimeSafety::getViolations()
+{
+    ViolationStore& store = getViolationStore();
+    const juce::ScopedLock sl(store.lock);
+    
+    return store.violations;
+}
+
+
+int RealtimeSafety::getNumViolations()
+{
+    return numRealtimeViolations.load();
+}
+
+
+void RealtimeSafety::clearViolations()
+{
+    ViolationStore& store = getViolationStore();
+    const juce::ScopedLock sl(store.lock);
+    
+    store.violations.clear();
+    numRealtimeViolations.store(0);
+}
+
+
+juce::String RealtimeSafety::getReport()
+{
+    juce::String report;
+    
+    report << "REAL-TIME SAFETY REPORT\n";
+    report << "Total violations: " << getNumViolations() << "\n";
+    
+    for (auto& violation : getViolations())
+    {
+        report << "\n" << getTypeString(violation.type) << " (" << violation.description << "), "
+               << violation.count << " time(s), first at:\n" << violation.stackTrace << "\n";
+    }
+    
+    return report;
+}
+
+
+#if REALTIME_SAFETY_ENABLED
+
+// Replacements for the global allocation functions, which flag any use on the audio thread
+// (Over-aligned allocations use the default implementations, which are rare enough not to matter here)
+
+void* operator new(std::size_t size)
+{
+    RealtimeSafety::check(RealtimeSafety::ViolationType::allocation, "operator new");
+    
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    
+    throw std::bad_alloc();
+}
+
+
+void* operator new[](std::size_t size)
+{
+    RealtimeSafety::check(RealtimeSafety::ViolationType::allocation, "operator new[]");
+    
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+        return ptr;
+    
+    throw std::bad_alloc();
+}
+
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    RealtimeSafety::check(RealtimeSafety::ViolationType::allocation, "operator new");
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    RealtimeSafety::check(RealtimeSafety::ViolationType::allocation, "operator new[]");
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+
+void operator delete(void* ptr) noexcept
+{
+    if (ptr != nullptr)
+        RealtimeSafety::check(RealtimeSafety::ViolationType::deallocation, "operator delete");
+    
+    std::free(ptr);
+}
+
+
+void operator delete[](void* ptr) noexcept
+{
+    if (ptr != nullptr)
+        RealtimeSafety::check(RealtimeSafety::ViolationType::deallocation, "operator delete[]");
+    
+    std::free(ptr);
+}
+
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    operator delete[](ptr);
+}
+
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    operator delete(ptr);
+}
+
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    operator delete[](ptr);
+}
+
+#endif
@@ -0,0 +1,135 @@
+//
+//  RealtimeSafety.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef RealtimeSafety_hpp
+#define RealtimeSafety_hpp
+
+#include <JuceHeader.h>
+
+
+// Set the following macro to 1 to check for real-time safety violations (by default, only in debug builds)
+// This replaces the global operator new/delete, so that heap allocations on the audio thread can be detected
+#ifndef REALTIME_SAFETY_ENABLED
+#define REALTIME_SAFETY_ENABLED (JUCE_DEBUG)
+#endif
+
+#define REALTIME_SAFETY_MAX_VIOLATIONS (64) ///< Maximum number of distinct violations (i.e. different call stacks) to store
+
+
+// Place the following macro before any operation that isn't real-time safe, but can't be detected automatically
+// (currently locks and file I/O), e.g. REALTIME_UNSAFE(fileIO, "DataManager::loadAudio")
+#if REALTIME_SAFETY_ENABLED
+#define REALTIME_UNSAFE(type, description) RealtimeSafety::check(RealtimeSafety::ViolationType::type, description);
+#else
+#define REALTIME_UNSAFE(type, description)
+#endif
+
+
+/**
+ Debug checker that flags operations on the audio thread which may block, and therefore cause audio glitches.
+ 
+ The audio thread is tagged using ScopedRealtimeThread. While it is tagged, any heap allocation/deallocation
+ (detected automatically) or lock/file access (marked with REALTIME_UNSAFE) is recorded as a violation,
+ along with a stack trace. Depending on the mode, violations are logged, or also trap in the debugger.
+ Repeated violations with the same call stack are counted, rather than stored again.
+ 
+ Checking is off by default, since capturing stack traces is slow - launch the app with "--rt-check" to log violations,
+ or "--rt-trap" to also trap them. RealtimeSafetyTest enables logging while it runs.
+ */
+class RealtimeSafety
+{
+public:
+    
+    /** Enum to define how violations are reported. */
+    enum Mode : int
+    {
+        off, ///< Violations are ignored
+        logging, ///< Violations are stored and logged to the debug console
+        trapping ///< Violations are stored and logged, and trigger a debug assertion
+    };
+    
+    /** Enum to define the types of operation that are not real-time safe. */
+    enum ViolationType : int
+    {
+        allocation,
+        deallocation,
+        lock,
+        fileIO
+    };
+    
+    /** Information about a violation. */
+    typedef struct Violation
+    {
+        ViolationType type; ///< Type of operation
+        juce::String description; ///< Description of the operation, e.g. the name of the lock
+        juce::String stackTrace; ///< Stack trace of the first occurence
+        int count = 0; ///< Number of times the violation occured with this call stack
+    } Violation;
+    
+    /** RAII helper which tags the calling thread as real-time for the duration of its scope. */
+    class ScopedRealtimeThread
+    {
+    public:
+        ScopedRealtimeThread(); ///< Constructor - tags the calling thread as real-time
+        ~ScopedRealtimeThread(); ///< Destructor - removes the tag
+        
+        JUCE_DECLARE_NON_COPYABLE(ScopedRealtimeThread) ///< JUCE macro to prevent copying
+    };
+    
+    /** RAII helper which allows non-real-time operations for the duration of its scope.
+     Only use this for operations that are known to be one-off, e.g. lazy initialisation. */
+    class ScopedAllow
+    {
+    public:
+        ScopedAllow(); ///< Constructor - suspends checking on the calling thread
+        ~ScopedAllow(); ///< Destructor - resumes checking
+        
+        JUCE_DECLARE_NON_COPYABLE(ScopedAllow) ///< JUCE macro to prevent copying
+    };
+    
+    /** Sets how violations are reported.
+     
+     @param[in] newMode Reporting mode */
+    static void setMode(Mode newMode);
+    
+    /** Fetches the current reporting mode.
+     
+     @return Reporting mode */
+    static Mode getMode();
+    
+    /** Checks whether the calling thread is currently tagged as real-time (and checking isn't suspended).
+     
+     @return Result of the check */
+    static bool isRealtimeThread();
+    
+    /** Records a violation if the calling thread is real-time - use REALTIME_UNSAFE rather than calling this directly.
+     
+     @param[in] type Type of operation
+     @param[in] description Description of the operation (must be a string literal) */
+    static void check(ViolationType type, const char* description);
+    
+    /** Fetches all the violations recorded so far.
+     
+     @return Array of violations */
+    static juce::Array<Violation> getViolations();
+    
+    /** Fetches the total number of violations recorded so far, including repeats.
+     
+     @return Number of violations */
+    static int getNumViolations();
+    
+    /** Clears all recorded violations. */
+    static void clearViolations();
+    
+    /** Generates a human-readable report of all violations, including stack traces.
+     
+     @return Report text */
+    static juce::String getReport();
+    
+};
+
+#endif /* RealtimeSafety_hpp */
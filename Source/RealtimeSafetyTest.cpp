@@ -0,0 +1,154 @@
+//
+//  RealtimeSafetyTest.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "RealtimeSafetyTest.hpp"
+
+#include "ArtificialDJ.hpp"
+#include "AudioProcessor.hpp"
+#include "RealtimeSafety.hpp"
+
+
+void RealtimeSafetyTest::run()
+{
+    juce::String result;
+
+#if !REALTIME_SAFETY_ENABLED
+    result << "Real-time safety checks are disabled in this build - set REALTIME_SAFETY_ENABLED to 1\n";
+    DBG(result);
+#else
+    if (waitForLibrary())
+        result = runMix();
+    else
+        result << "REAL-TIME SAFETY TEST: the music folder needs at least " << NUM_TRACKS_MIN << " valid tracks\n";
+    
+    DBG(result);
+#endif
+    
+    {
+        const juce::ScopedLock sl(lock);
+        report = result;
+    }
+    
+    finished.store(true);
+}
+
+
+bool RealtimeSafetyTest::waitForLibrary()
+{
+    double progress;
+    
+    while (dataManager->isLoading(progress))
+    {
+        if (threadShouldExit())
+            return false;
+        
+        sleep(REALTIME_TEST_POLL_INTERVAL_MS);
+    }
+    
+    if (!dataManager->isDirectoryValid())
+        return false;
+    
+    // Wait for the whole library to be analysed, so that analysis doesn't compete with the mix
+    while (!dataManager->isAnalysisFinished())
+    {
+        if (threadShouldExit())
+            return false;
+        
+        sleep(REALTIME_TEST_POLL_INTERVAL_MS);
+    }
+    
+    return dataManager->canStartPlaying();
+}
+
+
+juce::String RealtimeSafetyTest::runMix()
+{
+    juce::String result;
+    
+    RealtimeSafety::clearViolations();
+    
+    // Make sure violations are recorded, without changing the mode if it was already set
+    RealtimeSafety::Mode previousMode = RealtimeSafety::getMode();
+    if (previousMode == RealtimeSafety::Mode::off)
+        RealtimeSafety::setMode(RealtimeSafety::Mode::logging);
+    
+    // Create a separate DJ and audio processor, so the app's own mix is unaffected
+    ArtificialDJ dj(dataManager);
+    AudioProcessor processor(dataManager, &dj, REALTIME_TEST_BLOCK_SIZE);
+    dj.setAudioProcessor(&processor);
+    
+    // Simulated audio device output
+    juce::AudioBuffer<float> buffer(2, REALTIME_TEST_BLOCK_SIZE);
+    juce::AudioSourceChannelInfo outputBuffer(&buffer, 0, REALTIME_TEST_BLOCK_SIZE);
+    
+    // Start the DJ, which initialises the mix on its own thread, and starts playback once ready
+    dj.playPause();
+    
+    while (!dj.isInitialised() && !threadShouldExit())
+        sleep(10);
+    
+    int numBlocks = 0;
+    int numMixes = 0;
+    int currentMixId = -1;
+    juce::uint32 waitStart = juce::Time::getMillisecondCounter();
+    
+    while (!threadShouldExit() && !processor.mixEnded() && numMixes < REALTIME_TEST_NUM_MIXES)
+    {
+        // The simulation runs faster than real time, so the DJ's schedule can't keep up with it
+        // Whenever the decks are held waiting for a mix, wake the DJ and give it time to prepare one
+        if (processor.getLeaderMixId() == MIX_ID_HOLD && !dj.isMixReady()
+            && juce::Time::getMillisecondCounter() - waitStart < REALTIME_TEST_MIX_TIMEOUT_MS)
+        {
+            dj.notify();
+            sleep(5);
+            continue;
+        }
+        
+        waitStart = juce::Time::getMillisecondCounter();
+        
+        // Simulate the audio callback
+        processor.getNextAudioBlock(outputBuffer);
+        numBlocks += 1;
+        
+        // Periodically skip to the next mix event, so that we don't have to play whole tracks
+        if (numBlocks % REALTIME_TEST_SKIP_INTERVAL == 0 && dj.canSkip())
+            processor.skip();
+        
+        // Count the number of transitions played (a hold isn't a transition, so it isn't counted)
+        TrackProcessor* leader = nullptr;
+        TrackProcessor* follower = nullptr;
+        processor.getTrackProcessors(&leader, &follower);
+        
+        if (leader != nullptr && leader->getCurrentMix().id != currentMixId && leader->getCurrentMix().id != MIX_ID_HOLD)
+        {
+            currentMixId = leader->getCurrentMix().id;
+            numMixes += 1;
+        }
+    }
+    
+    // Stop the DJ and release the audio it decoded
+    dj.reset();
+    
+    RealtimeSafety::setMode(previousMode);
+    
+    // Reset the playing/played flags set by the simulated mix
+    dataManager->clearHistory();
+    
+    result << "REAL-TIME SAFETY TEST: " << numBlocks << " blocks, " << numMixes << " mixes\n";
+    result << RealtimeSafety::getReport();
+    
+    passed.store(RealtimeSafety::getNumViolations() == 0);
+    
+    return result;
+}
+
+
+juce::String RealtimeSafetyTest::getReport()
+{
+    const juce::ScopedLock sl(lock);
+    return report;
+}
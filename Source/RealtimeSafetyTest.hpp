@@ -0,0 +1,86 @@
+//
+//  RealtimeSafetyTest.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef RealtimeSafetyTest_hpp
+#define RealtimeSafetyTest_hpp
+
+#include <JuceHeader.h>
+#include "DataManager.hpp"
+
+
+#define REALTIME_TEST_BLOCK_SIZE (512) ///< Size of the simulated audio blocks
+#define REALTIME_TEST_NUM_MIXES (6) ///< Number of transitions to play through before the test ends
+#define REALTIME_TEST_SKIP_INTERVAL (400) ///< Number of blocks between skips to the next mix event (~4.6s of audio)
+#define REALTIME_TEST_MIX_TIMEOUT_MS (10000) ///< Maximum time to wait for the DJ to prepare the next mix
+#define REALTIME_TEST_POLL_INTERVAL_MS (100) ///< Interval at which the library's progress, and the test's, are checked
+
+
+/**
+ Drives a full simulated DJ mix through a new AudioProcessor, with real-time safety checking enabled (see RealtimeSafety).
+ The audio callback is called from this thread as fast as the DJ allows, skipping through each track
+ so that every part of the mix (track loads, transitions, mix changes) is exercised in a short time.
+ The test passes if no real-time safety violations occur on the simulated audio thread.
+ 
+ The test first waits for the library to be loaded and analysed, and needs at least NUM_TRACKS_MIN valid tracks.
+ It runs without a window or audio device, and the app exits with a non-zero code if it fails:
+   
+   AutoDJ --rt-test --library=/path/to/music
+ */
+class RealtimeSafetyTest : public juce::Thread
+{
+public:
+    
+    /** Constructor. */
+    RealtimeSafetyTest(DataManager* dm) : juce::Thread("RealtimeSafetyTest"), dataManager(dm) {}
+    
+    /** Destructor. */
+    ~RealtimeSafetyTest() { stopThread(10000); }
+    
+    /** Runs the test - call startThread() rather than calling this directly. */
+    void run() override;
+    
+    /** Checks whether the test has finished.
+     
+     @return Result of the check */
+    bool isFinished() { return finished.load(); }
+    
+    /** Checks whether the test passed (only valid once finished).
+     
+     @return True if there were no real-time safety violations */
+    bool hasPassed() { return passed.load(); }
+    
+    /** Fetches the test report, which includes the stack trace of every violation (only valid once finished).
+     
+     @return Report text */
+    juce::String getReport();
+    
+private:
+    
+    /** Waits for the library to be loaded and analysed.
+     
+     @return False if the library doesn't have enough valid tracks, or the thread should exit */
+    bool waitForLibrary();
+    
+    /** Plays the simulated mix, and records whether it passed.
+     
+     @return Test report */
+    juce::String runMix();
+    
+    juce::CriticalSection lock; ///< RAII lock to ensure thread-safety while acessing data within this class
+    
+    DataManager* dataManager = nullptr; ///< Pointer to the app's track data manager
+    
+    std::atomic<bool> finished = false; ///< Indicates that the test has finished
+    std::atomic<bool> passed = false; ///< Indicates that the test passed
+    
+    juce::String report; ///< Test report
+    
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeSafetyTest) ///< JUCE macro to add a memory leak detector
+};
+
+#endif /* RealtimeSafetyTest_hpp */
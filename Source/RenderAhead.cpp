@@ -0,0 +1,191 @@
+//
+//  RenderAhead.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "RenderAhead.hpp"
+
+#include "AudioProcessor.hpp"
+#include "Profiler.hpp"
+#include "RealtimeSafety.hpp"
+
+
+RenderAhead::RenderAhead(AudioProcessor* p) :
+    juce::Thread("RenderAhead"), processor(p)
+{
+    ring.setSize(2, RENDER_AHEAD_NUM_BLOCKS * RENDER_AHEAD_BLOCK_SIZE);
+}
+
+
+void RenderAhead::start()
+{
+    reset();
+    startThread(RENDER_AHEAD_PRIORITY);
+}
+
+
+void RenderAhead::restart()
+{
+    // The mix is starting again, so it can't have ended
+    ended.store(false);
+    resetRequested.store(true);
+    
+    startThread(RENDER_AHEAD_PRIORITY);
+}
+
+
+void RenderAhead::run()
+{
+    Profiler::nameCurrentThread("RenderAhead");
+    
+    while (!threadShouldExit())
+    {
+        // After a reset, everything rendered so far belongs to the last performance
+        // (only the audio thread can remove it from the ring, so it is just marked here)
+        if (resetRequested.exchange(false))
+            discardUntil.store(numWritten.load());
+        
+        // Publish whether the end of the mix has been rendered, so the audio thread never has to check the decks
+        // (this is only set once the last block has been written, so the audio thread can play out everything before it)
+        bool decksEnded = processor->decksEnded();
+        ended.store(decksEnded);
+        
+        // Only render while the mix is playing, and there is space in the ring
+        if (processor->paused.load() || decksEnded || fifo.getFreeSpace() == 0)
+        {
+            wait(RENDER_AHEAD_WAIT_MS);
+            continue;
+        }
+        
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(1, start1, size1, start2, size2);
+        
+        int block = (size1 > 0) ? start1 : start2;
+        RenderedBlockInfo& info = blockInfo[block];
+        info = RenderedBlockInfo();
+        
+        {
+            // The decks still have a deadline (just a much longer one), so keep checking them for real-time safety
+            RealtimeSafety::ScopedRealtimeThread realtimeThread;
+            
+            // Render straight into the ring
+            juce::AudioSourceChannelInfo blockBuffer(&ring, block * RENDER_AHEAD_BLOCK_SIZE, RENDER_AHEAD_BLOCK_SIZE);
+            processor->renderBlock(blockBuffer, info);
+        }
+        
+        juce::int64 numBefore = numWritten.load();
+        
+        fifo.finishedWrite(1);
+        numWritten.store(numBefore + 1);
+        
+        // If the mix was changed (e.g. by a skip), everything rendered before this block is stale
+        if (info.invalidated)
+            staleUntil.store(numBefore);
+    }
+}
+
+
+int RenderAhead::read(const juce::AudioSourceChannelInfo& outputBuffer, RenderedBlockInfo& info)
+{
+    PROFILE_ZONE("playout")
+    
+    int numPrimeBlocks = getNumPrimeBlocks();
+    
+    // If a reset has discarded some of the ring, drop it straight away, and wait for the new performance to be rendered
+    juce::int64 discard = discardUntil.load();
+    if (numRead < discard)
+    {
+        fifo.finishedRead(int(discard - numRead));
+        numRead = discard;
+        readOffset = 0;
+        primed = false;
+    }
+    
+    // If a change to the mix has made some of the ring stale, jump over it once enough audio has been rendered after the change
+    juce::int64 stale = staleUntil.load();
+    if (numRead < stale && numWritten.load() >= stale + numPrimeBlocks)
+    {
+        fifo.finishedRead(int(stale - numRead));
+        numRead = stale;
+        readOffset = 0;
+    }
+    
+    // Wait until enough audio has been rendered before starting (or restarting after the ring ran dry),
+    // unless the mix has finished rendering, in which case whatever is left should be played out
+    if (!primed)
+    {
+        if (fifo.getNumReady() < numPrimeBlocks && !ended.load())
+            return 0;
+        
+        primed = true;
+    }
+    
+    int numCopied = 0;
+    
+    // Copy from as many blocks as necessary to fill the output buffer
+    while (numCopied < outputBuffer.numSamples)
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(1, start1, size1, start2, size2);
+        
+        // If the ring has run dry before the end of the mix, the render thread isn't keeping up
+        if (size1 + size2 == 0)
+        {
+            if (!ended.load())
+                processor->getLoadMonitor()->addUnderrun();
+            
+            primed = false;
+            break;
+        }
+        
+        int block = (size1 > 0) ? start1 : start2;
+        int numSamples = juce::jmin(outputBuffer.numSamples - numCopied, RENDER_AHEAD_BLOCK_SIZE - readOffset);
+        
+        for (int channel = 0; channel < 2; channel++)
+            outputBuffer.buffer->copyFrom(channel, outputBuffer.startSample + numCopied, ring, channel, block * RENDER_AHEAD_BLOCK_SIZE + readOffset, numSamples);
+        
+        info = blockInfo[block];
+        
+        numCopied += numSamples;
+        readOffset += numSamples;
+        
+        // If the whole block has been played, remove it from the ring
+        if (readOffset == RENDER_AHEAD_BLOCK_SIZE)
+        {
+            fifo.finishedRead(1);
+            numRead += 1;
+            readOffset = 0;
+        }
+    }
+    
+    return numCopied;
+}
+
+
+void RenderAhead::reset()
+{
+    fifo.reset();
+    ring.clear();
+    
+    numWritten.store(0);
+    staleUntil.store(0);
+    discardUntil.store(0);
+    
+    resetRequested.store(false);
+    ended.store(false);
+    
+    numRead = 0;
+    readOffset = 0;
+    primed = false;
+}
+
+
+int RenderAhead::getNumPrimeBlocks()
+{
+    // Enough blocks for a couple of device callbacks, but never so many that the ring can't hold them
+    int deviceBlocks = (RENDER_AHEAD_PRIME_DEVICE_BLOCKS * deviceBlockSize.load() + RENDER_AHEAD_BLOCK_SIZE - 1) / RENDER_AHEAD_BLOCK_SIZE;
+    
+    return juce::jlimit(RENDER_AHEAD_PRIME_BLOCKS, RENDER_AHEAD_NUM_BLOCKS / 2, deviceBlocks);
+}
@@ -0,0 +1,133 @@
+//
+//  RenderAhead.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef RenderAhead_hpp
+#define RenderAhead_hpp
+
+#include <JuceHeader.h>
+#include "CommonDefs.hpp"
+
+class AudioProcessor;
+
+
+#define RENDER_AHEAD_BLOCK_SIZE (512) ///< Number of samples rendered at a time (the decks always process blocks of this size)
+#define RENDER_AHEAD_NUM_BLOCKS (128) ///< Capacity of the ring, in blocks (~1.5s at 512 samples)
+#define RENDER_AHEAD_PRIME_BLOCKS (8) ///< Minimum number of blocks that must be ready before playback starts, or restarts after the ring runs dry (see getNumPrimeBlocks())
+#define RENDER_AHEAD_PRIME_DEVICE_BLOCKS (2) ///< Number of audio device blocks that must be ready before playback starts, if that is more than RENDER_AHEAD_PRIME_BLOCKS
+#define RENDER_AHEAD_WAIT_MS (5) ///< Time the render thread sleeps while the ring is full, or playback is paused
+#define RENDER_AHEAD_PRIORITY (8) ///< Priority of the render thread (0-10)
+#define RENDER_AHEAD_STOP_TIMEOUT_MS (2000) ///< Time to wait for the render thread to stop
+
+
+/** Information about a rendered block, which is passed along with its audio. */
+typedef struct RenderedBlockInfo
+{
+    int playheads[NUM_DECKS] = {}; ///< Playhead position of each TrackProcessor at the end of the block
+    bool invalidated = false; ///< Indicates that the mix was changed at the start of the block (e.g. by a skip), so earlier blocks are stale
+} RenderedBlockInfo;
+
+
+/**
+ Renders the mix ahead of time on a background thread, so that the audio callback only has to copy samples.
+ 
+ The mix decisions are known well before they play, so there's no need to run the decks in the audio callback.
+ The render thread runs AudioProcessor's deck processing (time stretching, crossfade automation and summing) in fixed-size
+ blocks, into a lock-free ring of up to RENDER_AHEAD_NUM_BLOCKS blocks. The audio callback reads from the ring, which makes
+ its cost small and constant - the decks can take as long as they like, as long as they keep up on average.
+ 
+ The decks are only ever touched by the render thread: it publishes everything the audio callback needs to know about them
+ (e.g. whether the mix has ended) alongside the audio, and the callback only ever consumes from the ring, never resets it.
+ 
+ When the mix is changed (i.e. by a skip, see RenderedBlockInfo), all of the audio rendered before the change is stale. The audio
+ callback keeps playing the stale audio until enough audio has been rendered after the change, then jumps straight to it,
+ so a change never causes a dropout. After a reset (see restart()), the stale audio is dropped straight away instead.
+ The master volume and pausing are applied as the audio is played out, so they take effect immediately without making the ring stale.
+ Every other change to the mix (e.g. a new mix from the DJ, or a drop in stretch quality) is made by the render thread
+ in the order it is rendered, so it never makes the ring stale either.
+ */
+class RenderAhead : public juce::Thread
+{
+public:
+    
+    /** Constructor.
+     
+     @param[in] processor Pointer to the top-level audio processor, which renders the blocks */
+    RenderAhead(AudioProcessor* processor);
+    
+    /** Destructor. */
+    ~RenderAhead() { stopThread(RENDER_AHEAD_STOP_TIMEOUT_MS); }
+    
+    /** Clears the ring and starts the render thread. Only call before the audio callback starts reading. */
+    void start();
+    
+    /** Restarts the render thread once it has been stopped (e.g. while the decks are reset), for a new performance.
+     The audio callback may still be reading, so the ring isn't cleared here: the render thread marks everything in it as
+     discarded, and the audio callback drops it. */
+    void restart();
+    
+    /** Sets the block size of the audio device, which determines how much audio must be rendered before playback starts.
+     The decks always render RENDER_AHEAD_BLOCK_SIZE samples at a time, whatever the device's block size.
+     
+     @param[in] blockSize Number of samples the audio callback is expected to read at a time */
+    void setDeviceBlockSize(int blockSize) { deviceBlockSize.store(blockSize); }
+    
+    /** Checks whether the render thread has rendered the end of the mix. Safe to call from any thread.
+     
+     @return Result of the check */
+    bool hasEnded() { return ended.load(); }
+    
+    /** Render thread loop, which keeps the ring topped up while the mix is playing. */
+    void run() override;
+    
+    /** Copies rendered audio into the output buffer. Only call from the audio thread - this is lock-free and doesn't allocate.
+     
+     @param[out] outputBuffer Buffer to fill with rendered audio (any samples that aren't ready are left untouched)
+     @param[out] info Information about the last block read from, e.g. so the audible playheads can be shown
+     
+     @return Number of samples copied */
+    int read(const juce::AudioSourceChannelInfo& outputBuffer, RenderedBlockInfo& info);
+    
+    /** Fetches the number of rendered blocks waiting to be played.
+     
+     @return Number of blocks */
+    int getNumBlocksReady() { return fifo.getNumReady(); }
+    
+private:
+    
+    /** Clears the ring. Only call while neither the render thread nor the audio thread is using it. */
+    void reset();
+    
+    /** Calculates the number of blocks that must be ready before playback starts, which covers at least
+     RENDER_AHEAD_PRIME_DEVICE_BLOCKS of the audio device's blocks.
+     
+     @return Number of blocks */
+    int getNumPrimeBlocks();
+    
+    
+    AudioProcessor* processor = nullptr; ///< Pointer to the top-level audio processor
+    
+    juce::AbstractFifo fifo { RENDER_AHEAD_NUM_BLOCKS }; ///< Lock-free FIFO that manages the read/write positions in the ring (in blocks)
+    juce::AudioBuffer<float> ring; ///< Rendered stereo audio, RENDER_AHEAD_BLOCK_SIZE samples per block
+    RenderedBlockInfo blockInfo[RENDER_AHEAD_NUM_BLOCKS]; ///< Information about each block in the ring
+    
+    std::atomic<juce::int64> numWritten {0}; ///< Total number of blocks rendered
+    std::atomic<juce::int64> staleUntil {0}; ///< Number of blocks rendered before the last change to the mix (these are skipped by the reader)
+    std::atomic<juce::int64> discardUntil {0}; ///< Number of blocks rendered before the last reset (these are dropped by the reader straight away)
+    
+    std::atomic<bool> resetRequested {false}; ///< Indicates that the render thread should mark the ring as discarded (see restart())
+    std::atomic<bool> ended {false}; ///< Indicates that the end of the mix has been rendered (published by the render thread)
+    std::atomic<int> deviceBlockSize {RENDER_AHEAD_BLOCK_SIZE}; ///< Number of samples the audio callback reads at a time
+    
+    juce::int64 numRead = 0; ///< Total number of blocks played (audio thread only)
+    int readOffset = 0; ///< Number of samples already played from the block at the front of the ring (audio thread only)
+    bool primed = false; ///< Indicates whether enough blocks have been rendered to start playing (audio thread only)
+    
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RenderAhead) ///< JUCE macro to add a memory leak detector
+};
+
+#endif /* RenderAhead_hpp */
@@ -19,9 +19,9 @@ SqlDatabase::~SqlDatabase()
 }
 
 
-bool SqlDatabase::initialise(juce::File directory)
+bool SqlDatabase::initialise(juce::File directory, juce::String filename)
 {
-    juce::File dbFile = juce::File(directory.getFullPathName() + "/" + DATABASE_FILENAME);
+    juce::File dbFile = juce::File(directory.getFullPathName() + "/" + filename);
     
     if (!dbFile.existsAsFile())
         DBG("Creating new database file");
@@ -35,6 +35,8 @@ bool SqlDatabase::initialise(juce::File directory)
     else
     {
         database = db;
+        // Several processes may analyse the same library at once (see AnalysisWorkerPool), so wait for each other's writes
+        sqlite3_busy_timeout(db, DATABASE_BUSY_TIMEOUT_MS);
         createTable();
         initialised = true;
         return true;
@@ -49,8 +51,13 @@ void SqlDatabase::store(TrackInfo data)
     if (!initialised) jassert(false);
     
     std::stringstream ss;
-    ss << "REPLACE INTO Library VALUES('" \
-    << toSqlSafe(data.getFilename()) << "','" << data.hash << "','" << toSqlSafe(data.getArtist()) << "','" << toSqlSafe(data.getTitle()) << "'," << data.length << "," << data.analysed << "," << data.bpm << "," << data.beatPhase << "," << data.downbeat << "," << data.key << "," << data.groove << ")";
+    ss << "REPLACE INTO Library (" << getColumns() << ") VALUES('" \
+    << toSqlSafe(data.getFilename()) << "','" << data.hash << "','" << toSqlSafe(data.getArtist()) << "','" << toSqlSafe(data.getTitle()) << "'," << data.length << "," << data.analysed << "," << data.bpm << "," << data.beatPhase << "," << data.downbeat << "," << data.key << "," << data.groove;
+    
+    for (int i = 0; i < NUM_ANALYSIS_FEATURES; i++)
+        ss << "," << data.featureVersions[i] << "," << data.featureConfigs[i];
+    
+    ss << "," << encodeSegments(data) << ")";
     
     execute(ss.str());
 }
@@ -58,19 +65,85 @@ void SqlDatabase::store(TrackInfo data)
 
 TrackInfo SqlDatabase::read(juce::String filename)
 {
-    TrackInfo data;
-    int errCode;
-    char *zErrMsg = 0;
+    std::stringstream ss;
+    ss << "SELECT " << getColumns() << " FROM Library WHERE Filename = '" << toSqlSafe(filename) << "'";
+    
+    return query(ss.str());
+}
+
+
+TrackInfo SqlDatabase::readByHash(int hash)
+{
+    // The hash index makes this a lookup rather than a scan of the whole table
+    // (a fully analysed copy is preferred, but a copy with only some current features is still worth reusing)
+    std::stringstream ss;
+    ss << "SELECT " << getColumns() << " FROM Library WHERE hash = " << hash << " ORDER BY analysed DESC LIMIT 1";
+    
+    return query(ss.str());
+}
+
+
+void SqlDatabase::storeWaveform(int hash, const juce::MemoryBlock& waveform)
+{
+    if (!initialised) jassert(false);
+    
     sqlite3_stmt *statement;
     
+    // The waveform is bound rather than written into the statement, since it is several hundred kilobytes
+    if (sqlite3_prepare_v2((sqlite3*)database, "REPLACE INTO Waveforms (hash, data) VALUES(?, ?)", -1, &statement, 0) != SQLITE_OK)
+    {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg((sqlite3*)database));
+        return;
+    }
+    
+    sqlite3_bind_int(statement, 1, hash);
+    sqlite3_bind_blob(statement, 2, waveform.getData(), (int)waveform.getSize(), SQLITE_STATIC);
+    
+    if (sqlite3_step(statement) != SQLITE_DONE)
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg((sqlite3*)database));
+    
+    sqlite3_finalize(statement);
+}
+
+
+bool SqlDatabase::readWaveform(int hash, juce::MemoryBlock& waveform)
+{
     if (!initialised) jassert(false);
     
+    bool found = false;
+    sqlite3_stmt *statement;
+    
     std::stringstream ss;
-    ss << "SELECT * FROM Library WHERE Filename = '" << toSqlSafe(filename) << "'";
+    ss << "SELECT data FROM Waveforms WHERE hash = " << hash;
     
-    execute(ss.str());
+    if (sqlite3_prepare_v2((sqlite3*)database, ss.str().c_str(), -1, &statement, 0) != SQLITE_OK)
+    {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg((sqlite3*)database));
+        return false;
+    }
+    
+    if (sqlite3_step(statement) == SQLITE_ROW)
+    {
+        waveform.replaceAll(sqlite3_column_blob(statement, 0), (size_t)sqlite3_column_bytes(statement, 0));
+        found = true;
+    }
+    
+    sqlite3_finalize(statement);
     
-    errCode = sqlite3_prepare_v2((sqlite3*)database, ss.str().c_str(), -1, &statement, 0);
+    return found;
+}
+
+
+TrackInfo SqlDatabase::query(juce::String sql)
+{
+    TrackInfo data;
+    int errCode;
+    char *zErrMsg = 0;
+    sqlite3_stmt *statement;
+    
+    if (!initialised) jassert(false);
+    
+    errCode = sqlite3_prepare_v2((sqlite3*)database, sql.toRawUTF8(), -1, &statement, 0);
     if (errCode != SQLITE_OK)
     {
        fprintf(stderr, "SQL error: %s\n", zErrMsg);
@@ -91,6 +164,15 @@ TrackInfo SqlDatabase::read(juce::String filename)
         data.downbeat = sqlite3_column_int(statement, 8);
         data.key = sqlite3_column_int(statement, 9);
         data.groove = sqlite3_column_double(statement, 10);
+        
+        for (int i = 0; i < NUM_ANALYSIS_FEATURES; i++)
+        {
+            data.featureVersions[i] = sqlite3_column_int(statement, 11 + 2*i);
+            data.featureConfigs[i] = sqlite3_column_int(statement, 12 + 2*i);
+        }
+        
+        int segmentsColumn = 11 + 2*NUM_ANALYSIS_FEATURES;
+        decodeSegments(sqlite3_column_blob(statement, segmentsColumn), sqlite3_column_bytes(statement, segmentsColumn), data);
     }
     
     sqlite3_finalize(statement);
@@ -101,6 +183,7 @@ TrackInfo SqlDatabase::read(juce::String filename)
 
 void SqlDatabase::createTable()
 {
+    // This is the original (version 1) schema - later changes are applied by migrate(), so that existing databases are upgraded too
     execute("CREATE TABLE IF NOT EXISTS Library ("  \
                            "filename TEXT UNIQUE NOT NULL," \
                            "hash INT NOT NULL," \
@@ -113,10 +196,191 @@ void SqlDatabase::createTable()
                            "downbeat INT," \
                            "key INT," \
                            "groove REAL)");
+    
+    int version = readInt("PRAGMA user_version");
+    
+    while (version < DATABASE_SCHEMA_VERSION)
+    {
+        // Several processes may open the same database at once (see AnalysisWorkerPool), so each migration is applied
+        // in a write transaction, and the version is checked again inside it, in case another process got there first
+        if (!execute("BEGIN IMMEDIATE"))
+        {
+            jassert(false); // Database is locked, so it can't be upgraded
+            return;
+        }
+        
+        version = readInt("PRAGMA user_version");
+        
+        if (version < DATABASE_SCHEMA_VERSION)
+        {
+            if (!migrate(version + 1))
+            {
+                jassert(false); // Migration failed, so leave the database at its current version
+                execute("ROLLBACK");
+                return;
+            }
+            
+            version += 1;
+            execute("PRAGMA user_version = " + juce::String(version));
+        }
+        
+        execute("COMMIT");
+    }
+}
+
+
+bool SqlDatabase::migrate(int version)
+{
+    DBG("Upgrading database to schema version " << version);
+    
+    switch (version)
+    {
+        case 2:
+            // Renamed/moved files, and tracks in other music folders, are found by the hash of their content
+            return execute("CREATE INDEX IF NOT EXISTS LibraryHash ON Library (hash)");
+        
+        case 3:
+        {
+            // Record the analyser version and configuration behind each feature, so that only stale features are recomputed
+            // (features added later have their own migrations, so this only covers those that existed at this version)
+            for (int i = 0; i <= (int)AnalysisFeature::segments; i++)
+            {
+                if (!addFeatureColumns((AnalysisFeature)i))
+                    return false;
+            }
+            
+            // Existing analysis was produced by the first version of each analyser, and (as far as can be known) the current configuration
+            // (segments weren't stored at this version, so they are left stale)
+            for (int i = 0; i < (int)AnalysisFeature::segments; i++)
+            {
+                AnalysisFeature feature = (AnalysisFeature)i;
+                juce::String name = AnalysisFeatures::getName(feature);
+                
+                if (!execute("UPDATE Library SET " + name + "Version = 1, " + name + "Config = " + juce::String(AnalysisFeatures::getConfigHash(feature)) + " WHERE analysed = 1"))
+                    return false;
+            }
+            
+            return true;
+        }
+        
+        case 4:
+            // Segment boundaries, found during analysis rather than when a track is mixed (see encodeSegments())
+            return execute("ALTER TABLE Library ADD COLUMN segments BLOB");
+        
+        case 5:
+            // Waveform overviews, which are kept in their own table (by hash) so that reading the library doesn't load them
+            return addFeatureColumns(AnalysisFeature::waveform)
+                && execute("CREATE TABLE IF NOT EXISTS Waveforms (hash INT PRIMARY KEY, data BLOB NOT NULL)");
+        
+        default:
+            jassert(false); // No migration to this version
+            return false;
+    }
+}
+
+
+bool SqlDatabase::addFeatureColumns(AnalysisFeature feature)
+{
+    juce::String name = AnalysisFeatures::getName(feature);
+    
+    return execute("ALTER TABLE Library ADD COLUMN " + name + "Version INT NOT NULL DEFAULT 0")
+        && execute("ALTER TABLE Library ADD COLUMN " + name + "Config INT NOT NULL DEFAULT 0");
+}
+
+
+juce::String SqlDatabase::getColumns()
+{
+    juce::String columns = "filename, hash, artist, title, length, analysed, bpm, beatPhase, downbeat, key, groove";
+    
+    for (int i = 0; i < NUM_ANALYSIS_FEATURES; i++)
+    {
+        juce::String name = AnalysisFeatures::getName((AnalysisFeature)i);
+        columns << ", " << name << "Version, " << name << "Config";
+    }
+    
+    columns << ", segments";
+    
+    return columns;
+}
+
+
+juce::String SqlDatabase::encodeSegments(const TrackInfo& data)
+{
+    juce::MemoryBlock blob;
+    int previous = 0;
+    
+    for (int i = 0; i < data.numSegments; i++)
+    {
+        juce::uint32 delta = juce::uint32(data.segmentBars[i] - previous);
+        previous = data.segmentBars[i];
+        
+        // Seven bits per byte, with the top bit set on every byte but the last
+        do
+        {
+            juce::uint8 byte = delta & 0x7f;
+            delta >>= 7;
+            
+            if (delta != 0)
+                byte |= 0x80;
+            
+            blob.append(&byte, 1);
+        }
+        while (delta != 0);
+    }
+    
+    return "X'" + juce::String::toHexString(blob.getData(), (int)blob.getSize(), 0) + "'";
+}
+
+
+void SqlDatabase::decodeSegments(const void* blob, int size, TrackInfo& data)
+{
+    const juce::uint8* bytes = static_cast<const juce::uint8*>(blob);
+    juce::uint32 delta = 0;
+    int shift = 0;
+    int bar = 0;
+    
+    data.numSegments = 0;
+    
+    for (int i = 0; i < size && data.numSegments < TRACK_SEGMENTS_MAX; i++)
+    {
+        delta |= juce::uint32(bytes[i] & 0x7f) << shift;
+        shift += 7;
+        
+        // The last byte of each boundary has its top bit clear
+        if ((bytes[i] & 0x80) == 0)
+        {
+            bar += int(delta);
+            data.segmentBars[data.numSegments] = bar;
+            data.numSegments += 1;
+            
+            delta = 0;
+            shift = 0;
+        }
+    }
 }
 
 
-void SqlDatabase::execute(juce::String statement)
+int SqlDatabase::readInt(juce::String sql)
+{
+    int value = 0;
+    sqlite3_stmt *statement;
+    
+    if (sqlite3_prepare_v2((sqlite3*)database, sql.toRawUTF8(), -1, &statement, 0) != SQLITE_OK)
+    {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg((sqlite3*)database));
+        return value;
+    }
+    
+    if (sqlite3_step(statement) == SQLITE_ROW)
+        value = sqlite3_column_int(statement, 0);
+    
+    sqlite3_finalize(statement);
+    
+    return value;
+}
+
+
+bool SqlDatabase::execute(juce::String statement)
 {
     int errCode;
     char *zErrMsg = 0;
@@ -127,5 +391,8 @@ void SqlDatabase::execute(juce::String statement)
     {
        fprintf(stderr, "SQL error: %s\n", zErrMsg);
        sqlite3_free(zErrMsg);
+       return false;
     }
+    
+    return true;
 }
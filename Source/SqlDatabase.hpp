@@ -13,6 +13,9 @@
 
 
 #define DATABASE_FILENAME (".AutoDjData.db") ///< Filename for database, which is stored in the user's chosen music folder. The leading '.' hides the file on Mac.
+#define SHARED_DATABASE_FILENAME ("SharedAnalysis.db") ///< Filename for the optional user-level analysis store, shared by every music folder (see DataManager::setSharedStore())
+#define DATABASE_BUSY_TIMEOUT_MS (5000) ///< Time to wait for another process to finish writing to the database, before a statement fails
+#define DATABASE_SCHEMA_VERSION (5) ///< Current version of the database schema, stored in SQLite's user_version (see SqlDatabase::migrate())
 
 
 /**
@@ -31,9 +34,10 @@ public:
     /** Initialises the database at the given directory. This creates a new database file if one doesn't already exist.
      
      @param[in] directory Folder in which to keep database
+     @param[in] filename Name of the database file
      
      @return False if unsuccessful */
-    bool initialise(juce::File directory);
+    bool initialise(juce::File directory, juce::String filename = DATABASE_FILENAME);
     
     /** Stores or updates track data in the database file.
      If an entry with the same filename already exists, it will be replaced with the provided data.
@@ -46,18 +50,94 @@ public:
      
      @return Existing track data from database */
     TrackInfo read(juce::String filename);
+    
+    /** Searches the database for analysis of the given audio content, stored under any filename
+     (e.g. before the file was renamed or moved, or in another music folder).
+     A fully analysed entry is preferred, but the entry returned may have stale features (see AnalysisFeatures::getStaleFeatures()).
+     If returned hash is 0, no track with this content is present in the database.
+     
+     @param[in] hash Hash of the audio file (see DataManager::getHash())
+     
+     @return Existing track data from database */
+    TrackInfo readByHash(int hash);
+    
+    /** Stores or updates the waveform overview of the given audio content (see AnalyserWaveform).
+     
+     @param[in] hash Hash of the audio file (see DataManager::getHash())
+     @param[in] waveform Waveform data to store */
+    void storeWaveform(int hash, const juce::MemoryBlock& waveform);
+    
+    /** Searches the database for the waveform overview of the given audio content.
+     
+     @param[in] hash Hash of the audio file (see DataManager::getHash())
+     @param[out] waveform Output location for the waveform data
+     
+     @return True if the waveform was found */
+    bool readWaveform(int hash, juce::MemoryBlock& waveform);
       
 private:
     
     /** Executes the provided SQL statement and prints any errors that are returned.
      
-     @param[in] statement SQL statement to execute */
-    void execute(juce::String statement);
+     @param[in] statement SQL statement to execute
+     
+     @return False if the statement failed */
+    bool execute(juce::String statement);
     
-    /** Creates the Library table in the database file, for storing all track information.
-     If the table already exists, nothing happens. */
+    /** Runs a query which returns a single integer (e.g. a PRAGMA).
+     
+     @param[in] sql SQL query to run
+     
+     @return First column of the first row, or 0 if no row was returned */
+    int readInt(juce::String sql);
+    
+    /** Encodes a track's segment boundaries compactly, as a BLOB literal: each boundary is stored as the number of bars since
+     the one before it, as an unsigned LEB128 varint, so a typical track needs one byte per segment.
+     
+     @param[in] data Track whose segments to encode
+     
+     @return SQL BLOB literal */
+    static juce::String encodeSegments(const TrackInfo& data);
+    
+    /** Decodes segment boundaries that were encoded by encodeSegments().
+     
+     @param[in] blob Encoded segments
+     @param[in] size Size of the encoded segments, in bytes
+     @param[out] data Track to store the segments in */
+    static void decodeSegments(const void* blob, int size, TrackInfo& data);
+    
+    /** Adds the columns which record the analyser version and configuration behind a feature.
+     
+     @param[in] feature Feature to add the columns for
+     
+     @return False if the columns couldn't be added */
+    bool addFeatureColumns(AnalysisFeature feature);
+    
+    /** Generates the list of columns of the Library table that are stored and read, in the order used by store() and query().
+     
+     @return Comma-separated column names */
+    juce::String getColumns();
+    
+    /** Runs a query which selects rows of the Library table, and parses the first row returned.
+     
+     @param[in] sql SQL query to run
+     
+     @return Track data from the first row, or default track data (with a hash of 0) if no row was returned */
+    TrackInfo query(juce::String sql);
+    
+    /** Creates the Library table in the database file, for storing all track information, if it doesn't already exist.
+     The database is then upgraded to DATABASE_SCHEMA_VERSION, one migration at a time. */
     void createTable();
     
+    /** Upgrades the database schema by one version.
+     Each schema change must be added here as a new version (and DATABASE_SCHEMA_VERSION incremented),
+     rather than changing the Library table in createTable(), so that existing databases are upgraded in the same way as new ones.
+     
+     @param[in] version Schema version to upgrade to (from the version before it)
+     
+     @return False if the migration failed */
+    bool migrate(int version);
+    
     /** Single apostrophes in SQL statement cause problems, so we convert
      them to double apostrophes before passing any strings to SQL.
      
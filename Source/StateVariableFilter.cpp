@@ -0,0 +1,112 @@
+//
+//  StateVariableFilter.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "StateVariableFilter.hpp"
+
+#include "CommonDefs.hpp"
+
+
+StateVariableFilter::StateVariableFilter()
+{
+    // Fetch the table here, so that it is never built on the audio thread
+    table = getTable();
+    
+    reset();
+}
+
+
+void StateVariableFilter::reset()
+{
+    for (int channel = 0; channel < SVF_MAX_CHANNELS; channel++)
+        ic1eq[channel] = ic2eq[channel] = 0.f;
+}
+
+
+void StateVariableFilter::processHighPass(float* const* channels, int numChannels, int numSamples, const float* cutoff, const float* gain)
+{
+    jassert(numChannels > 0 && numChannels <= SVF_MAX_CHANNELS);
+    
+    if (numSamples <= 0) return;
+    
+    // If the filter is off for the whole block, bypass it, only applying the gain
+    // Its state is reset, since the integrators would otherwise hold an offset once the cut-off reaches zero
+    if (cutoff[0] < SVF_MIN_FREQUENCY && cutoff[numSamples - 1] < SVF_MIN_FREQUENCY)
+    {
+        reset();
+        
+        if (gain != nullptr)
+            for (int channel = 0; channel < numChannels; channel++)
+                juce::FloatVectorOperations::multiply(channels[channel], gain, numSamples);
+        
+        return;
+    }
+    
+    const float k = float(1.0 / SVF_Q);
+    
+    for (int i = 0; i < numSamples; i++)
+    {
+        float frequency = juce::jlimit(float(SVF_MIN_FREQUENCY), float(SVF_MAX_FREQUENCY), cutoff[i]);
+        float inputGain = (gain != nullptr) ? gain[i] : 1.f;
+        
+        // Interpolate the coefficients from the table entries either side of the current cut-off
+        int index = juce::jmin(int(frequency), SVF_MAX_FREQUENCY - 1);
+        float fraction = frequency - index;
+        const Coefficients& lower = table[index];
+        const Coefficients& upper = table[index + 1];
+        
+        float a1 = lower.a1 + fraction * (upper.a1 - lower.a1);
+        float a2 = lower.a2 + fraction * (upper.a2 - lower.a2);
+        float a3 = lower.a3 + fraction * (upper.a3 - lower.a3);
+        
+        for (int channel = 0; channel < numChannels; channel++)
+        {
+            float v0 = channels[channel][i] * inputGain;
+            
+            // Trapezoidal integration of both integrators (see Zavalishin, "The Art of VA Filter Design")
+            float v3 = v0 - ic2eq[channel];
+            float v1 = a1 * ic1eq[channel] + a2 * v3;
+            float v2 = ic2eq[channel] + a2 * ic1eq[channel] + a3 * v3;
+            ic1eq[channel] = 2.f * v1 - ic1eq[channel];
+            ic2eq[channel] = 2.f * v2 - ic2eq[channel];
+            
+            // The high-pass output is the input minus the band- and low-pass outputs
+            channels[channel][i] = v0 - k * v1 - v2;
+        }
+    }
+    
+    for (int channel = 0; channel < numChannels; channel++)
+    {
+        JUCE_SNAP_TO_ZERO(ic1eq[channel]);
+        JUCE_SNAP_TO_ZERO(ic2eq[channel]);
+    }
+}
+
+
+const StateVariableFilter::Coefficients* StateVariableFilter::getTable()
+{
+    // Built once, the first time any filter is constructed (static initialisation is thread-safe)
+    static const std::vector<Coefficients> table = []() {
+        std::vector<Coefficients> coefficients(SVF_MAX_FREQUENCY + 1);
+        
+        double k = 1.0 / SVF_Q;
+        
+        for (int frequency = 0; frequency <= SVF_MAX_FREQUENCY; frequency++)
+        {
+            // Pre-warped cut-off, as in the bilinear transform
+            double g = std::tan(juce::MathConstants<double>::pi * frequency / SUPPORTED_SAMPLERATE);
+            double a1 = 1.0 / (1.0 + g * (g + k));
+            
+            coefficients[frequency].a1 = float(a1);
+            coefficients[frequency].a2 = float(g * a1);
+            coefficients[frequency].a3 = float(g * g * a1);
+        }
+        
+        return coefficients;
+    }();
+    
+    return table.data();
+}
@@ -0,0 +1,76 @@
+//
+//  StateVariableFilter.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef StateVariableFilter_hpp
+#define StateVariableFilter_hpp
+
+#include <JuceHeader.h>
+
+
+#define SVF_MAX_CHANNELS (2) ///< Maximum number of channels the filter can process
+#define SVF_MIN_FREQUENCY (1.0) ///< Lowest cut-off frequency, in Hz - the filter is bypassed below this
+#define SVF_MAX_FREQUENCY (1000) ///< Highest cut-off frequency, in Hz, which is the extent of the coefficient table
+#define SVF_Q (1.0) ///< Resonance of the filter, which matches the juce::IIRCoefficients::makeHighPass() filter it replaced
+
+
+/**
+ High-pass filter designed to have its cut-off moved while it runs, such as the crossfade filter in TrackProcessor.
+ 
+ This is a topology-preserving transform (TPT) state-variable filter, whose state stays valid when its coefficients change
+ every sample, unlike a biquad. The cut-off is given per sample (see Automation), so there are no steps in the sweep,
+ and the coefficients are interpolated from a table (with 1 Hz resolution) built once, so no trig functions are called while processing.
+ A gain ramp can also be applied in the same pass.
+ */
+class StateVariableFilter
+{
+public:
+    
+    /** Constructor. */
+    StateVariableFilter();
+    
+    /** Destructor. */
+    ~StateVariableFilter() {}
+    
+    /** Resets the state of the filter, ready for new audio. */
+    void reset();
+    
+    /** High-pass filters a block of audio in place, with a cut-off frequency for each sample.
+     The cut-off should be a ramp (see Automation::renderLinear()): if it is below SVF_MIN_FREQUENCY at both ends of the block,
+     the filter is bypassed and reset.
+     
+     @param[in,out] channels Pointers to the audio of each channel
+     @param[in] numChannels Number of channels (up to SVF_MAX_CHANNELS)
+     @param[in] numSamples Number of samples to process in each channel
+     @param[in] cutoff Cut-off frequency of each sample, in Hz
+     @param[in] gain Gain to apply to each sample before it is filtered, or nullptr for none */
+    void processHighPass(float* const* channels, int numChannels, int numSamples, const float* cutoff, const float* gain = nullptr);
+    
+private:
+    
+    /** Coefficients of the filter at a given cut-off frequency. */
+    typedef struct Coefficients {
+        float a1; ///< Gain applied to the first integrator state
+        float a2; ///< Gain applied to the input of the first integrator
+        float a3; ///< Gain applied to the input of the second integrator
+    } Coefficients;
+    
+    /** Fetches the table of coefficients at every whole frequency from 0 to SVF_MAX_FREQUENCY Hz,
+     which is built the first time it is used.
+     
+     @return Pointer to the first entry (SVF_MAX_FREQUENCY + 1 entries) */
+    static const Coefficients* getTable();
+    
+    const Coefficients* table; ///< Coefficient table (see getTable())
+    
+    float ic1eq[SVF_MAX_CHANNELS]; ///< State of the first integrator, for each channel
+    float ic2eq[SVF_MAX_CHANNELS]; ///< State of the second integrator, for each channel
+    
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StateVariableFilter) ///< JUCE macro to add a memory leak detector
+};
+
+#endif /* StateVariableFilter_hpp */
@@ -0,0 +1,100 @@
+//
+//  StretchProfiles.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "StretchProfiles.hpp"
+
+#include "CommonDefs.hpp"
+#include "TimeStretcher.hpp"
+
+namespace StretchProfiles {
+
+
+static const StretchProfile profiles[StretchQuality::numStretchQualities] = {
+    { "low", 60, 10, 8, true, true },
+    { "medium", 0, 0, 8, true, false },
+    { "high", 0, 0, 8, false, false }
+};
+
+static std::atomic<int> defaultQuality { StretchQuality::stretchHigh };
+
+
+const StretchProfile& getProfile(StretchQuality quality)
+{
+    jassert(quality >= 0 && quality < StretchQuality::numStretchQualities);
+    return profiles[quality];
+}
+
+
+bool findQuality(const juce::String& name, StretchQuality& quality)
+{
+    for (int i = 0; i < StretchQuality::numStretchQualities; i++)
+    {
+        if (name.equalsIgnoreCase(profiles[i].name))
+        {
+            quality = (StretchQuality)i;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+
+void setDefaultQuality(StretchQuality quality)
+{
+    defaultQuality.store(quality);
+}
+
+
+StretchQuality getDefaultQuality()
+{
+    return (StretchQuality)defaultQuality.load();
+}
+
+
+juce::String benchmark()
+{
+    // Use white noise as the test audio, so that the overlap search has no easy answer
+    int numSamples = STRETCH_BENCHMARK_SECONDS * SUPPORTED_SAMPLERATE;
+    juce::AudioBuffer<float> audio(2, numSamples);
+    juce::AudioBuffer<float> output(2, STRETCH_BENCHMARK_BLOCK_SIZE);
+    juce::Random random(1);
+    
+    for (int channel = 0; channel < audio.getNumChannels(); channel++)
+        for (int i = 0; i < numSamples; i++)
+            audio.setSample(channel, i, random.nextFloat() * 2.f - 1.f);
+    
+    juce::String text;
+    
+    for (int i = 0; i < StretchQuality::numStretchQualities; i++)
+    {
+        TimeStretcher stretcher;
+        stretcher.setQuality((StretchQuality)i);
+        stretcher.prepare(STRETCH_BENCHMARK_BLOCK_SIZE);
+        
+        // Stretch slightly faster, as during a transition (at original tempo, SoundTouch is bypassed)
+        stretcher.update(120.0, 126.0);
+        
+        // Leave a block's margin at the end of the input, since SoundTouch reads ahead
+        int numBlocks = int(numSamples / (1.05 * STRETCH_BENCHMARK_BLOCK_SIZE)) - 1;
+        juce::int64 start = juce::Time::getHighResolutionTicks();
+        
+        for (int block = 0; block < numBlocks; block++)
+            stretcher.process(&audio, &output, STRETCH_BENCHMARK_BLOCK_SIZE);
+        
+        double seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        double msPerSecond = 1000.0 * seconds / (double(numBlocks * STRETCH_BENCHMARK_BLOCK_SIZE) / SUPPORTED_SAMPLERATE);
+        
+        text << profiles[i].name << ": " << juce::String(msPerSecond, 2) << " ms CPU per second of audio ("
+             << juce::String(100.0 * msPerSecond / 1000.0, 2) << "% of one core per deck)" << juce::newLine;
+    }
+    
+    return text;
+}
+
+
+}
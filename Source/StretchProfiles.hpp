@@ -0,0 +1,78 @@
+//
+//  StretchProfiles.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef StretchProfiles_hpp
+#define StretchProfiles_hpp
+
+#include <JuceHeader.h>
+
+
+#define STRETCH_BENCHMARK_SECONDS (30) ///< Length of audio stretched to benchmark each profile
+#define STRETCH_BENCHMARK_BLOCK_SIZE (512) ///< Size of the audio blocks in the benchmark, as in the audio callback
+
+
+/** Quality tiers of time stretching, from cheapest to best. */
+enum StretchQuality : int
+{
+    stretchLow, ///< For low-power machines: mono, with short searches
+    stretchMedium, ///< Stereo, with SoundTouch's quick seek
+    stretchHigh, ///< Stereo, with SoundTouch's full seek (its default settings)
+    numStretchQualities
+};
+
+
+/** SoundTouch settings for one quality tier (see SoundTouch's SETTING_* documentation for details). */
+typedef struct StretchProfile
+{
+    const char* name; ///< Name, as used on the command line
+    int sequenceMs; ///< Length of the audio sequences that are stretched, or 0 to choose automatically from the tempo
+    int seekWindowMs; ///< Length of the window searched for the best overlap position, or 0 to choose automatically
+    int overlapMs; ///< Length of the crossfade between sequences
+    bool quickSeek; ///< Indicates whether to use a faster, less thorough overlap search
+    bool mono; ///< Indicates whether to stretch a mono downmix rather than both channels
+} StretchProfile;
+
+
+/**
+ Quality profiles for TimeStretcher. The quality used by a deployment is chosen at launch (e.g. --stretch-quality=low),
+ and AudioProcessor drops to a cheaper profile automatically if the audio load stays high (see AudioProcessor::updateStretchQuality()).
+ */
+namespace StretchProfiles {
+
+/** Fetches the settings of a quality tier.
+ 
+ @param[in] quality Quality tier
+ 
+ @return Profile settings */
+const StretchProfile& getProfile(StretchQuality quality);
+
+/** Finds a quality tier by name.
+ 
+ @param[in] name Name of the profile (e.g. "low")
+ @param[out] quality Quality tier with the given name
+ 
+ @return False if there is no profile with the given name */
+bool findQuality(const juce::String& name, StretchQuality& quality);
+
+/** Sets the quality that TimeStretchers use from the start of each performance.
+ 
+ @param[in] quality Quality tier */
+void setDefaultQuality(StretchQuality quality);
+
+/** Fetches the quality that TimeStretchers use from the start of each performance.
+ 
+ @return Quality tier (StretchQuality::stretchHigh unless set otherwise) */
+StretchQuality getDefaultQuality();
+
+/** Measures the cost of each profile by stretching white noise, so a deployment can choose the best one it can afford.
+ 
+ @return Report text, with the CPU time per second of audio for each profile */
+juce::String benchmark();
+
+}
+
+#endif /* StretchProfiles_hpp */
@@ -8,6 +8,9 @@
 #include "TimeStretcher.hpp"
 
 #include "CommonDefs.hpp"
+#include "Profiler.hpp"
+#include "Interleave.hpp"
+#include "RealtimeSafety.hpp"
 
 
 TimeStretcher::TimeStretcher()
@@ -16,13 +19,9 @@ TimeStretcher::TimeStretcher()
     // globally-supported sample rate
     shifter.setSampleRate(SUPPORTED_SAMPLERATE);
     
-    // Set the number of channels depending on
-    // the pre-processor mono/stereo macro
-#ifdef STRETCHER_MONO
-    shifter.setChannels(1);
-#else
-    shifter.setChannels(2);
-#endif
+    // Start with the quality chosen for this deployment
+    setQuality(StretchProfiles::getDefaultQuality());
+    applyProfile();
     
     reset();
 }
@@ -36,18 +35,43 @@ void TimeStretcher::prepare(int blockSize)
     // Effectively, we are saying the maximum stretch is a factor of 4
     const int maxInputOutputRatio = 4;
     
-    // Allocate audio buffer space for this maximum stretch
-#ifdef STRETCHER_MONO
-    inputInterleaved.setSize(1, blockSize * maxInputOutputRatio);
-    outputInterleaved.setSize(1, blockSize);
-#else
+    // Allocate audio buffer space for this maximum stretch (in stereo, so that any profile can be used)
     inputInterleaved.setSize(1, blockSize * maxInputOutputRatio * 2);
     outputInterleaved.setSize(1, blockSize * 2);
-#endif
+    directBuffer.setSize(2, blockSize);
 }
 
 
 int TimeStretcher::process(juce::AudioBuffer<float>* input, juce::AudioBuffer<float>* output, int numSamples)
+{
+    PROFILE_ZONE("stretch")
+    
+    // Switch profile if a different quality has been requested
+    if (requestedQuality.load() != quality.load())
+        applyProfile();
+    
+    // At original tempo there is nothing to stretch, so skip SoundTouch and copy the audio straight through
+    bool bypassNow = (timeStretch.load() == 1.0);
+    
+    // When switching to or from the bypass, crossfade between the two over this block, so there is no jump in the audio
+    // (except for the first block of a track, where there is nothing to fade from)
+    if (started && bypassNow != bypassed)
+    {
+        bypassed = bypassNow;
+        return bypassNow ? fadeToBypass(input, output, numSamples) : fadeFromBypass(input, output, numSamples);
+    }
+    
+    started = true;
+    bypassed = bypassNow;
+    
+    if (bypassNow)
+        return bypass(input, output, numSamples);
+    
+    return stretch(input, output, numSamples);
+}
+
+
+int TimeStretcher::stretch(juce::AudioBuffer<float>* input, juce::AudioBuffer<float>* output, int numSamples)
 {
     // Find the number of input samples that correspond to the requested number of output samples
     double ratio = shifter.getInputOutputSampleRatio();
@@ -55,13 +79,8 @@ int TimeStretcher::process(juce::AudioBuffer<float>* input, juce::AudioBuffer<fl
     
     // Ensure we have space in the processing buffers for this
     // (Throw a debug error if not)
-#ifdef STRETCHER_MONO
-    jassert(numInput <= inputInterleaved.getNumSamples());
-    jassert(numSamples <= outputInterleaved.getNumSamples());
-#else
     jassert(numInput*2 <= inputInterleaved.getNumSamples());
     jassert(numSamples*2 <= outputInterleaved.getNumSamples());
-#endif
     
     // The SoundTouch library has processing latency, meaning extra samples have be given in order to receive a certain number of output samples
     // Soundtouch::numSamples() returns the number of samples that the library has ready
@@ -103,6 +122,109 @@ int TimeStretcher::process(juce::AudioBuffer<float>* input, juce::AudioBuffer<fl
 }
 
 
+int TimeStretcher::bypass(juce::AudioBuffer<float>* input, juce::AudioBuffer<float>* output, int numSamples)
+{
+    // Copy as much of the block as the input has left, and silence any remainder
+    int numCopy = juce::jlimit(0, numSamples, input->getNumSamples() - 1 - playhead);
+    
+    for (int channel = 0; channel < 2; channel++)
+    {
+        output->copyFrom(channel, 0, *input, juce::jmin(channel, input->getNumChannels() - 1), playhead, numCopy);
+        output->clear(channel, numCopy, numSamples - numCopy);
+    }
+    
+    playhead += numCopy;
+    
+    return numCopy;
+}
+
+
+int TimeStretcher::fadeToBypass(juce::AudioBuffer<float>* input, juce::AudioBuffer<float>* output, int numSamples)
+{
+    // Finish the audio SoundTouch was producing, at the new tempo (which is the original tempo)
+    int numProcessed = stretch(input, output, numSamples);
+    
+    // Move back to the first input sample SoundTouch hasn't output, which is where the direct audio carries on from
+    clearToPlayhead();
+    
+    // The block SoundTouch just output ends at about that sample, so read the same part of the input directly
+    int end = playhead;
+    playhead = juce::jmax(0, end - numSamples);
+    bypass(input, &directBuffer, numSamples);
+    playhead = end;
+    
+    // Fade from the stretched audio to the direct audio
+    for (int channel = 0; channel < 2; channel++)
+    {
+        output->applyGainRamp(channel, 0, numSamples, 1.f, 0.f);
+        output->addFromWithRamp(channel, 0, directBuffer.getReadPointer(channel), numSamples, 0.f, 1.f);
+    }
+    
+    return numProcessed;
+}
+
+
+int TimeStretcher::fadeFromBypass(juce::AudioBuffer<float>* input, juce::AudioBuffer<float>* output, int numSamples)
+{
+    // Read the block directly, as if the stretcher were still bypassed
+    int start = playhead;
+    bypass(input, &directBuffer, numSamples);
+    
+    // Then start SoundTouch from the same point (it is empty, since it was cleared on entering the bypass)
+    playhead = start;
+    int numProcessed = stretch(input, output, numSamples);
+    
+    // Fade from the direct audio to the stretched audio
+    for (int channel = 0; channel < 2; channel++)
+    {
+        output->applyGainRamp(channel, 0, numSamples, 0.f, 1.f);
+        output->addFromWithRamp(channel, 0, directBuffer.getReadPointer(channel), numSamples, 1.f, 0.f);
+    }
+    
+    return numProcessed;
+}
+
+
+void TimeStretcher::clearToPlayhead()
+{
+    // The output samples still waiting in SoundTouch correspond to (output * stretch factor) input samples
+    int numBuffered = (int)shifter.numUnprocessedSamples() + juce::roundToInt(shifter.numSamples() * timeStretch.load());
+    
+    playhead = juce::jmax(0, playhead - numBuffered);
+    shifter.clear();
+}
+
+
+void TimeStretcher::setQuality(StretchQuality newQuality)
+{
+    requestedQuality.store(newQuality);
+}
+
+
+void TimeStretcher::applyProfile()
+{
+    // Changing the SoundTouch settings may reallocate its buffers, but this only happens
+    // when a deployment starts, or when the audio load forces a cheaper profile (see AudioProcessor::updateStretchQuality())
+    RealtimeSafety::ScopedAllow allow;
+    
+    StretchQuality newQuality = requestedQuality.load();
+    const StretchProfile& profile = StretchProfiles::getProfile(newQuality);
+    
+    // Audio buffered in SoundTouch may have the wrong number of channels for the new profile, so restart it from the playhead
+    clearToPlayhead();
+    
+    mono = profile.mono;
+    shifter.setChannels(mono ? 1 : 2);
+    
+    shifter.setSetting(SETTING_SEQUENCE_MS, profile.sequenceMs);
+    shifter.setSetting(SETTING_SEEKWINDOW_MS, profile.seekWindowMs);
+    shifter.setSetting(SETTING_OVERLAP_MS, profile.overlapMs);
+    shifter.setSetting(SETTING_USE_QUICKSEEK, profile.quickSeek ? 1 : 0);
+    
+    quality.store(newQuality);
+}
+
+
 void TimeStretcher::update(double bpmOriginal, double bpmTarget)
 {
     // Calculate time stretch factor, where 1.0 is original tempo, >1.0 is faster, and <1.0 is slower
@@ -125,6 +247,8 @@ void TimeStretcher::resetPlayhead(int sample)
 
 void TimeStretcher::reset()
 {
+    started = false;
+    
     shifter.clear();
     inputInterleaved.clear();
     outputInterleaved.clear();
@@ -133,34 +257,32 @@ void TimeStretcher::reset()
 
 void TimeStretcher::interleave(juce::AudioBuffer<float>* input, int numSamples)
 {
-#ifdef STRETCHER_MONO
-    inputInterleaved.copyFrom(0, 0, *input, 0, playhead, numSamples);
-#else
     jassert(input->getNumChannels() >= 2); // Input must be stereo!
     
-    // Place the stereo samples side by side in a single buffer
-    for (int i = 0; i < numSamples; i++)
+    if (mono)
     {
-        inputInterleaved.setSample(0, i*2, input->getSample(0, playhead + i));
-        inputInterleaved.setSample(0, i*2 + 1, input->getSample(1, playhead + i));
+        // Mix the stereo samples down to a single channel
+        inputInterleaved.copyFrom(0, 0, *input, 0, playhead, numSamples, 0.5f);
+        inputInterleaved.addFrom(0, 0, *input, 1, playhead, numSamples, 0.5f);
+        return;
     }
-#endif
+    
+    // Place the stereo samples side by side in a single buffer
+    Interleave::interleave(input->getReadPointer(0, playhead), input->getReadPointer(1, playhead), inputInterleaved.getWritePointer(0), numSamples);
 }
 
 
 void TimeStretcher::deinterleave(juce::AudioBuffer<float>* output, int numSamples)
 {
-#ifdef STRETCHER_MONO
-    output->copyFrom(0, 0, outputInterleaved.getReadPointer(0), numSamples);
-    output->copyFrom(1, 0, outputInterleaved.getReadPointer(0), numSamples);
-#else
     jassert(output->getNumChannels() >= 2); // Output must be stereo!
     
-    // Copy the side-by-side stereo samples into separate L&R buffer channels
-    for (int i = 0; i < numSamples; i++)
+    if (mono)
     {
-        output->setSample(0, i, outputInterleaved.getSample(0, i*2));
-        output->setSample(1, i, outputInterleaved.getSample(0, i*2 + 1));
+        output->copyFrom(0, 0, outputInterleaved.getReadPointer(0), numSamples);
+        output->copyFrom(1, 0, outputInterleaved.getReadPointer(0), numSamples);
+        return;
     }
-#endif
+    
+    // Copy the side-by-side stereo samples into separate L&R buffer channels
+    Interleave::deinterleave(outputInterleaved.getReadPointer(0), output->getWritePointer(0), output->getWritePointer(1), numSamples);
 }
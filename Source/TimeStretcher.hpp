@@ -10,10 +10,7 @@
 
 #include <JuceHeader.h>
 #include "ThirdParty/soundtouch/include/SoundTouch.h"
-
-
-// Enable the following macro to process only one audio channel
-//#define STRETCHER_MONO
+#include "StretchProfiles.hpp"
 
 
 /**
@@ -21,6 +18,14 @@
  Essentially a wrapper for the SoundTouch library, which requires interleaved input and output audio buffers.
  The SoundTouch library has processing latency, meaning extra samples have be given in order to receive a certain number of output samples.
  Therefore this class keeps its own playhead for tracking the number samples input.
+ 
+ At original tempo (a stretch factor of exactly 1.0), SoundTouch is bypassed and the audio is copied straight through.
+ This only happens while a track plays at its own tempo, e.g. the first track of a mix until its first transition,
+ or a track whose tempo matches the mix. Every other track keeps the tempo of the transition that brought it in,
+ so it is stretched the whole time it plays. Switching to or from the bypass crossfades between the two over one block.
+ 
+ The SoundTouch settings, and whether both channels are stretched or just a mono downmix, are chosen by a
+ quality profile (see StretchProfiles), which can be changed while audio is processed.
  */
 class TimeStretcher
 {
@@ -68,15 +73,69 @@ public:
     /** Resets the stretcher ready for a new track to be processed. */
     void reset();
     
+    /** Requests a quality profile, which is applied at the start of the next processing block.
+     Safe to call from any thread.
+     
+     @param[in] newQuality Quality tier to use */
+    void setQuality(StretchQuality newQuality);
+    
+    /** Fetches the quality profile in use.
+     
+     @return Quality tier */
+    StretchQuality getQuality() { return quality.load(); }
+    
 private:
     
-    /** Interleaves the provided input audio data.
+    /** Time-stretches the supplied audio data through SoundTouch.
+     
+     @param[in] input Pointer to input audio to be stretched
+     @param[in] output Pointer to buffer in which to place output audio
+     @param[in] numSamples Number of samples required in the output
+     
+     @return Number of input samples that correspond to the stretched output */
+    int stretch(juce::AudioBuffer<float>* input, juce::AudioBuffer<float>* output, int numSamples);
+    
+    /** Copies input audio straight to the output, for when the stretch factor is 1.0.
+     
+     @param[in] input Pointer to input audio
+     @param[in] output Pointer to buffer in which to place output audio
+     @param[in] numSamples Number of samples required in the output
+     
+     @return Number of input samples that correspond to the output */
+    int bypass(juce::AudioBuffer<float>* input, juce::AudioBuffer<float>* output, int numSamples);
+    
+    /** Switches to the bypass, crossfading from the audio still buffered in SoundTouch to the direct audio over one block.
+     SoundTouch is then cleared, and the playhead is left at the first input sample it hadn't output.
+     
+     @param[in] input Pointer to input audio
+     @param[in] output Pointer to buffer in which to place output audio
+     @param[in] numSamples Number of samples required in the output
+     
+     @return Number of input samples that correspond to the output */
+    int fadeToBypass(juce::AudioBuffer<float>* input, juce::AudioBuffer<float>* output, int numSamples);
+    
+    /** Switches from the bypass back to SoundTouch, crossfading from the direct audio to the stretched audio over one block.
+     
+     @param[in] input Pointer to input audio
+     @param[in] output Pointer to buffer in which to place output audio
+     @param[in] numSamples Number of samples required in the output
+     
+     @return Number of input samples that correspond to the output */
+    int fadeFromBypass(juce::AudioBuffer<float>* input, juce::AudioBuffer<float>* output, int numSamples);
+    
+    /** Clears SoundTouch, moving the playhead back over the input it held, so that the input is read again from there. */
+    void clearToPlayhead();
+    
+    /** Applies the requested quality profile to SoundTouch. */
+    void applyProfile();
+    
+    /** Interleaves the provided input audio data (or mixes it down, if the profile is mono).
      
      @param[in,out] input Pointer to input audio buffer
      @param[in] numSamples Number of stereo input samples to interleave */
     void interleave(juce::AudioBuffer<float>* input, int numSamples);
     
-    /** De-interleaves the provided output audio data.
+    /** De-interleaves the provided output audio data (or copies it to both channels, if the profile is mono).
     
     @param[in,out] input Pointer to output audio buffer
     @param[in] numSamples Number of stereo output samples to produce */
@@ -84,11 +143,18 @@ private:
     
     juce::AudioBuffer<float> inputInterleaved; ///< Intermediate buffer holding interleaved audio samples to be given to SoundTouch
     juce::AudioBuffer<float> outputInterleaved; ///< intermediate buffer to receive interleaved audio output from SoundTouch
+    juce::AudioBuffer<float> directBuffer; ///< Audio read straight from the input while crossfading to or from the bypass
     
     soundtouch::SoundTouch shifter; ///< Instance of SoundTouch time-stretcher
     
     std::atomic<double> timeStretch = 1.0; ///< Current time-stretch factor, where 1.0 is original tempo, >1.0 is faster, and <1.0 is slower
     int playhead = 0; ///< Current position in input audio (see class description)
+    bool bypassed = false; ///< Indicates whether the last block bypassed SoundTouch
+    bool started = false; ///< Indicates whether a block has been processed since the last reset (so there is audio to crossfade from)
+    
+    std::atomic<StretchQuality> quality { StretchQuality::stretchHigh }; ///< Quality profile in use
+    std::atomic<StretchQuality> requestedQuality { StretchQuality::stretchHigh }; ///< Quality profile to switch to at the next processing block
+    bool mono = false; ///< Indicates whether the profile in use stretches a mono downmix
 
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TimeStretcher) ///< JUCE macro to add a memory leak detector
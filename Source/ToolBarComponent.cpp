@@ -62,6 +62,9 @@ ToolBarComponent::ToolBarComponent(juce::Component* mainComp, AudioProcessor* ap
     volumeSld->setSkewFactor(0.7);
     volumeSld->setValue(1.f);
     
+    loadMeter.reset(new AudioLoadMeter(audioProcessor->getLoadMonitor()));
+    addAndMakeVisible(loadMeter.get());
+    
     settingsBtn.reset(new juce::ImageButton());
     addAndMakeVisible(settingsBtn.get());
     settingsBtn->setImages(false, true, true, settingsImg, 0.8f, {}, settingsImg, 1.f, {}, settingsImg, 1.f, juce::Colours::lightblue);
@@ -97,6 +100,9 @@ void ToolBarComponent::resized()
     volumeArea.setSize(22, 22);
     volumeArea.setCentre(volumeSld->getX() - 10, getHeight()/2);
     
+    loadMeter->setSize(90, 18);
+    loadMeter->setCentrePosition(volumeArea.getX() - 60, getHeight()/2);
+    
     settingsBtn->setSize(25, 25);
     settingsBtn->setCentrePosition(getWidth() - 25, getHeight()/2);
 }
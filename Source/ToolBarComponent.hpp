@@ -11,6 +11,7 @@
 #include <JuceHeader.h>
 #include "AudioProcessor.hpp"
 #include "ArtificialDJ.hpp"
+#include "AudioLoadMeter.hpp"
 #include "CommonDefs.hpp"
 
 
@@ -92,6 +93,8 @@ private:
     
     std::unique_ptr<juce::Slider> volumeSld; ///< Slider to control audio volume
     
+    std::unique_ptr<AudioLoadMeter> loadMeter; ///< Meter showing the audio processing load
+    
     juce::Colour colourBackground; ///< Base colour to paint as the background
     
     juce::Image playImg; ///< Image icon to render as the play/pause button while paused
@@ -0,0 +1,226 @@
+//
+//  Tracer.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "Tracer.hpp"
+
+#include "Profiler.hpp"
+#include "RealtimeSafety.hpp"
+
+
+/** A single traced zone. */
+struct TraceEvent
+{
+    const char* name; ///< Name of the zone
+    juce::int64 startTicks; ///< Time at which the zone began
+    juce::int64 endTicks; ///< Time at which the zone ended
+};
+
+
+/** Ring buffer of the events recorded on a single thread. Only the owning thread writes events. */
+struct TraceThread
+{
+    juce::String name; ///< Name of the thread, used in the trace
+    std::atomic<bool> active {true}; ///< False once the thread has exited, so its slot can be reused by a new thread with the same name
+    
+    TraceEvent events[TRACER_BUFFER_SIZE]; ///< Ring buffer of events, indexed by (event number % TRACER_BUFFER_SIZE)
+    std::atomic<juce::uint64> numWritten {0}; ///< Total number of events written since the thread was registered
+    juce::uint64 numCleared = 0; ///< Number of events that had been written at the last clear(), which are ignored
+};
+
+
+/** Thread-local handle to the calling thread's ring buffer, which marks it as inactive when the thread exits. */
+struct TraceThreadHandle
+{
+    ~TraceThreadHandle()
+    {
+        if (thread != nullptr)
+            thread->active.store(false);
+    }
+    
+    TraceThread* thread = nullptr; ///< Ring buffer for this thread, or nullptr if not yet registered
+    bool registrationFailed = false; ///< Indicates that too many threads were registered, so this one can't be traced
+};
+
+
+std::atomic<bool> tracerEnabled {false};
+std::atomic<juce::int64> tracerStartTicks {0};
+
+std::unique_ptr<TraceThread> tracerThreads[TRACER_MAX_THREADS];
+std::atomic<int> numTracerThreads {0};
+juce::CriticalSection tracerLock; // Only taken when registering threads and reading the trace, never when recording events
+
+thread_local TraceThreadHandle currentTraceThread;
+
+
+/** Fetches the ring buffer for the calling thread, registering it on first use.
+ 
+ @return Thread ring buffer, or nullptr if the maximum number of threads has been reached */
+static TraceThread* getCurrentThread()
+{
+    if (currentTraceThread.thread != nullptr)
+        return currentTraceThread.thread;
+    
+    if (currentTraceThread.registrationFailed)
+        return nullptr;
+    
+    // Registration allocates, but only happens once per thread, so don't flag it (see RealtimeSafety)
+    RealtimeSafety::ScopedAllow allowAllocation;
+    
+    // Use the same thread names as the profiler reports
+    juce::String name = Profiler::getCurrentThreadName();
+    
+    const juce::ScopedLock sl(tracerLock);
+    
+    int numThreads = numTracerThreads.load();
+    
+    // If a thread with the same name has exited, reuse its ring buffer, so that restarted threads appear on the same row of the trace
+    for (int i = 0; i < numThreads; i++)
+    {
+        TraceThread* thread = tracerThreads[i].get();
+        
+        if (!thread->active.load() && thread->name == name)
+        {
+            thread->active.store(true);
+            currentTraceThread.thread = thread;
+            return thread;
+        }
+    }
+    
+    if (numThreads >= TRACER_MAX_THREADS)
+    {
+        DBG("Tracer: too many threads, not tracing " << name);
+        currentTraceThread.registrationFailed = true;
+        return nullptr;
+    }
+    
+    tracerThreads[numThreads].reset(new TraceThread());
+    tracerThreads[numThreads]->name = name;
+    currentTraceThread.thread = tracerThreads[numThreads].get();
+    
+    // Publish the new thread, so that the trace can see it
+    numTracerThreads.store(numThreads + 1);
+    
+    return currentTraceThread.thread;
+}
+
+
+/** Converts a time in high-resolution ticks to microseconds since the start of the trace. */
+static double ticksToTraceTime(juce::int64 ticks)
+{
+    static const double microsecondsPerTick = 1.0e6 / juce::Time::getHighResolutionTicksPerSecond();
+    return (ticks - tracerStartTicks.load()) * microsecondsPerTick;
+}
+
+
+void Tracer::setEnabled(bool shouldBeEnabled)
+{
+    // Start the timeline when tracing is first enabled
+    if (shouldBeEnabled && tracerStartTicks.load() == 0)
+        tracerStartTicks.store(juce::Time::getHighResolutionTicks());
+    
+    tracerEnabled.store(shouldBeEnabled);
+}
+
+
+bool Tracer::isEnabled()
+{
+    return tracerEnabled.load(std::memory_order_relaxed);
+}
+
+
+void Tracer::clear()
+{
+    const juce::ScopedLock sl(tracerLock);
+    
+    // Ignore everything written so far (the writing threads don't need to know)
+    for (int i = 0; i < numTracerThreads.load(); i++)
+        tracerThreads[i]->numCleared = tracerThreads[i]->numWritten.load();
+    
+    tracerStartTicks.store(juce::Time::getHighResolutionTicks());
+}
+
+
+void Tracer::addEvent(const char* name, juce::int64 startTicks, juce::int64 endTicks)
+{
+    TraceThread* thread = getCurrentThread();
+    
+    if (thread == nullptr)
+        return;
+    
+    // Only this thread writes to the ring buffer, so a load and store is enough
+    juce::uint64 index = thread->numWritten.load(std::memory_order_relaxed);
+    
+    thread->events[index & (TRACER_BUFFER_SIZE - 1)] = { name, startTicks, endTicks };
+    
+    // Publish the event, so that the trace can see it
+    thread->numWritten.store(index + 1, std::memory_order_release);
+}
+
+
+juce::String Tracer::getTraceJson()
+{
+    const juce::ScopedLock sl(tracerLock);
+    
+    juce::MemoryOutputStream json;
+    json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    
+    bool first = true;
+    
+    for (int i = 0; i < numTracerThreads.load(); i++)
+    {
+        TraceThread* thread = tracerThreads[i].get();
+        int threadId = i + 1;
+        
+        if (!first) json << ",\n";
+        first = false;
+        
+        // Metadata event, so that the trace viewer labels this row with the thread name
+        json << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << threadId
+             << ",\"args\":{\"name\":" << juce::JSON::toString(thread->name) << "}}";
+        
+        // Copy out the events currently in the ring buffer
+        juce::uint64 end = thread->numWritten.load(std::memory_order_acquire);
+        juce::uint64 start = juce::jmax(thread->numCleared, end > TRACER_BUFFER_SIZE ? end - TRACER_BUFFER_SIZE : 0);
+        
+        juce::Array<TraceEvent> events;
+        for (juce::uint64 e = start; e < end; e++)
+            events.add(thread->events[e & (TRACER_BUFFER_SIZE - 1)]);
+        
+        // The thread may have kept writing while we were copying, overwriting the oldest events, so discard any that might be torn
+        juce::uint64 endAfterCopy = thread->numWritten.load(std::memory_order_acquire);
+        juce::uint64 firstValid = (endAfterCopy > TRACER_BUFFER_SIZE) ? endAfterCopy - TRACER_BUFFER_SIZE + 1 : 0;
+        
+        for (int e = 0; e < events.size(); e++)
+        {
+            if (start + e < firstValid)
+                continue;
+            
+            const TraceEvent& event = events.getReference(e);
+            
+            // Complete event, covering both the beginning and end of the zone
+            json << ",\n{\"ph\":\"X\",\"name\":\"" << event.name << "\",\"pid\":1,\"tid\":" << threadId
+                 << ",\"ts\":" << juce::String(ticksToTraceTime(event.startTicks), 3)
+                 << ",\"dur\":" << juce::String(ticksToTraceTime(event.endTicks) - ticksToTraceTime(event.startTicks), 3) << "}";
+        }
+    }
+    
+    json << "\n]}\n";
+    
+    return json.toString();
+}
+
+
+bool Tracer::writeTrace(juce::File file)
+{
+    return file.replaceWithText(getTraceJson());
+}
+
+
+juce::File Tracer::getDefaultFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile(TRACER_FILENAME);
+}
@@ -0,0 +1,72 @@
+//
+//  Tracer.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef Tracer_hpp
+#define Tracer_hpp
+
+#include <JuceHeader.h>
+
+
+#define TRACER_MAX_THREADS (64) ///< Maximum number of threads that can be traced at once
+#define TRACER_BUFFER_SIZE (16384) ///< Number of events kept per thread (must be a power of 2) - older events are overwritten
+#define TRACER_FILENAME ("AutoDjTrace.json") ///< Name of the trace file written at exit, in the user's documents folder
+
+
+/**
+ Optional timeline tracer, which records when each PROFILE_ZONE begins and ends, on every thread.
+ 
+ Each thread writes its events into its own ring buffer without locking, so the audio callback can be traced too.
+ The trace is written in the Chrome trace-event JSON format, which can be opened in chrome://tracing or ui.perfetto.dev,
+ to show how the file parser, analysis threads, DJ thread, waveform loader and audio callback overlap in time.
+ 
+ Tracing is disabled by default - launch the app with "--trace" to enable it, in which case the trace is written at exit,
+ or call setEnabled() and writeTrace() to capture a specific period.
+ */
+class Tracer
+{
+public:
+    
+    /** Enables/disables tracing at runtime. Disabled zones cost a single atomic flag check.
+     
+     @param[in] shouldBeEnabled New tracing state */
+    static void setEnabled(bool shouldBeEnabled);
+    
+    /** Checks whether tracing is enabled.
+     
+     @return True if enabled */
+    static bool isEnabled();
+    
+    /** Discards all recorded events, and restarts the trace timeline from zero. */
+    static void clear();
+    
+    /** Records a single event on the calling thread - use PROFILE_ZONE rather than calling this directly.
+     
+     @param[in] name Name of the event (must be a string literal)
+     @param[in] startTicks Time at which the event began, in high-resolution ticks
+     @param[in] endTicks Time at which the event ended, in high-resolution ticks */
+    static void addEvent(const char* name, juce::int64 startTicks, juce::int64 endTicks);
+    
+    /** Generates the Chrome trace-event JSON for all recorded events. Can be called from any thread, while tracing.
+     
+     @return JSON text */
+    static juce::String getTraceJson();
+    
+    /** Writes the Chrome trace-event JSON to a file.
+     
+     @param[in] file File to write
+     
+     @return True if successful */
+    static bool writeTrace(juce::File file);
+    
+    /** Fetches the file that the trace is written to at exit.
+     
+     @return Trace file */
+    static juce::File getDefaultFile();
+    
+};
+
+#endif /* Tracer_hpp */
@@ -66,20 +66,29 @@ bool Track::applyNextMix(MixInfo* mix)
     }
     else // Otherwise, this track is now leading the mix
     {
-        leader = true;
-        
-        // Ensure the modulated crossfade parameters have reach their idle state
-        gain.currentValue = 1.0;
-        highPassFreq.currentValue = 0.0;
-        
-        // Start a BPM modulation to the transition tempo
-        // This will complete when the transition starts
-        bpm.moveTo(currentMix->bpm, playhead, currentMix->leaderStart - playhead);
-        
-        // Set up the crossfade modulation, which will occur over the course of the transition
-        gain.moveTo(0, currentMix->leaderStart, currentMix->leaderEnd - currentMix->leaderStart);
-        highPassFreq.moveTo(HIGH_PASS_MAX, currentMix->leaderStart, currentMix->leaderEnd - currentMix->leaderStart);
+        applyLeaderMix(currentMix);
     }
     
     return true;
 }
+
+
+void Track::applyLeaderMix(MixInfo* mix)
+{
+    // Store the provided mix
+    currentMix = mix;
+    
+    leader = true;
+    
+    // Ensure the modulated crossfade parameters have reach their idle state
+    gain.currentValue = 1.0;
+    highPassFreq.currentValue = 0.0;
+    
+    // Start a BPM modulation to the transition tempo
+    // This will complete when the transition starts
+    bpm.moveTo(currentMix->bpm, playhead, currentMix->leaderStart - playhead);
+    
+    // Set up the crossfade modulation, which will occur over the course of the transition
+    gain.moveTo(0, currentMix->leaderStart, currentMix->leaderEnd - currentMix->leaderStart);
+    highPassFreq.moveTo(HIGH_PASS_MAX, currentMix->leaderStart, currentMix->leaderEnd - currentMix->leaderStart);
+}
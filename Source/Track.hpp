@@ -42,6 +42,12 @@ public:
      @return False if there is no track to transition to */
     bool applyNextMix(MixInfo* mix);
     
+    /** Applies the provided mix information to the track state as the leading track, readying it to be mixed out.
+     Unlike applyNextMix(), this can be used when the track is already leading (e.g. to replace a hold mix).
+     
+     @param[in] mix Information on the next transition */
+    void applyLeaderMix(MixInfo* mix);
+    
     /** Fetches the current playhead position of the track.
      
      @return Current track position, in audio samples */
@@ -12,10 +12,18 @@
 #define NUM_CANDIDATES (5)
 
 
-TrackChooser::TrackChooser(DataManager* dm, RandomGenerator* random) :
+TrackChooser::TrackChooser(DataManager* dm, RandomGenerator* random, bool sharedHistory) :
     dataManager(dm), randomGenerator(random)
 {
-    sorter = dataManager->getSorter();
+    if (sharedHistory)
+    {
+        sorter = dataManager->getSorter();
+    }
+    else
+    {
+        privateSorter.reset(new TrackSorter());
+        sorter = privateSorter.get();
+    }
 }
 
 
@@ -23,6 +31,20 @@ void TrackChooser::initialise()
 {
     AnalysisResults analysisResults = dataManager->getAnalysisResults();
     
+    // If the history is private, start each performance from a fresh copy of the library
+    // (this only holds pointers to the shared track information, so it is small)
+    if (privateSorter != nullptr)
+    {
+        juce::Array<TrackInfo*> tracks = dataManager->getAnalysedTracks();
+        
+        privateSorter->reset();
+        
+        for (auto* track : tracks)
+            privateSorter->addTrack(track);
+        
+        numPrivateTracksReady = tracks.size();
+    }
+    
     // BPM INITIALISATION...
     
     // Define some approximate constant to help initialisation...
@@ -60,7 +82,7 @@ TrackInfo* TrackChooser::chooseTrack()
     TrackInfo* candidate;
     TrackInfo* result;
     
-    int numCandidates = juce::jmin(NUM_CANDIDATES, dataManager->getNumTracksReady());
+    int numCandidates = juce::jmin(NUM_CANDIDATES, getNumTracksReady());
 
     if (numCandidates <= 0)
         return nullptr;
@@ -81,8 +103,11 @@ TrackInfo* TrackChooser::chooseTrack()
     if (candidates.isEmpty())
         return nullptr;
     
-    // Notify the data manager that a track will be queued
-    dataManager->trackQueued();
+    // Notify the data manager that a track will be queued (unless the history is private)
+    if (privateSorter != nullptr)
+        numPrivateTracksReady -= 1;
+    else
+        dataManager->trackQueued();
     
     // If only one track was returned, choose that one
     if (candidates.size() == 1)
@@ -117,6 +142,42 @@ TrackInfo* TrackChooser::chooseTrack()
 }
 
 
+juce::Array<TrackInfo*> TrackChooser::getCandidates(int maxCandidates)
+{
+    juce::Array<TrackInfo*> candidates;
+    TrackInfo* candidate;
+    
+    int numCandidates = juce::jmin(NUM_CANDIDATES, getNumTracksReady());
+    
+    if (numCandidates <= 0)
+        return candidates;
+    
+    // Predict the next position, assuming the velocity stays the same
+    double nextBpm = currentBpm + velocityBpm;
+    double nextGroove = currentGroove + velocityGroove;
+    
+    // Fetch the same candidates that chooseTrack() would, then put them straight back into the tree
+    for (int i = 0; i < numCandidates; i++)
+    {
+        candidate = sorter->removeClosestTrack(nextBpm, nextGroove);
+        if (candidate == nullptr)
+            break;
+        candidates.add(candidate);
+    }
+    
+    for (auto track : candidates)
+        sorter->addTrack(track);
+    
+    // Sort the candidates by key compatibility, as the choice is made from the first two
+    KeySorter keySorter((CamelotKey)currentKey);
+    candidates.sort(keySorter);
+    
+    candidates.removeRange(maxCandidates, candidates.size());
+    
+    return candidates;
+}
+
+
 void TrackChooser::printChoice(TrackInfo* track)
 {
     DBG("QUEUED " << track->getFilename() << \
@@ -146,3 +207,12 @@ void TrackChooser::updatePosition()
     currentBpm += velocityBpm;
     currentGroove += velocityGroove;
 }
+
+
+int TrackChooser::getNumTracksReady()
+{
+    if (privateSorter != nullptr)
+        return numPrivateTracksReady;
+    
+    return dataManager->getNumTracksReady();
+}
@@ -22,8 +22,13 @@ class TrackChooser
 {
 public:
     
-    /** Constructor. */
-    TrackChooser(DataManager* dm, RandomGenerator* random);
+    /** Constructor.
+     
+     @param[in] dm Pointer to the track data manager
+     @param[in] random Pointer to the random number engine
+     @param[in] sharedHistory If true, choices are made from the library's own sorter, so chosen tracks are removed for everyone.
+     If false, each performance chooses from a private copy of the sorter, so the library isn't modified. */
+    TrackChooser(DataManager* dm, RandomGenerator* random, bool sharedHistory = true);
     
     /** Destructor. */
     ~TrackChooser() {}
@@ -36,6 +41,14 @@ public:
      @return Pointer to the information of the chosen track */
     TrackInfo* chooseTrack();
     
+    /** Predicts the tracks most likely to be returned by the next call to chooseTrack(), without choosing any.
+     This uses the current tempo/groove velocity, but not the random acceleration, so it is only an estimate.
+     
+     @param[in] maxCandidates Maximum number of tracks to return
+     
+     @return Likely next choices, sorted by key compatibility */
+    juce::Array<TrackInfo*> getCandidates(int maxCandidates);
+    
     /** Prints the supplied track information to the debug console.
      
      @param[in] track Pointer to information to print */
@@ -46,8 +59,16 @@ private:
     /** Shifts the tempo and groove position, based on the current velocity. */
     void updatePosition();
     
+    /** Fetches the number of tracks that can still be chosen.
+     
+     @return Number of analysed tracks not yet chosen */
+    int getNumTracksReady();
+    
     DataManager* dataManager = nullptr; ///< Pointer to the app's track data manager
     TrackSorter* sorter = nullptr; ///< Pointer to a quadtree which sorts tracks based on tempo and groove
+    
+    std::unique_ptr<TrackSorter> privateSorter; ///< Private copy of the library's tracks, when the history isn't shared (see constructor)
+    int numPrivateTracksReady = 0; ///< Number of tracks left in privateSorter
     RandomGenerator* randomGenerator; ///< Pointer to random number engine
     
     int currentKey = -1; ///< Key signature of the previous track choice
@@ -0,0 +1,36 @@
+//
+//  TrackDataListener.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef TrackDataListener_hpp
+#define TrackDataListener_hpp
+
+#include "TrackInfo.hpp"
+
+
+/**
+ Interface for anything which displays the library's track data, so DataManager can notify it when tracks are analysed,
+ without depending on the UI (so the analysis code can also be built without the JUCE GUI modules, see ConsoleMain.cpp).
+ @see DirectionView
+ */
+class TrackDataListener
+{
+public:
+    
+    /** Destructor. */
+    virtual ~TrackDataListener() {}
+    
+    /** Called when a track has been analysed, or an already-analysed track has been loaded from the database.
+     
+     @param[in] track Information of the analysed track */
+    virtual void addAnalysed(TrackInfo* track) = 0;
+    
+    /** Called when the track data is cleared, before the analysed tracks are added again. */
+    virtual void reset() = 0;
+    
+};
+
+#endif /* TrackDataListener_hpp */
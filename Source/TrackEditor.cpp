@@ -18,10 +18,6 @@ TrackEditor::TrackEditor(DataManager* dm) :
     addAndMakeVisible(waveform.get());
     
     message = "Select a track to view it here.";
-    
-#ifdef SHOW_SEGMENTS
-    analyserSegments.reset(new AnalyserSegments());
-#endif
 }
 
 
@@ -54,9 +50,10 @@ void TrackEditor::load(TrackInfo* t)
     
 #ifdef SHOW_SEGMENTS
     
-    track.audio = dataManager->loadAudio(track.info->getFilename());
-    
-    juce::Array<int> segments = analyserSegments->analyse(track.info, track.audio);
+    // The segments are found during analysis, so are only available once the track is analysed
+    juce::Array<int> segments;
+    if (track.info->analysed)
+        segments = track.info->getSegments();
     
     waveform->clearMarkers();
 
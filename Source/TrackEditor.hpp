@@ -10,7 +10,6 @@
 
 #include "WaveformView.hpp"
 #include "DataManager.hpp"
-#include "AnalyserSegments.hpp"
 
 
 /**
@@ -52,8 +51,6 @@ private:
     
     juce::String message; ///< String to display when no track is loaded
     
-    std::unique_ptr<AnalyserSegments> analyserSegments; ///< Track segmentation analyser, for debugging of the segmentation algorithm (see SHOW_SEGMENTS macro in .cpp file)
-    
     bool trackAnalysed = false; ///< Indicates whether the current track had analysis data when it was first loaded, used to check wether a reload is necessary
     
     
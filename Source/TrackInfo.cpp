@@ -54,6 +54,27 @@ int TrackInfo::getBarLength()
 }
 
 
+juce::Array<int> TrackInfo::getSegments()
+{
+    if (!analysed) jassert(false); // Track must be analysed to calculate this!
+    
+    juce::Array<int> segments;
+    
+    for (int i = 0; i < numSegments; i++)
+    {
+        int segment = getFirstDownbeat() + segmentBars[i] * getBarLength();
+        
+        // As in getNearestDownbeat(), a boundary can't be beyond the end of the track
+        if (segment > getLengthSamples())
+            segment -= getBarLength();
+        
+        segments.add(segment);
+    }
+    
+    return segments;
+}
+
+
 int TrackInfo::getLengthSamples()
 {
     return length * SUPPORTED_SAMPLERATE;
@@ -67,7 +88,7 @@ juce::String TrackInfo::getTitle()
     if (titleStr.isEmpty())
         titleStr = getFilename();
     
-    if (titleStr.endsWith(".mp3") || titleStr.endsWith(".wav"))
+    if (titleStr.endsWithIgnoreCase(".mp3") || titleStr.endsWithIgnoreCase(".wav"))
         titleStr = titleStr.dropLastCharacters(4);
     
     return titleStr;
@@ -84,7 +105,7 @@ juce::String TrackInfo::getArtistTitle()
     {
         filenameStr = getFilename();
         
-        if (filenameStr.endsWith(".mp3") || filenameStr.endsWith(".wav"))
+        if (filenameStr.endsWithIgnoreCase(".mp3") || filenameStr.endsWithIgnoreCase(".wav"))
             filenameStr = filenameStr.dropLastCharacters(4);
         
         return filenameStr;
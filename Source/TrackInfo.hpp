@@ -9,6 +9,10 @@
 #define TrackInfo_h
 
 #include <JuceHeader.h>
+#include "AnalysisFeatures.hpp"
+
+
+#define TRACK_SEGMENTS_MAX (128) ///< Maximum number of musical segment boundaries stored for a track (a 10 minute track has at most 150 four-second segments, and far fewer in practice)
 
 
 /**
@@ -62,6 +66,12 @@ public:
      @return Number of audio samples per bar */
     int getBarLength();
     
+    /** Calculates the musical segment boundaries found by analysis (see AnalyserSegments), which are each locked to a downbeat.
+     Track must be analysed before using this function.
+     
+     @return Array of segment boundaries, measured in audio samples */
+    juce::Array<int> getSegments();
+    
     /** Gets the length of the track in audio samples.
      
      @return Number of audio samples in track */
@@ -128,6 +138,10 @@ public:
     int downbeat = -1; ///< Index of first downbeat, indicating which of the first four beats is a downbeat (can also be thought of as the phase of downbeats)
     int key = -1; ///< Musical key signature, chromatic key is used for storage, rather than Camelot, because it is a simpler representation
     float groove = -1.f; ///< The track's danceability metric
+    int numSegments = 0; ///< Number of musical segment boundaries found by analysis
+    int segmentBars[TRACK_SEGMENTS_MAX] = {}; ///< Musical segment boundaries, each stored as the index of the downbeat it is locked to (see getSegments())
+    int featureVersions[NUM_ANALYSIS_FEATURES] = {}; ///< Version of the analyser that computed each feature, or 0 if it hasn't been computed (indexed by AnalysisFeature)
+    int featureConfigs[NUM_ANALYSIS_FEATURES] = {}; ///< Configuration hash of the analyser that computed each feature (indexed by AnalysisFeature)
     
     
 private:
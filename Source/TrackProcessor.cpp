@@ -10,6 +10,7 @@
 #include "CommonDefs.hpp"
 
 #include "ArtificialDJ.hpp"
+#include "Profiler.hpp"
 
 
 TrackProcessor::TrackProcessor(DataManager* dm, ArtificialDJ* DJ) :
@@ -23,50 +24,74 @@ TrackProcessor::TrackProcessor(DataManager* dm, ArtificialDJ* DJ) :
 }
 
 
-void TrackProcessor::getNextAudioBlock(const juce::AudioSourceChannelInfo& outputBuffer)
+void TrackProcessor::renderBlock(int numSamples)
 {
+    juce::int64 renderStart = juce::Time::getHighResolutionTicks();
+    
+    stretchTicks = 0;
+    renderTicks = 0;
+    rendered = false;
+    
     // If a track isn't loaded, return
     if (!ready.load()) return;
     
-    const juce::ScopedLock sl(lock);
+    PROFILE_ZONE("deck")
     
     // If this track should not be playing yet, return
     if (!play)
         return;
 
-    // Throw a debug error if the intermediate audio buffer is not the same size as the output
-    // We perform processing for this track in an intermediate buffer,
-    // so that any samples already in the output buffer are not disurbed
-    if (processBuffer.getNumSamples() != outputBuffer.numSamples) jassert(false);
+    // Throw a debug error if the intermediate audio buffer is not the same size as the block
+    // We perform processing for this track in its own buffer, so that the decks can be rendered in parallel
+    if (processBuffer.getNumSamples() != numSamples) jassert(false);
     
-    // The number of output samples required is outputBuffer.numSamples
+    // The number of output samples required is numSamples
     // We need to fetch that many samples of the track POST-stretch
     // This function gets the stretched samples and return the number of input samples that were processed (PRE-stretch)
     // See TimeStretcher for more info on the time-strech factor and its effects
-    int numProcessed = stretcher->process(track->audio, &processBuffer, outputBuffer.numSamples);
+    juce::int64 stretchStart = juce::Time::getHighResolutionTicks();
+    int numProcessed = stretcher->process(track->audio, &processBuffer, numSamples);
+    stretchTicks = juce::Time::getHighResolutionTicks() - stretchStart;
+    
+    // Note the crossfade parameters before the update, so they can be ramped smoothly to their new values across this block
+    float gainStart = float(track->gain.currentValue);
+    float highPassStart = float(track->highPassFreq.currentValue);
     
     // Update the track parameters based on how many samples were processed
     // The timing of mix parameters in MixInfo is measured in terms of the original track audio,
     // hence we update by the number of PRE-stretch samples that were processed, to progress the parameters according to the original audio
     update(numProcessed);
     
-    // Apply any crossfade gain
-    processBuffer.applyGain(std::sqrt(track->gain.currentValue));
+    // Render the per-sample crossfade ramps
+    float* gainRamp = automationBuffer.getWritePointer(0);
+    float* highPassRamp = automationBuffer.getWritePointer(1);
+    float gainEnd = float(track->gain.currentValue);
     
-    // If the high-pass crossfade filtering is active, apply the left and right channel filters
-    if (filterOn)
-    {
-        highPassFilterL.processSamples(processBuffer.getWritePointer(0), outputBuffer.numSamples);
-        highPassFilterR.processSamples(processBuffer.getWritePointer(1), outputBuffer.numSamples);
-    }
+    Automation::renderEqualPower(gainRamp, numSamples, gainStart, gainEnd);
+    Automation::renderLinear(highPassRamp, numSamples, highPassStart, float(track->highPassFreq.currentValue));
+    
+    // Apply the crossfade gain and high-pass filter to the left and right channels in one pass
+    // The filter is bypassed while its cut-off is zero, and the gain is skipped while the track is at full volume
+    bool fullGain = (gainStart >= 1.f && gainEnd >= 1.f);
+    highPassFilter.processHighPass(processBuffer.getArrayOfWritePointers(), 2, numSamples, highPassRamp, fullGain ? nullptr : gainRamp);
     
-    // Add the processed audio from the intermediate buffer into the output
-    outputBuffer.buffer->addFrom(0, outputBuffer.startSample, processBuffer.getReadPointer(0), outputBuffer.numSamples);
-    outputBuffer.buffer->addFrom(1, outputBuffer.startSample, processBuffer.getReadPointer(1), outputBuffer.numSamples);
+    rendered = true;
+    renderTicks = juce::Time::getHighResolutionTicks() - renderStart;
+}
+
+
+void TrackProcessor::finishBlock()
+{
+    if (!trackEnd)
+        return;
     
     // If the track has ended, load the next one
-    if (trackEnd)
+    // (this moves the partner on to the next mix too, so it mustn't happen while the decks are rendering)
+    // A deck outside the mix has no partner, and mustn't take the DJ's next mix, so it just stops
+    if (isMixDeck())
         loadNextTrack();
+    else
+        stop();
 }
 
 
@@ -79,13 +104,13 @@ void TrackProcessor::nextMix()
 
 void TrackProcessor::loadNextTrack()
 {
+    PROFILE_ZONE("loadNextTrack")
+    
     ready.store(false);
     
     stretcher->reset();
     
-    track->info->playing = false;
-    track->info->played = true;
-    dataManager->trackDataUpdate.store(true);
+    setTrackPlaying(false);
     
     currentMix = dj->getNextMix(currentMix);
     
@@ -96,20 +121,72 @@ void TrackProcessor::loadNextTrack()
         
         ready.store(true);
     }
+    else if (currentMix.id == MIX_ID_HOLD) // Next mix isn't ready, so wait for it (see loadMix())
+    {
+        play = false;
+        trackEnd = false;
+    }
     else // Mix is ending
     {
         mixEnd.store(true);
     }
     
     partner->nextMix();
+    
+    // Neither deck reads the audio of the finished leading track any more, so the DJ can release it
+    dj->mixFinished();
 }
 
 
-void TrackProcessor::loadFirstTrack(TrackInfo* trackInfo, bool leader, juce::AudioBuffer<float>* audio)
+void TrackProcessor::updateMix(const MixInfo& mix)
+{
+    jassert(isLeader()); // Must invoke this call on the leader only!
+    
+    currentMix = mix;
+    track->applyLeaderMix(&currentMix);
+}
+
+
+void TrackProcessor::loadMix(const MixInfo& mix)
+{
+    // If there is no track to mix in (i.e. the final mix), stay unloaded
+    if (mix.nextTrackAudio == nullptr)
+        return;
+    
+    currentMix = mix;
+    
+    // Mark the track as having led the last transition, so applyNextMix() loads it as the new track
+    track->leader = true;
+    track->applyNextMix(&currentMix);
+    
+    play = false;
+    trackEnd = false;
+    
+    ready.store(true);
+}
+
+
+void TrackProcessor::holdLoop()
+{
+    jassert(isLeader()); // Must invoke this call on the leader only!
+    
+    int barLength = track->info->getBarLength();
+    int playhead = track->getPlayhead();
+    
+    // The hold ends at the end of the track, which must never be reached (otherwise the track would finish)
+    int holdEnd = juce::jmin(getAudioLength(), currentMix.leaderEnd);
+    
+    // If the end is close, jump back a few bars (by whole bars, so the loop stays on the beat)
+    if (playhead >= holdEnd - MIX_HOLD_MARGIN_BARS * barLength)
+        resetPlayhead(juce::jmax(0, playhead - MIX_HOLD_LOOP_BARS * barLength));
+}
+
+
+void TrackProcessor::loadFirstTrack(TrackInfo* trackInfo, bool leader, const MixInfo& mix, juce::AudioBuffer<float>* audio)
 {
     ready.store(false);
     
-    currentMix = dj->getNextMix(currentMix);
+    currentMix = mix;
     
     if (leader)
     {
@@ -121,8 +198,7 @@ void TrackProcessor::loadFirstTrack(TrackInfo* trackInfo, bool leader, juce::Aud
         track->applyNextMix(&currentMix);
         play = true;
         
-        track->info->playing = true;
-        dataManager->trackDataUpdate.store(true);
+        setTrackPlaying(true);
     }
     else
     {
@@ -134,9 +210,43 @@ void TrackProcessor::loadFirstTrack(TrackInfo* trackInfo, bool leader, juce::Aud
 }
 
 
+void TrackProcessor::playTrack(TrackInfo* trackInfo, juce::AudioBuffer<float>* audio, int startSample)
+{
+    jassert(!isMixDeck()); // The DJ loads its own decks!
+    
+    ready.store(false);
+    
+    // Play at the track's own tempo, at full volume and unfiltered
+    track->reset(trackInfo->bpm, 1.0, 0.0);
+    track->info = trackInfo;
+    track->audio = audio;
+    resetPlayhead(startSample);
+    highPassFilter.reset();
+    
+    play = true;
+    trackEnd = false;
+    
+    ready.store(true);
+}
+
+
+void TrackProcessor::stop()
+{
+    jassert(!isMixDeck()); // The DJ's decks stop when the mix ends!
+    
+    ready.store(false);
+    
+    play = false;
+    trackEnd = false;
+    
+    stretcher->reset();
+}
+
+
 void TrackProcessor::prepare(int blockSize)
 {
     processBuffer.setSize(2, blockSize);
+    automationBuffer.setSize(2, blockSize);
     stretcher->prepare(blockSize);
 }
 
@@ -152,8 +262,7 @@ void TrackProcessor::cue(int leaderPlayhead)
         // Start this track
         play = true;
         // Update the track info so it shows as playing in the Library and Direction views
-        track->info->playing = true;
-        dataManager->trackDataUpdate.store(true);
+        setTrackPlaying(true);
     }
 }
 
@@ -188,48 +297,48 @@ void TrackProcessor::skipToNextEvent()
 
 void TrackProcessor::reset()
 {
+    currentMix = MixInfo();
+    
     play = false;
     trackEnd = false;
     
     mixEnd.store(false);
+    audiblePlayhead.store(0);
 
     stretcher->reset();
     processBuffer.clear();
     
     track.reset(new Track());
     
-    highPassFilterL.reset();
-    highPassFilterR.reset();
+    highPassFilter.reset();
 }
 
 
-void TrackProcessor::setHighPass(int frequency)
+void TrackProcessor::update(int numSamples)
 {
-    // If the supplied frequency is 0, just turn off filtering and reset
-    if (frequency <= 0)
-    {
-        filterOn = false;
-        highPassFilterL.reset();
-        highPassFilterR.reset();
-        return;
-    }
-    // Otherwise, filtering is active so apply the filters of the left and right channels...
+    trackEnd = track->update(numSamples);
     
-    filterOn = true;
+    // Outside the mix, there's no transition to end the track, so it ends with its audio
+    if (!isMixDeck() && track->getPlayhead() >= getAudioLength() - 1)
+        trackEnd = true;
     
-    highPassFilterL.setCoefficients(juce::IIRCoefficients::makeHighPass(SUPPORTED_SAMPLERATE, frequency, 1.0));
-    highPassFilterR.setCoefficients(juce::IIRCoefficients::makeHighPass(SUPPORTED_SAMPLERATE, frequency, 1.0));
+    // Update time shift
+    stretcher->update(track->info->bpm, track->bpm.currentValue);
 }
 
 
-void TrackProcessor::update(int numSamples)
+void TrackProcessor::setTrackPlaying(bool playing)
 {
-    trackEnd = track->update(numSamples);
+    // If the DJ keeps its own history, the shared track information must not be modified
+    if (!dj->hasSharedHistory())
+        return;
     
-    setHighPass(round(track->highPassFreq.currentValue));
+    track->info->playing = playing;
     
-    // Update time shift
-    stretcher->update(track->info->bpm, track->bpm.currentValue);
+    if (!playing)
+        track->info->played = true;
+    
+    dataManager->trackDataUpdate.store(true);
 }
 
 
@@ -11,12 +11,18 @@
 #include "DataManager.hpp"
 #include "TimeStretcher.hpp"
 #include "Track.hpp"
+#include "StateVariableFilter.hpp"
+#include "Automation.hpp"
 #include "ThirdParty/soundtouch/include/SoundTouch.h"
 
 class ArtificialDJ;
 class TrackLoadThread;
 
 
+#define MIX_HOLD_MARGIN_BARS (4) ///< While holding, the leader loops back once it is this many bars from the end of its track
+#define MIX_HOLD_LOOP_BARS (8) ///< While holding, the number of bars the leader jumps back each time it loops
+
+
 /**
  Audio processor for track-specific DSP.
  */
@@ -30,10 +36,26 @@ public:
     /** Destructor. */
     ~TrackProcessor() {}
     
-    /** Audio processing loop - applies mixing parameters.
+    /** Audio processing loop - renders a block of the track into this processor's own buffer (see getOutput()), applying mixing parameters.
+     This only touches the state of this processor, so the decks can be rendered in parallel (see DeckRenderGroup).
+    
+     @param[in] numSamples Number of audio samples to render */
+    void renderBlock(int numSamples);
     
-     @param[out] outputBuffer Buffer to fill with desired audio output samples */
-    void getNextAudioBlock(const juce::AudioSourceChannelInfo& outputBuffer);
+    /** Completes the last rendered block, e.g. loading the next track if the current one has finished
+     (or stopping, if this processor isn't one of the DJ's decks, see isMixDeck()).
+     This may affect the partner processor, so it must be called after all of the decks have rendered the block. */
+    void finishBlock();
+    
+    /** Checks whether the last call to renderBlock() produced any audio (it doesn't if no track is playing).
+     
+     @return Result of the check */
+    bool hasOutput() { return rendered; }
+    
+    /** Fetches the audio produced by the last call to renderBlock(). Only valid if hasOutput() returns true.
+     
+     @return Stereo audio buffer */
+    const juce::AudioBuffer<float>& getOutput() { return processBuffer; }
     
     /** Fetches the Track data structure.
      This contains a pointer to the TrackInfo for the currently loaded track,
@@ -42,6 +64,12 @@ public:
      @return Pointer to Track data structure for this processor */
     Track* getTrack() { return track.get(); }
     
+    /** Checks whether the DJ mixes on this processor, i.e. it has a partner to hand over to (see setPartner()).
+     Any other processor only plays what it is given by playTrack().
+     
+     @return Result of the check */
+    bool isMixDeck() { return partner != nullptr; }
+    
     /** Checks whether this processor is leading the mix.
      
      @return Result of the check */
@@ -60,22 +88,58 @@ public:
      @return Result of the check  */
     bool mixEnded() { return mixEnd.load(); } 
     
-    /** Loads the next track information and gets ready for playback. */
+    /** Loads the next track information and gets ready for playback.
+     If the next mix isn't ready yet, the processor stays unloaded until loadMix() is called. */
     void loadNextTrack();
     
+    /** Replaces the mix being led by this processor, e.g. to end a hold once the next mix is ready.
+     Only used when this is the leading TrackProcessor.
+     
+     @param[in] mix Information on the next transition */
+    void updateMix(const MixInfo& mix);
+    
+    /** Loads the track to be mixed in by the provided mix, e.g. to end a hold once the next mix is ready.
+     Only used when this is the following TrackProcessor.
+     
+     @param[in] mix Information on the next transition */
+    void loadMix(const MixInfo& mix);
+    
+    /** Loops the leading track back a few bars if it is close to the end, to extend it while the next mix isn't ready.
+     Only used when this is the leading TrackProcessor. */
+    void holdLoop();
+    
     /** Loads the first track information and gets ready to start the DJ mix.
      
      @param[in] trackInfo Pointer to the first track to be played by this processor
      @param[in] leader Indicates whether this will be the first processor to play
+     @param[in] mix Information on the first transition (given directly by the DJ, rather than taken from its queue)
      @param[in] audio Pointer to the audio data for the first track */
-    void loadFirstTrack(TrackInfo* trackInfo, bool leader, juce::AudioBuffer<float>* audio = nullptr);
+    void loadFirstTrack(TrackInfo* trackInfo, bool leader, const MixInfo& mix, juce::AudioBuffer<float>* audio = nullptr);
+    
+    /** Plays a track on its own, outside the DJ's mix (e.g. a drop or an effect), at the track's own tempo,
+     until it ends or stop() is called. Only used when this isn't one of the DJ's decks (see isMixDeck()).
+     Only call from the thread that renders the decks, between blocks. The audio must stay loaded until the track stops.
+     
+     @param[in] trackInfo Pointer to the track to play
+     @param[in] audio Pointer to the audio data for the track
+     @param[in] startSample Position to start playing from, in audio samples */
+    void playTrack(TrackInfo* trackInfo, juce::AudioBuffer<float>* audio, int startSample = 0);
+    
+    /** Stops the track started by playTrack(), leaving the processor unloaded. This happens automatically when the track ends.
+     Only call from the thread that renders the decks, between blocks. */
+    void stop();
+    
+    /** Checks whether a track is playing, e.g. to find out whether one started by playTrack() has ended.
+     
+     @return Result of the check */
+    bool isPlaying() { return ready.load() && play; }
     
     /** Prepares the processing pipeline for a given audio buffer size.
     
     @param[in] blockSize Number of audio samples to expect in each processing block */
     void prepare(int blockSize);
     
-    /** Sets the companion instance of TrackProcessor
+    /** Sets the companion instance of TrackProcessor, which this one hands over to (or takes over from) at the end of each mix.
      
      @param[in] p Pointer to the other instance of TrackProcessor */
     void setPartner(TrackProcessor* p) { partner = p; }
@@ -95,6 +159,17 @@ public:
      @return Current playhead position */
     int getPlayheadPosition() { return track->getPlayhead(); }
     
+    /** Fetches the playhead position of the audio currently being heard, which lags behind getPlayheadPosition()
+     when the mix is rendered ahead of time (see RenderAhead). Safe to call from any thread.
+     
+     @return Audible playhead position, in audio samples */
+    int getAudiblePlayhead() { return audiblePlayhead.load(); }
+    
+    /** Sets the playhead position of the audio currently being heard. Only called by AudioProcessor.
+     
+     @param[in] position Audible playhead position, in audio samples */
+    void setAudiblePlayhead(int position) { audiblePlayhead.store(position); }
+    
     /** Synchronises the start of this processor with the provided leader playhead position.
      Only used when this is the following TrackProcessor.
      
@@ -104,21 +179,42 @@ public:
     /** Skips the playhead position to the next mixing event. */
     void skipToNextEvent();
     
+    /** Fetches the time spent time stretching during the last call to renderBlock() (audio thread only).
+     
+     @return Time stretching duration, in high-resolution ticks */
+    juce::int64 getLastStretchTicks() { return stretchTicks; }
+    
+    /** Fetches the time spent in the last call to renderBlock() (audio thread only).
+     
+     @return Rendering duration, in high-resolution ticks */
+    juce::int64 getLastRenderTicks() { return renderTicks; }
+    
+    /** Requests a time stretching quality profile, which is applied at the start of the next processing block.
+     
+     @param[in] quality Quality tier to use (see StretchProfiles) */
+    void setStretchQuality(StretchQuality quality) { stretcher->setQuality(quality); }
+    
+    /** Fetches the time stretching quality profile in use.
+     
+     @return Quality tier */
+    StretchQuality getStretchQuality() { return stretcher->getQuality(); }
+    
     /** Resets the processor ready for a new performance. */
     void reset();
     
 private:
     
-    /** Sets the frequency of the high-pass crossfade filters.
-     
-     @param[in] frequency Cut-off frequency for filters */
-    void setHighPass(int frequency);
-    
     /** Updates the state of the processor, based on how many samples have been processed.
      
      @param[in] numSamples Number of audio samples processed since last update */
     void update(int numSamples);
     
+    /** Updates the track information, so the Library and Direction views show whether the track is playing.
+     Nothing is recorded if the DJ keeps its own history (see ArtificialDJ::hasSharedHistory()).
+     
+     @param[in] playing Indicates whether the track has started (true) or finished (false) playing */
+    void setTrackPlaying(bool playing);
+    
     /** Resets the track playhead position (back to the start by default).
      
      @param[in] sample Audio sample to set playhead to */
@@ -130,8 +226,6 @@ private:
     int getAudioLength() { return track->audio->getNumSamples(); }
     
     
-    juce::CriticalSection lock; ///< RAII lock to ensure thread-safety while acessing data within this class
-
     TrackProcessor* partner = nullptr; ///< Pointer to the companion instance of TrackProcessor
     DataManager* dataManager = nullptr; ///< Pointer to the app's track data manager
     ArtificialDJ* dj = nullptr; ///< Pointer to artificial DJ brain
@@ -146,15 +240,18 @@ private:
     std::unique_ptr<Track> track; ///< Data on the current track and its playback state
     MixInfo currentMix; ///< Parameters of current/next mix transition
     
-    juce::AudioBuffer<float> processBuffer; ///< Intermediate audio buffer, which is copied into the output buffer after processing
+    std::atomic<int> audiblePlayhead = 0; ///< Playhead position of the audio currently being heard (see getAudiblePlayhead())
+    
+    juce::AudioBuffer<float> processBuffer; ///< Audio rendered by this processor, which AudioProcessor sums into the output
+    bool rendered = false; ///< Indicates whether the last call to renderBlock() produced any audio
+    juce::int64 renderTicks = 0; ///< Time spent in the last call to renderBlock() (see AudioLoadMonitor)
     
     std::unique_ptr<TimeStretcher> stretcher; ///< Handles time stretching of track audio
+    juce::int64 stretchTicks = 0; ///< Time spent in the time stretcher during the last processing block (see AudioLoadMonitor)
 
-    // IIR filters depend on previous samples, so we can't switch between different audio channels during processing
-    // This means two high pass filters are needed - one for each channel
-    juce::IIRFilter highPassFilterL; ///< IIR filter for high-passing the left audio channel
-    juce::IIRFilter highPassFilterR; ///< IIR filter for high-passing the right audio channel
-    bool filterOn = false; ///< Tracks whether high-pass filtering should be applied
+    juce::AudioBuffer<float> automationBuffer; ///< Per-sample ramps of the crossfade gain (channel 0) and filter cut-off (channel 1) for the current block (see Automation)
+    
+    StateVariableFilter highPassFilter; ///< Crossfade filter for high-passing the left and right audio channels, whose cut-off follows the track's highPassFreq parameter
     
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackProcessor) ///< JUCE macro to add a memory leak detector
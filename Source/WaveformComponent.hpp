@@ -9,13 +9,12 @@
 #define WaveformComponent_hpp
 
 #include <JuceHeader.h>
-#include "Track.hpp"
+#include "AnalyserWaveform.hpp"
+#include "WaveformPyramid.hpp"
 
 
 #define WAVEFORM_HEIGHT (100) ///< Height of WaveformComponent, in pixels
 
-#define WAVEFORM_FRAME_SIZE (380) ///< Number of audio samples to consider for each waveform frame
-
 
 /**
  Shows a coloured waveform representing audio data.
@@ -31,9 +30,6 @@ public:
     
     /** Destructor. */
     ~WaveformComponent() {}
-
-    /** Called by the JUCE message when this component is resized - set size/position of child components here. */
-    void resized() override;
     
     /** Called by the JUCE message thread to paint this component.
      
@@ -51,70 +47,63 @@ public:
     void reset();
     
     /** Loads a new track and the associated data to display.
-     Waveform data is provided in arrays which determine the colour and level of each waveform frame.
-     A waveform frame is a single position along the horizontal axis which corresponds to a small window of audio data.
+     Waveform data is provided as images, in which each pixel column is a waveform frame: a small window of audio data.
      The size of the window is determined by WAVEFORM_FRAME_SIZE.
      
-     @param[in] track Pointer to the track information
-     @param[in] colours Pointer to an array of colours, representing the colour to render in each waveform frame
-     @param[in] levels Pointer to an array of levels, representing the magnitude/height of each waveform frame */
-    void load(Track* track, juce::Array<juce::Colour>* colours, juce::Array<float>* levels);
+     @param[in] pyramid Pre-rendered images of the track waveform, which may be shared with other waveforms */
+    void load(WaveformPyramid::Ptr pyramid);
     
-    /** Inserts a red mix marker at the given position in the loaded track.
+    /** Fetches the colour painted behind the waveform, which the waveform images should be rendered on.
      
-     @param[in] sample Position in track where marker should be placed (audio sample number, which will be converted to waveform frame number)
-     @param[in] thickness Thickness of the marker to render */
-    void insertMarker(int sample, int thickness = 3) { markers.add(sample); markerThickness = thickness; }
+     @return Background colour */
+    juce::Colour getBackgroundColour() { return colourBackground; }
     
-    /** Removes all mix markers. */
-    void clearMarkers() { markers.clear(); }
-    
-protected:
+    /** Checks whether the waveform is ready to display.
+     
+     @return True if a track is loaded */
+    bool isReady() { return ready.load(); }
     
-    /** Renders the full track waveform to an image.
-     Playhead position, time stretch and gain are applied dynamically to this image before painting.
-     This expensive function can therefore be called just once - upon track load.
+    /** Fetches the position of the track shown at the left of the waveform.
      
-     @param[in] colours Pointer to an array of colours, representing the colour to render in each waveform frame
-     @param[in] levels Pointer to an array of levels, representing the magnitude/height of each waveform frame */
-    virtual void draw(juce::Array<juce::Colour>* colours, juce::Array<float>* levels);
+     @return Position in the track, in waveform frames (negative at the start of the track) */
+    double getStartFrame() { return startFrame; }
     
-    /** Draws the mix markers on top of the waveform.
+    /** Fetches the zoom of the waveform.
      
-     @param[in] g JUCE graphics handler, which is bound to the base waveform image. */
-    virtual void drawMarkers(juce::Graphics& g);
+     @return Number of waveform frames covered by each pixel */
+    double getFramesPerPixel() { return framesPerPixel; }
     
-    /** Checks whether a given waveform frame contains a beat in the track.
+    /** Fetches the brightness at which the waveform is shown, so that anything drawn on top of it can match.
      
-     @param[in] frameIndex Index of the waveform frame to check
-     @param[out] downbeat Indicates whether the frame contains a downbeat */
-    virtual bool isBeat(int frameIndex, bool& downbeat);
+     @return Brightness (0.0 to 1.0) */
+    float getBrightness() { return brightness; }
+    
+protected:
     
-    /** Checks whether a given waveform frame contains a mix marker. */
-    bool isMarker(int frameIndex);
+    /** Prepares any images this component derives from the waveform pyramid.
+     This expensive function is called just once upon track load, and when the component is resized. */
+    virtual void draw() {}
+    
+    /** Converts a position in the track to a horizontal position in this component.
+     
+     @param[in] frame Position in the track, in waveform frames
+     
+     @return X-coordinate, in pixels */
+    float frameToX(double frame) { return float((frame - startFrame) / framesPerPixel); }
     
     std::atomic<bool> ready = false; ///< Thread-safe flag to indicate whether the graph data is ready to display
     
     int numFrames = 0; ///< Number of waveform frames, determined by length of current track
-    int startFrame = 0; ///< Index of the first frame to render at the left of the waveform
-    
-    int beatMarkerHeight; ///< Height of the white beat markers (rendered at top and bottom of waveform)
+    double startFrame = 0.0; ///< Position of the first frame to render at the left of the waveform (negative at the start of the track)
+    double framesPerPixel = 1.0; ///< Number of waveform frames covered by each pixel, determined by the time-stretch
     
-    juce::Image image; ///< Image of raw, unmodified track waveform, which is rendered in the draw() function
-    juce::Image imageScaled; ///< Modified waveform, which takes into account playhead position, time-stretch, and volume gain
+    WaveformPyramid::Ptr pyramid; ///< Pre-rendered images of the track waveform at power-of-two zooms
     
     juce::Colour colourBackground; ///< Base colour to paint as the background
     
 private:
     
-    Track* track; ///< Pointer to current track information
-    
-    juce::Array<int> markers; ///< Array of mix markers (stored in terms of audio sample, not waveform frame number)
-    int markerThickness = 3; ///< Thickness to render mix markers, in pixels
-    
-    int imageOffset = 0; ///< Horizontal offset at which to render waveform image, in pixels (determined by playhead position in track)
-    
-    float brightness = 0.0; ///< Brightness at which to render waveform colours, determined by current volume gain of track (0.0 to 1.0)
+    float brightness = 1.f; ///< Brightness at which to render waveform colours, determined by current volume gain of track (0.0 to 1.0)
     
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformComponent) ///< JUCE macro to add a memory leak detector
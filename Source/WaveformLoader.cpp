@@ -8,16 +8,12 @@
 #include "WaveformLoader.hpp"
 
 #include "CommonDefs.hpp"
+#include "Profiler.hpp"
 
 
 WaveformLoader::WaveformLoader(DataManager* dm, WaveformComponent* wave, WaveformScrollBar* bar, bool hide) :
     juce::Thread("WaveformLoader"), dataManager(dm), waveform(wave), scrollBar(bar), hideWhenEmpty(hide)
 {
-    // Generate coefficients for the low-, band- and high-pass IIR filters
-    filterLow.setCoefficients(juce::IIRCoefficients::makeLowPass(SUPPORTED_SAMPLERATE, 200, 1.0));
-    filterMid.setCoefficients(juce::IIRCoefficients::makeBandPass(SUPPORTED_SAMPLERATE, 500, 1.0));
-    filterHigh.setCoefficients(juce::IIRCoefficients::makeHighPass(SUPPORTED_SAMPLERATE, 10000, 1.0));
-    
     reset();
 }
 
@@ -75,7 +71,9 @@ void WaveformLoader::run()
 
 void WaveformLoader::process()
 {
-    int numSamples, numFrames;
+    PROFILE_ZONE("loadWaveform")
+    
+    juce::MemoryBlock data;
     
     // Fetch the new track
     track = newTrack;
@@ -83,87 +81,67 @@ void WaveformLoader::process()
     // If there is a new load request, abort this one
     if (newRequest) return;
     
-    // If there is no audio already, load the mono track audio
-    if (track.audio == nullptr)
+    // Analysed tracks have their waveform stored, so they don't need to be decoded
+    if (!readStored(data))
     {
-        jassert(dataManager != nullptr);
-        track.audio = dataManager->loadAudio(track.info->getFilename(), true);
-        loadedAudio = true;
+        // If there is no audio already, load the mono track audio
+        if (track.audio == nullptr)
+        {
+            jassert(dataManager != nullptr);
+            track.audio = dataManager->loadAudio(track.info->getFilename(), true);
+            loadedAudio = true;
+        }
+        
+        // If there is a new load request, abort this one (it is also checked between each block of the waveform)
+        if (!analyser.analyse(track.audio, data, &newRequest)) return;
     }
     
     // If there is a new load request, abort this one
     if (newRequest) return;
     
-    // Frames of audio are analysed to produce the waveform
-    // Calculate how many frames there will be - determined by track length and frame size
-    numSamples = track.audio->getNumSamples();
-    numFrames = numSamples / WAVEFORM_FRAME_SIZE;
-    
-    // Adjust the audio processing buffers to accomodate the audio
-    processBuffers.setSize(4, numSamples);
+    unpack(data);
     
-    // Copy frame data into processing buffers
-    memcpy(processBuffers.getWritePointer(0), track.audio->getReadPointer(0), numSamples * sizeof(float));
-    memcpy(processBuffers.getWritePointer(1), track.audio->getReadPointer(0), numSamples * sizeof(float));
-    memcpy(processBuffers.getWritePointer(2), track.audio->getReadPointer(0), numSamples * sizeof(float));
-    memcpy(processBuffers.getWritePointer(3), track.audio->getReadPointer(0), numSamples * sizeof(float));
-    
-    // Apply low-, band- and high-pass filters to buffers 1-3
-    filterLow.processSamples(processBuffers.getWritePointer(1), numSamples);
-    filterMid.processSamples(processBuffers.getWritePointer(2), numSamples);
-    filterHigh.processSamples(processBuffers.getWritePointer(3), numSamples);
-    
-    // Convert to absolute values
-    juce::FloatVectorOperations::abs(processBuffers.getWritePointer(0), processBuffers.getReadPointer(0), numSamples);
-    juce::FloatVectorOperations::abs(processBuffers.getWritePointer(1), processBuffers.getReadPointer(1), numSamples);
-    juce::FloatVectorOperations::abs(processBuffers.getWritePointer(2), processBuffers.getReadPointer(2), numSamples);
-    juce::FloatVectorOperations::abs(processBuffers.getWritePointer(3), processBuffers.getReadPointer(3), numSamples);
-    
-    // Generate every waveform frame
-    for (int i = 0; i < numFrames; i++)
-        processFrame(i);
+    // Render the waveform images once, to be shared by both waveforms
+    WaveformPyramid::Ptr pyramid = new WaveformPyramid(colours, levels, WAVEFORM_HEIGHT, waveform->getBackgroundColour());
     
     // If there is a new load request, abort this one
     if (newRequest) return;
     
-    // Pass the generated frames to the waveforms
-    waveform->load(&track, &colours, &levels);
-    scrollBar->load(&track, &colours, &levels);
+    // Pass the rendered images to the waveforms
+    waveform->load(pyramid);
+    scrollBar->load(pyramid);
 }
 
 
-void WaveformLoader::processFrame(int index)
+bool WaveformLoader::readStored(juce::MemoryBlock& data)
 {
-    int startSample = index * WAVEFORM_FRAME_SIZE;
-    
-    // The magnitude of the waveform frame is the maximum value of the unfiltered audio
-    levels.add(juce::FloatVectorOperations::findMaximum(processBuffers.getReadPointer(0, startSample), WAVEFORM_FRAME_SIZE));
-    
-    // The magnitudes of the colours red, green and blue are determined by
-    // the low-, band- and high-pass filtered audio respectively
-    float low = juce::FloatVectorOperations::findMaximum(processBuffers.getReadPointer(1, startSample), WAVEFORM_FRAME_SIZE);
-    float mid = juce::FloatVectorOperations::findMaximum(processBuffers.getReadPointer(2, startSample), WAVEFORM_FRAME_SIZE);
-    float high = juce::FloatVectorOperations::findMaximum(processBuffers.getReadPointer(3, startSample), WAVEFORM_FRAME_SIZE);
-    
-    // Scale the values to an appropriate range
-    float multiplier = 2.f;
-    low *= multiplier;
-    mid *= multiplier;
-    high *= multiplier;
-    
-    // Brighten them slightly
-    low += 0.1f;
-    mid += 0.1f;
-    high += 0.1f;
-    
-    // Limit the colours to 1.0
-    low = juce::jmin(low, 1.f);
-    mid = juce::jmin(mid, 1.f);
-    high = juce::jmin(high, 1.f);
-    
-    // Mix the red, green and blue components into the colour for this frame
-    // and add it to the colours array
-    colours.add(juce::Colour(low*255, mid*255, high*255));
+    if (dataManager == nullptr)
+        return false;
+    
+    // A stored waveform from an older version of the analyser is ignored, and replaced once the track is re-analysed
+    if ((AnalysisFeatures::getCurrentFeatures(*track.info) & ANALYSIS_FEATURE_BIT(AnalysisFeature::waveform)) == 0)
+        return false;
+    
+    return dataManager->readWaveform(track.info->hash, data);
+}
+
+
+void WaveformLoader::unpack(const juce::MemoryBlock& data)
+{
+    const juce::uint8* frame = static_cast<const juce::uint8*>(data.getData());
+    int numFrames = int(data.getSize() / WAVEFORM_BYTES_PER_FRAME);
+    
+    levels.ensureStorageAllocated(numFrames);
+    colours.ensureStorageAllocated(numFrames);
+    
+    for (int i = 0; i < numFrames; i++)
+    {
+        // Each frame is stored as its level, followed by its red, green and blue components
+        levels.add(frame[0] / 255.f);
+        colours.add(juce::Colour(frame[1], frame[2], frame[3]));
+        
+        frame += WAVEFORM_BYTES_PER_FRAME;
+    }
 }
 
 
@@ -182,10 +160,6 @@ void WaveformLoader::reset()
     waveform->reset();
     scrollBar->reset();
     
-    filterLow.reset();
-    filterMid.reset();
-    filterHigh.reset();
-    
     levels.clear();
     colours.clear();
 }
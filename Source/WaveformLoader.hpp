@@ -9,15 +9,21 @@
 #define WaveformLoader_hpp
 
 #include "WaveformScrollBar.hpp"
+#include "Track.hpp"
 #include "DataManager.hpp"
+#include "AnalyserWaveform.hpp"
 
 
 /**
  Thread for loading data to display in track waveforms.
  
- Waveform data is provided in arrays which determine the colour and level of each waveform frame.
+ Waveform data is unpacked into arrays which determine the colour and level of each waveform frame,
+ then rendered to a WaveformPyramid which is shared by both waveforms.
  A waveform frame is a single position along the horizontal axis which corresponds to a small window of audio data.
- The size of the window is determined by WAVEFORM_FRAME_SIZE in WaveformComponent.hpp.
+ The size of the window is determined by WAVEFORM_FRAME_SIZE in AnalyserWaveform.hpp.
+ 
+ The waveform of an analysed track is read from the database, where it was stored during analysis (see AnalyserWaveform),
+ so the track doesn't need to be decoded. Otherwise, it is generated here from the track's audio.
  */
 class WaveformLoader : juce::Thread
 {
@@ -45,9 +51,17 @@ private:
      and aborts if there is a new track to load. */
     void process();
     
-    /** Loads the data for a single waveform frame.
-     @param[in] index Index of the waveform frame to be loaded */
-    void processFrame(int index);
+    /** Reads the stored waveform of the current track, if it is up to date.
+     
+     @param[out] data Output location for the waveform data
+     
+     @return True if the waveform was found */
+    bool readStored(juce::MemoryBlock& data);
+    
+    /** Converts waveform data into the colour and level of each waveform frame.
+     
+     @param[in] data Waveform data, generated by AnalyserWaveform */
+    void unpack(const juce::MemoryBlock& data);
     
     /** Resets the state of the loader, ready for a new track. */
     void reset();
@@ -62,20 +76,16 @@ private:
     Track track; ///< Information on track currently being loaded
     Track newTrack; ///< Information on a newly requested track to load
     
-    bool newRequest = false; ///< Indicates whether there is a new track to load
+    std::atomic<bool> newRequest { false }; ///< Indicates whether there is a new track to load, which also abandons generation of the current waveform
     
     bool loadedAudio = false; ///< Indicates whether this thread loaded the audio data of the current track (If so, it must be released after load)
     
     bool hideWhenEmpty; ///< Indicates whether the waveforms should be hidden when there is no track loaded
     
-    juce::AudioBuffer<float> processBuffers; ///< Buffers to hold the track audio data while it is processed (i.e. filtered)
-    
     juce::Array<juce::Colour> colours; ///< Array of colours for each waveform frame, determined by the frequency content in that frame
     juce::Array<float> levels; ///< Array of levels for each waveform frame, representing the magnitude of audio in that frame
     
-    juce::IIRFilter filterLow; ///< IIR filter for low-passing track audio, which will determine the amount of red in each waveform frame
-    juce::IIRFilter filterMid; ///< IIR filter for band-passing track audio, which will determine the amount of green in each waveform frame
-    juce::IIRFilter filterHigh; ///< IIR filter for high-passing track audio, which will determine the amount of blue in each waveform frame
+    AnalyserWaveform analyser; ///< Generates the waveform of tracks which don't have one stored
     
     
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformLoader) ///< JUCE macro to add a memory leak detector
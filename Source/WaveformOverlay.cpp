@@ -0,0 +1,123 @@
+//
+//  WaveformOverlay.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "WaveformOverlay.hpp"
+
+#include "CommonDefs.hpp"
+
+#define WAVEFORM_BEAT_MARKER_SIZE (0.1f)
+
+
+WaveformOverlay::WaveformOverlay(WaveformComponent* wave, bool beats, float thickness) :
+    waveform(wave), showBeats(beats), markerThickness(thickness)
+{
+    setInterceptsMouseClicks(false, false);
+}
+
+
+void WaveformOverlay::resized()
+{
+    beatMarkerHeight = WAVEFORM_BEAT_MARKER_SIZE * getHeight();
+}
+
+
+void WaveformOverlay::paint(juce::Graphics& g)
+{
+    if (!waveform->isReady()) return;
+    
+    const juce::ScopedLock sl(lock);
+    
+    // Find the part of the track that is visible
+    double startFrame = waveform->getStartFrame();
+    double framesPerPixel = waveform->getFramesPerPixel();
+    double endFrame = startFrame + getWidth() * framesPerPixel;
+    
+    // Markers are dimmed along with the waveform
+    float alpha = waveform->getBrightness();
+    
+    if (showBeats)
+    {
+        g.setColour(juce::Colours::white.withAlpha(alpha));
+        
+        // The beats are in order, so only those from the first visible beat onwards need to be visited
+        const WaveformMarker* beat = std::lower_bound(beats.begin(), beats.end(), startFrame, [](const WaveformMarker& marker, double frame) {
+            return marker.frame < frame;
+        });
+        
+        for (; beat != beats.end() && beat->frame < endFrame; beat++)
+        {
+            float x = float((beat->frame - startFrame) / framesPerPixel);
+            
+            // If the beat is a downbeat, draw a full-height line
+            if (beat->downbeat)
+            {
+                g.drawLine(x, 0, x, getHeight(), 2);
+            }
+            else // Otherwise, draw small lines top and bottom
+            {
+                g.drawLine(x, 0, x, beatMarkerHeight, 2);
+                g.drawLine(x, getHeight()-beatMarkerHeight, x, getHeight(), 2);
+            }
+        }
+    }
+    
+    // Draw any mix markers in red
+    g.setColour(juce::Colours::red.withAlpha(alpha));
+    
+    for (const WaveformMarker& marker : markers)
+    {
+        if (marker.frame >= startFrame && marker.frame < endFrame)
+        {
+            float x = float((marker.frame - startFrame) / framesPerPixel);
+            g.drawLine(x, 0, x, getHeight(), markerThickness);
+        }
+    }
+}
+
+
+void WaveformOverlay::load(Track* track)
+{
+    const juce::ScopedLock sl(lock);
+    
+    beats.clear();
+    
+    TrackInfo* info = track->info;
+    
+    // The beat grid is only known once the track has been analysed
+    if (!showBeats || info->bpm == -1) return;
+    
+    double beatLength = AutoDJ::getBeatPeriod(info->bpm);
+    int numBeats = int((info->getLengthSamples() - info->beatPhase) / beatLength) + 1;
+    
+    beats.ensureStorageAllocated(numBeats);
+    
+    for (int i = 0; i < numBeats; i++)
+    {
+        WaveformMarker beat;
+        beat.frame = (info->beatPhase + i * beatLength) / WAVEFORM_FRAME_SIZE;
+        beat.downbeat = (i - info->downbeat) % BEATS_PER_BAR == 0;
+        beats.add(beat);
+    }
+}
+
+
+void WaveformOverlay::insertMarker(int sample)
+{
+    const juce::ScopedLock sl(lock);
+    
+    WaveformMarker marker;
+    marker.frame = double(sample) / WAVEFORM_FRAME_SIZE;
+    marker.downbeat = false;
+    markers.add(marker);
+}
+
+
+void WaveformOverlay::clearMarkers()
+{
+    const juce::ScopedLock sl(lock);
+    markers.clear();
+}
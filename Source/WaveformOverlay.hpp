@@ -0,0 +1,83 @@
+//
+//  WaveformOverlay.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef WaveformOverlay_hpp
+#define WaveformOverlay_hpp
+
+#include "WaveformComponent.hpp"
+#include "Track.hpp"
+
+
+/** Position of a marker drawn over a waveform. */
+typedef struct WaveformMarker
+{
+    double frame; ///< Position of the marker in the track, in waveform frames
+    bool downbeat; ///< Indicates whether a beat marker is a downbeat (drawn full-height)
+} WaveformMarker;
+
+
+/**
+ Transparent layer drawn on top of a WaveformComponent, which shows the beat grid and mix markers.
+ 
+ Marker positions are calculated when they change, rather than checked against every waveform frame,
+ so only the visible markers are visited when painting. Since the overlay is separate from the waveform,
+ which is buffered to an image, changing the markers doesn't require the waveform to be reloaded or redrawn.
+ */
+class WaveformOverlay : public juce::Component
+{
+public:
+    
+    /** Constructor.
+     
+     @param[in] waveform Waveform which this overlay is placed on top of, and which determines the visible part of the track
+     @param[in] showBeats Indicates whether the beat grid should be drawn, as well as the mix markers
+     @param[in] markerThickness Thickness to render mix markers, in pixels */
+    WaveformOverlay(WaveformComponent* waveform, bool showBeats, float markerThickness);
+    
+    /** Destructor. */
+    ~WaveformOverlay() {}
+    
+    /** Called by the JUCE message when this component is resized - set size/position of child components here. */
+    void resized() override;
+    
+    /** Called by the JUCE message thread to paint this component.
+     
+     @param[in] g  JUCE graphics handler */
+    void paint(juce::Graphics& g) override;
+    
+    /** Calculates the beat grid of a newly loaded track.
+     
+     @param[in] track Pointer to the track information */
+    void load(Track* track);
+    
+    /** Inserts a red mix marker at the given position in the loaded track.
+     
+     @param[in] sample Position in track where marker should be placed */
+    void insertMarker(int sample);
+    
+    /** Removes all mix markers. */
+    void clearMarkers();
+    
+private:
+    
+    juce::CriticalSection lock; ///< RAII lock to ensure thread-safety while acessing the markers, which may be changed away from the message thread
+    
+    WaveformComponent* waveform; ///< Waveform which this overlay is placed on top of
+    
+    juce::Array<WaveformMarker> beats; ///< Position of every beat in the track, in ascending order
+    juce::Array<WaveformMarker> markers; ///< Position of every mix marker
+    
+    bool showBeats; ///< Indicates whether the beat grid is drawn
+    float markerThickness; ///< Thickness to render mix markers, in pixels
+    
+    int beatMarkerHeight = 0; ///< Height of the white beat markers (rendered at top and bottom of waveform)
+    
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformOverlay) ///< JUCE macro to add a memory leak detector
+};
+
+#endif /* WaveformOverlay_hpp */
@@ -0,0 +1,87 @@
+//
+//  WaveformPyramid.cpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#include "WaveformPyramid.hpp"
+
+#define WAVEFORM_PYRAMID_MIN_WIDTH (64) ///< Width below which no further pyramid levels are rendered, in pixels
+
+
+WaveformPyramid::WaveformPyramid(const juce::Array<juce::Colour>& colours, const juce::Array<float>& levels, int height, juce::Colour background)
+{
+    numFrames = levels.size();
+    
+    images.add(render(colours, levels, height, background));
+    
+    juce::Array<juce::Colour> levelColours(colours);
+    juce::Array<float> levelLevels(levels);
+    
+    // Halve the frames until the waveform is small enough to cover any zoom
+    while (levelLevels.size() > WAVEFORM_PYRAMID_MIN_WIDTH)
+    {
+        int size = (levelLevels.size() + 1) / 2;
+        
+        juce::Array<juce::Colour> halvedColours;
+        juce::Array<float> halvedLevels;
+        halvedColours.ensureStorageAllocated(size);
+        halvedLevels.ensureStorageAllocated(size);
+        
+        for (int i = 0; i < size; i++)
+        {
+            // Merge each pair of frames, keeping the peak level so that transients don't disappear when zoomed out
+            int next = juce::jmin(2*i + 1, levelLevels.size() - 1);
+            halvedLevels.add(juce::jmax(levelLevels.getUnchecked(2*i), levelLevels.getUnchecked(next)));
+            halvedColours.add(levelColours.getUnchecked(2*i).interpolatedWith(levelColours.getUnchecked(next), 0.5f));
+        }
+        
+        images.add(render(halvedColours, halvedLevels, height, background));
+        
+        levelColours.swapWith(halvedColours);
+        levelLevels.swapWith(halvedLevels);
+    }
+}
+
+
+int WaveformPyramid::chooseLevel(double framesPerPixel) const
+{
+    int level = 0;
+    
+    // Move up while the next level still has at least one pixel for each pixel painted
+    while (level + 1 < images.size() && (1 << (level + 1)) <= framesPerPixel)
+        level += 1;
+    
+    return level;
+}
+
+
+juce::Image WaveformPyramid::render(const juce::Array<juce::Colour>& colours, const juce::Array<float>& levels, int height, juce::Colour background)
+{
+    float magnitude;
+    
+    juce::Image image(juce::Image::RGB, juce::jmax(1, levels.size()), height, true);
+    // Create a JUCE graphics handler to paint on the image
+    juce::Graphics g(image);
+    
+    // Fill the background with colour
+    // This MUST be done because image is marked as opaque, so pixels underneath are undefined
+    g.setColour(background);
+    g.fillAll();
+    
+    // For each waveform frame
+    for (int frame = 0; frame < levels.size(); frame++)
+    {
+        // Fetch the magnitude of the wave
+        magnitude = levels.getUnchecked(frame) * height * 0.4f;
+        
+        // Fetch the colour of the frame
+        g.setColour(colours.getUnchecked(frame));
+        
+        // Draw a vertical line
+        g.drawVerticalLine(frame, 0.5f * height - magnitude, 0.5f * height + magnitude);
+    }
+    
+    return image;
+}
@@ -0,0 +1,78 @@
+//
+//  WaveformPyramid.hpp
+//  AutoDJ - App
+//
+//  Created by Alexei Smith on 19/10/2026.
+//
+
+#ifndef WaveformPyramid_hpp
+#define WaveformPyramid_hpp
+
+#include <JuceHeader.h>
+
+
+/**
+ Pre-rendered images of a track waveform at power-of-two zooms, shared by the WaveformComponent and WaveformScrollBar of a track.
+ 
+ Level 0 has one pixel per waveform frame, and each level above it has half as many pixels as the one below.
+ A waveform can then be painted from the level nearest its zoom with a cheap horizontal scale of less than 2x,
+ rather than resampling the full-resolution image every time the playhead moves.
+ */
+class WaveformPyramid : public juce::ReferenceCountedObject
+{
+public:
+    
+    using Ptr = juce::ReferenceCountedObjectPtr<WaveformPyramid>; ///< Reference-counted pointer, so the pyramid is freed once neither waveform uses it
+    
+    /** Constructor, which renders every level of the pyramid.
+     
+     @param[in] colours Array of colours, representing the colour to render in each waveform frame
+     @param[in] levels Array of levels, representing the magnitude/height of each waveform frame
+     @param[in] height Height of the images to render, in pixels
+     @param[in] background Colour to fill behind the waveform */
+    WaveformPyramid(const juce::Array<juce::Colour>& colours, const juce::Array<float>& levels, int height, juce::Colour background);
+    
+    /** Destructor. */
+    ~WaveformPyramid() {}
+    
+    /** Fetches the number of waveform frames, which is the width of the level 0 image.
+     
+     @return Number of waveform frames */
+    int getNumFrames() const { return numFrames; }
+    
+    /** Chooses the level to paint from for a given zoom, which is the most zoomed-out level
+     that still has at least one pixel for each pixel painted.
+     
+     @param[in] framesPerPixel Number of waveform frames covered by each pixel painted
+     
+     @return Pyramid level */
+    int chooseLevel(double framesPerPixel) const;
+    
+    /** Fetches the image at a level of the pyramid, in which each pixel covers (1 << level) waveform frames.
+     
+     @param[in] level Pyramid level (see chooseLevel())
+     
+     @return Waveform image */
+    const juce::Image& getImage(int level) const { return images.getReference(level); }
+    
+private:
+    
+    /** Renders a waveform image with one pixel for each frame.
+     
+     @param[in] colours Array of colours, representing the colour to render in each waveform frame
+     @param[in] levels Array of levels, representing the magnitude/height of each waveform frame
+     @param[in] height Height of the image, in pixels
+     @param[in] background Colour to fill behind the waveform
+     
+     @return Waveform image */
+    static juce::Image render(const juce::Array<juce::Colour>& colours, const juce::Array<float>& levels, int height, juce::Colour background);
+    
+    juce::Array<juce::Image> images; ///< Image at each level of the pyramid, from full resolution (level 0) upwards
+    
+    int numFrames; ///< Number of waveform frames, determined by length of the track
+    
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WaveformPyramid) ///< JUCE macro to add a memory leak detector
+};
+
+#endif /* WaveformPyramid_hpp */
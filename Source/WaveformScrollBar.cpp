@@ -15,7 +15,8 @@ WaveformScrollBar::WaveformScrollBar()
 
 void WaveformScrollBar::resized()
 {
-    imageScaled = image.rescaled(getWidth(), getHeight(), juce::Graphics::ResamplingQuality::mediumResamplingQuality);
+    if (ready.load())
+        draw();
 }
 
 
@@ -55,18 +56,15 @@ void WaveformScrollBar::update(int playhead, double timeStretch, double gain)
 }
 
 
-void WaveformScrollBar::draw(juce::Array<juce::Colour>* colours, juce::Array<float>* levels)
+void WaveformScrollBar::draw()
 {
-    WaveformComponent::draw(colours, levels);
+    if (getWidth() <= 0) return;
     
     // For scrollbar, waveform is simply scaled to the width of the component, so we can see it all
-    imageScaled = image.rescaled(getWidth(), getHeight(), juce::Graphics::ResamplingQuality::mediumResamplingQuality);
-}
-
-
-bool WaveformScrollBar::isBeat(int frameIndex, bool& downbeat)
-{
-    // Don't want to draw any beat markers in scroll bar waveform, so exit
-    downbeat = false;
-    return false;
+    startFrame = 0.0;
+    framesPerPixel = double(numFrames) / getWidth();
+    
+    // Scaling from the nearest pyramid level, rather than the full-resolution image, keeps this cheap
+    const juce::Image& levelImage = pyramid->getImage(pyramid->chooseLevel(framesPerPixel));
+    imageScaled = levelImage.rescaled(getWidth(), getHeight(), juce::Graphics::ResamplingQuality::mediumResamplingQuality);
 }
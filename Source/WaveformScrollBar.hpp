@@ -16,6 +16,7 @@
 
 /**
  Extension of WaveformComponent which render the full track in a much thinner area.
+ The image is taken from the same WaveformPyramid as the zoomed waveform, at the level nearest the width of this component.
  Includes a rectangular window indicating the current position in the track.
  For the window to be the correct width, this component must be the same width as its associated WaveformComponent.
  */
@@ -51,19 +52,11 @@ public:
     
 private:
     
-    /** Renders the full track waveform to an image.
-    Playhead position, time stretch and gain are applied dynamically to this image before painting.
-    This expensive function can therefore be called just once - upon track load.
+    /** Scales the full track waveform to the size of this component.
+    This expensive function is called just once upon track load, and when the component is resized. */
+    void draw() override;
     
-    @param[in] colours Pointer to an array of colours, representing the colour to render in each waveform frame
-    @param[in] levels Pointer to an array of levels, representing the magnitude/height of each waveform frame */
-    void draw(juce::Array<juce::Colour>* colours, juce::Array<float>* levels) override;
-    
-    /** Checks whether a given waveform frame contains a beat in the track.
-    
-    @param[in] frameIndex Index of the waveform frame to check
-    @param[out] downbeat Indicates whether the frame contains a downbeat */
-    bool isBeat(int frameIndex, bool& downbeat) override;
+    juce::Image imageScaled; ///< Full track waveform, scaled to the size of this component
     
     int windowStartX; ///< X-coordinate of the left side of the positional window
     int windowWidth = 0; ///< Width of the positional window, in pixels
@@ -20,6 +20,13 @@ WaveformView::WaveformView(DataManager* dm, bool clickToScroll, bool scrollBarAt
     scrollBar.reset(new WaveformScrollBar());
     addAndMakeVisible(scrollBar.get());
     
+    // The overlays are added last, so they are drawn on top of the waveforms
+    waveformOverlay.reset(new WaveformOverlay(waveform.get(), true, 3));
+    addAndMakeVisible(waveformOverlay.get());
+    
+    scrollBarOverlay.reset(new WaveformOverlay(scrollBar.get(), false, 1));
+    addAndMakeVisible(scrollBarOverlay.get());
+    
     loader.reset(new WaveformLoader(dm, waveform.get(), scrollBar.get(), hideWhenEmpty));
 }
 
@@ -39,6 +46,9 @@ void WaveformView::resized()
         scrollBar->setTopLeftPosition(0, 0);
         waveform->setTopLeftPosition(0, WAVEFORM_SCROLL_BAR_HEIGHT);
     }
+    
+    waveformOverlay->setBounds(waveform->getBounds());
+    scrollBarOverlay->setBounds(scrollBar->getBounds());
 }
 
 
@@ -46,6 +56,7 @@ void WaveformView::load(Track* track, bool force)
 {
     trackLength = track->info->getLengthSamples();
     loader->load(track, force);
+    waveformOverlay->load(track);
     update(0);
 }
 
@@ -77,15 +88,15 @@ void WaveformView::reset()
 
 void WaveformView::insertMarker(int sample)
 {
-    waveform->insertMarker(sample);
-    scrollBar->insertMarker(sample, 40);
+    waveformOverlay->insertMarker(sample);
+    scrollBarOverlay->insertMarker(sample);
 }
 
 
 void WaveformView::clearMarkers()
 {
-    waveform->clearMarkers();
-    scrollBar->clearMarkers();
+    waveformOverlay->clearMarkers();
+    scrollBarOverlay->clearMarkers();
 }
 
 
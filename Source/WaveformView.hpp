@@ -9,6 +9,7 @@
 #define WaveformView_hpp
 
 #include "WaveformLoader.hpp"
+#include "WaveformOverlay.hpp"
 
 
 #define WAVEFORM_VIEW_HEIGHT (WAVEFORM_HEIGHT + WAVEFORM_SCROLL_BAR_HEIGHT) ///< Height of WaveformView, in pixels (determined by height of both the waveforms it contains)
@@ -17,6 +18,7 @@
 /**
  UI component which holds a large/zoomed track waveform, and a thin waveform showing the whole track.
  Handles loading of the waveform data on a dedicated thread.
+ Beat and mix markers are drawn by a WaveformOverlay on top of each waveform, so they can change without reloading the waveforms.
  */
 class WaveformView : public juce::Component
 {
@@ -51,6 +53,7 @@ public:
     void reset();
     
     /** Inserts a red mix marker into both waveforms.
+     Only the overlays on top of the waveforms are affected, so this is cheap, and takes effect the next time the view is repainted.
      
      @param[in] sample Audio sample / position in track at which to insert the marker */
     void insertMarker(int sample);
@@ -83,6 +86,9 @@ private:
     std::unique_ptr<WaveformComponent> waveform; ///< Large/zoomed waveform
     std::unique_ptr<WaveformScrollBar> scrollBar; ///< Thin scroll bar waveform
     
+    std::unique_ptr<WaveformOverlay> waveformOverlay; ///< Beat grid and mix markers, drawn on top of the large/zoomed waveform
+    std::unique_ptr<WaveformOverlay> scrollBarOverlay; ///< Mix markers, drawn on top of the scroll bar waveform
+    
     bool scrollBarBottom; ///< Indicates whether the thin waveform is shown below, or above, the zoomed waveform
     
     std::unique_ptr<WaveformLoader> loader; ///< Thread for loading waveform data